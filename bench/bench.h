@@ -0,0 +1,62 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Helpers shared by the benchmarks, which are plain executables printing their results.
+
+// Runs the function the given number of times, returning the fastest run in nanoseconds.
+template<typename funcT>
+inline double bench_best_ns(int runs, funcT&& func) {
+	using clock = std::chrono::steady_clock;
+	double best = 1e300;
+	for (int i = 0; i < runs; ++i) {
+		clock::time_point t0 = clock::now();
+		func();
+		best = std::min(best, std::chrono::duration<double, std::nano>(clock::now() - t0).count());
+	}
+	return best;
+}
+
+// Keeps the optimizer from discarding a result: the compiler must assume its memory is read.
+template<typename T>
+inline void bench_keep(const T& val) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r"(&val) : "memory");
+#else
+	static const void* volatile sink; // the pointer itself is volatile, so the store is kept
+	sink = &val;
+#endif
+}
+
+// Number of allocations so far; only counted in benchmarks defining BENCH_COUNT_ALLOCS before
+// including this header, which replaces the global operator new in that executable.
+inline std::atomic<size_t>& bench_allocs() noexcept {
+	static std::atomic<size_t> count{0};
+	return count;
+}
+
+#ifdef BENCH_COUNT_ALLOCS
+void* operator new(size_t sz) {
+	bench_allocs().fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(sz ? sz : 1)) return p;
+	throw std::bad_alloc();
+}
+void* operator new(size_t sz, const std::nothrow_t&) noexcept {
+	bench_allocs().fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(sz ? sz : 1);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+#endif
@@ -0,0 +1,82 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#define BENCH_COUNT_ALLOCS
+#include <functional>
+#include <vector>
+#include "../internals/delegate.h"
+#include "../internals/params.h"
+#include "bench.h"
+using namespace wl;
+
+// Handlers stored as std::function against _wli::delegate, with captures of 8, 24 and 48 bytes:
+// allocations to store 1000 handlers, and cost of each call, picked at random among them. The last
+// column is a std::function passed to a delegate, which then holds both type erasures.
+static const size_t NUM_HANDLERS = 1000, NUM_CALLS = 1000 * 1000;
+
+template<typename funcsT>
+static double ns_per_call(const funcsT& funcs, LRESULT& sum) {
+	return bench_best_ns(5, [&]() {
+		unsigned seed = 1;
+		LRESULT s = 0;
+		for (size_t i = 0; i < NUM_CALLS; ++i) {
+			seed = seed * 1103515245u + 12345u;
+			s += funcs[(seed >> 8) % funcs.size()]({0, static_cast<WPARAM>(i), 0});
+		}
+		sum = s;
+	}) / NUM_CALLS;
+}
+
+template<typename makerT>
+static bool run(const char* name, makerT&& make) {
+	using func_t = std::function<LRESULT(params)>;
+	using delegate_t = _wli::delegate<LRESULT(params)>;
+	std::vector<func_t> funcs;
+	std::vector<delegate_t> delegates, wrapped;
+	funcs.reserve(NUM_HANDLERS);
+	delegates.reserve(NUM_HANDLERS);
+	wrapped.reserve(NUM_HANDLERS);
+
+	size_t allocs0 = bench_allocs().load();
+	for (size_t i = 0; i < NUM_HANDLERS; ++i) funcs.emplace_back(make(i));
+	size_t allocs1 = bench_allocs().load();
+	for (size_t i = 0; i < NUM_HANDLERS; ++i) delegates.emplace_back(make(i));
+	size_t allocs2 = bench_allocs().load();
+	for (size_t i = 0; i < NUM_HANDLERS; ++i) wrapped.emplace_back(func_t{make(i)});
+	size_t allocs3 = bench_allocs().load();
+
+	LRESULT funcSum = 0, delegateSum = 0, wrappedSum = 0;
+	double funcNs = ns_per_call(funcs, funcSum);
+	double delegateNs = ns_per_call(delegates, delegateSum);
+	double wrappedNs = ns_per_call(wrapped, wrappedSum);
+	if (funcSum != delegateSum || funcSum != wrappedSum) {
+		std::fprintf(stderr, "Results differ with %s.\n", name);
+		return false;
+	}
+	std::printf("%-8s %8zu %8.2f %8zu %8.2f %8zu %8.2f\n", name,
+		allocs1 - allocs0, funcNs, allocs2 - allocs1, delegateNs, allocs3 - allocs2, wrappedNs);
+	return true;
+}
+
+int main() {
+	std::printf("%-8s %17s %17s %17s\n", "", "std::function", "delegate", "wrapped function");
+	std::printf("%-8s %8s %8s %8s %8s %8s %8s\n", "capture", "allocs", "ns", "allocs", "ns", "allocs", "ns");
+	int obj = 0;
+	const int* self = &obj; // stands for "this"
+	bool ok = run("8 B", [self](size_t) {
+		return [self](params p) -> LRESULT { return reinterpret_cast<LRESULT>(self) + p.wParam; };
+	}) && run("24 B", [self](size_t i) {
+		return [self, pNext = self + 1, i](params p) -> LRESULT {
+			return reinterpret_cast<LRESULT>(self) + p.wParam + reinterpret_cast<LRESULT>(pNext) + i;
+		};
+	}) && run("48 B", [self](size_t i) {
+		return [self, i, a = i * 2, b = i * 3, c = i * 5, d = i * 7](params p) -> LRESULT {
+			return reinterpret_cast<LRESULT>(self) + p.wParam + i + a + b + c + d;
+		};
+	});
+	return ok ? 0 : 1;
+}
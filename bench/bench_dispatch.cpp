@@ -0,0 +1,63 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#define BENCH_COUNT_ALLOCS
+#include <vector>
+#include "../internals/msg_replay.h"
+#include "bench.h"
+using namespace wl;
+
+// Replays three synthetic message mixes through the dispatch of a window with a typical set of
+// handlers: a few dozen messages, 30 commands and two listviews. Built with WL_HEADLESS, so there's
+// no window at all: only the lookup and the call of the handlers are measured.
+static size_t alloc_count() {
+	return bench_allocs().load();
+}
+
+int main() {
+	HWND hWnd = nullptr;
+	_wli::base_msg<LRESULT> wnd{hWnd};
+	volatile LRESULT sink = 0;
+	int x = 0, y = 0;
+	for (UINT msg : {WM_MOUSEMOVE, WM_SETCURSOR, WM_PAINT, WM_TIMER, WM_LBUTTONDOWN, WM_LBUTTONUP, WM_MOUSEWHEEL, WM_MOUSELEAVE}) {
+		wnd.msgs.add(msg, [&x, &y](params p) -> LRESULT { x += LOWORD(p.lParam); y += HIWORD(p.lParam); return 0; });
+	}
+	for (UINT i = 0; i < 20; ++i) {
+		wnd.msgs.add(WM_USER + 0x100 + i, [](params) -> LRESULT { return 1; });
+	}
+	for (WORD id = 1000; id < 1030; ++id) {
+		wnd.cmds.add(id, [&sink, id](params p) -> LRESULT { sink = sink + id + HIWORD(p.wParam); return 0; });
+	}
+	for (UINT_PTR idFrom : {2000, 2001}) {
+		for (UINT code : {NM_CUSTOMDRAW, LVN_GETDISPINFO, LVN_HOTTRACK, LVN_ITEMCHANGED, NM_CLICK, NM_DBLCLK}) {
+			wnd.ntfs.add({idFrom, code}, [&sink](params p) -> LRESULT {
+				sink = sink + reinterpret_cast<const NMHDR*>(p.lParam)->code;
+				return 0;
+			});
+		}
+	}
+	wnd.process_msg(WM_PAINT, 0, 0); // the first message freezes the handlers, as in a real window
+
+	std::vector<WORD> cmdIds; // some without a handler
+	for (WORD id = 1000; id < 1040; ++id) cmdIds.emplace_back(id);
+	_wli::msg_replay mouseStorm, listviewBurst, commands;
+	mouseStorm.add_mouse_storm(100000);
+	listviewBurst.add_listview_burst(2000, 50000).add_listview_burst(2001, 50000);
+	commands.add_commands(cmdIds, 100000);
+
+	std::printf("%-15s %10s %8s %8s %8s %9s %11s\n",
+		"mix", "Mmsg/s", "handled", "p50 ns", "p99 ns", "max ns", "allocs/msg");
+	for (auto& [name, replay] : {std::pair{"mouse storm", &mouseStorm},
+		std::pair{"listview burst", &listviewBurst}, std::pair{"commands", &commands}})
+	{
+		_wli::msg_replay::stats s = replay->bench(wnd, 20, alloc_count);
+		std::printf("%-15s %10.1f %7.0f%% %8.0f %8.0f %9.0f %11.3f\n", name, s.msgsPerSec / 1e6,
+			100.0 * s.handled / s.messages, s.p50Ns, s.p99Ns, s.maxNs, s.allocsPerMsg);
+	}
+	bench_keep(x + y);
+	return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "../flat_map.h"
+#include "../insert_order_map.h"
+#include "bench.h"
+using namespace wl;
+
+template<typename keyT> keyT make_key(unsigned seed);
+template<> unsigned make_key<unsigned>(unsigned seed) { return seed; }
+template<> std::wstring make_key<std::wstring>(unsigned seed) { return L"section.key_" + std::to_wstring(seed); }
+
+// Lookups of existing keys in random order, ns per lookup. The sorted vector column is a plain
+// std::lower_bound over the same entries, the search flat_map makes without its Eytzinger copy.
+template<typename keyT>
+static int lookups(const char* name) {
+	std::printf("%s keys:\n", name);
+	std::printf("%-8s %12s %14s %12s %14s  (ns/lookup)\n", "entries", "flat_map", "sorted vector", "std::map", "insert_order");
+	for (size_t numKeys : {16, 256, 4096, 100000}) {
+		std::vector<keyT> keys;
+		unsigned seed = 1;
+		while (keys.size() < numKeys) {
+			seed = seed * 1103515245u + 12345u;
+			keys.emplace_back(make_key<keyT>(seed >> 4));
+		}
+		std::vector<typename flat_map<keyT, int>::entry> entries;
+		std::map<keyT, int> sm;
+		insert_order_map<keyT, int> iom;
+		for (size_t i = 0; i < numKeys; ++i) {
+			entries.emplace_back(keys[i], static_cast<int>(i));
+			sm[keys[i]] = static_cast<int>(i);
+			iom[keys[i]] = static_cast<int>(i);
+		}
+		flat_map<keyT, int> fm{std::vector<typename flat_map<keyT, int>::entry>{entries}};
+		std::vector<typename flat_map<keyT, int>::entry> sorted(fm.begin(), fm.end());
+		if (fm.size() != sm.size() || iom.size() != sm.size()
+			|| !std::all_of(keys.begin(), keys.end(), [&](const keyT& k) { return fm.has(k) && fm[k] == sm[k]; }))
+		{
+			std::fprintf(stderr, "Keys missing at %zu entries.\n", numKeys);
+			return 1;
+		}
+
+		std::vector<size_t> order(200000);
+		seed = 7;
+		for (size_t& idx : order) {
+			seed = seed * 1103515245u + 12345u;
+			idx = (seed >> 8) % numKeys;
+		}
+
+		long long found = 0;
+		double flatNs = bench_best_ns(3, [&]() {
+			for (size_t idx : order) found += *fm.get_if_exists(keys[idx]);
+		}) / order.size();
+		double sortedNs = bench_best_ns(3, [&]() {
+			for (size_t idx : order) {
+				found += std::lower_bound(sorted.begin(), sorted.end(), keys[idx],
+					[](const auto& e, const keyT& k) { return e.key < k; })->value;
+			}
+		}) / order.size();
+		double mapNs = bench_best_ns(3, [&]() {
+			for (size_t idx : order) found += sm.find(keys[idx])->second;
+		}) / order.size();
+		double insertOrderNs = bench_best_ns(3, [&]() {
+			for (size_t idx : order) found += *iom.get_if_exists(keys[idx]);
+		}) / order.size();
+		bench_keep(found);
+		std::printf("%-8zu %12.1f %14.1f %12.1f %14.1f\n", numKeys, flatNs, sortedNs, mapNs, insertOrderNs);
+	}
+	return 0;
+}
+
+int main() {
+	int ret = lookups<unsigned>("unsigned");
+	std::printf("\n");
+	return ret ? ret : lookups<std::wstring>("std::wstring");
+}
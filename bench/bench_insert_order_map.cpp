@@ -0,0 +1,150 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../insert_order_map.h"
+#include "bench.h"
+using namespace wl;
+
+using map_t = insert_order_map<std::wstring, std::wstring>;
+
+static std::vector<std::wstring> make_keys(size_t numKeys) {
+	std::vector<std::wstring> keys;
+	unsigned seed = 1;
+	for (size_t i = 0; i < numKeys; ++i) {
+		seed = seed * 1103515245u + 12345u;
+		keys.emplace_back(L"section.key_" + std::to_wstring(i) + L"_" + std::to_wstring(seed >> 20));
+	}
+	return keys;
+}
+
+// Lookups of existing std::wstring keys in random order, ns per lookup, at 8, 64, 1k and 100k
+// entries. The former map scanned its entries linearly, which is what the vector column does.
+static int lookups() {
+	std::printf("%-8s %12s %12s %14s  (ns/lookup)\n", "entries", "linear", "hashed", "unordered_map");
+	for (size_t numKeys : {8, 64, 1000, 100000}) {
+		std::vector<std::wstring> keys = make_keys(numKeys);
+		std::vector<map_t::entry> linear;
+		map_t m;
+		std::unordered_map<std::wstring, std::wstring> um;
+		for (const std::wstring& key : keys) {
+			linear.emplace_back(key, L"value");
+			m[key] = L"value";
+			um[key] = L"value";
+		}
+		if (m.size() != numKeys || !std::all_of(keys.begin(), keys.end(), [&](const std::wstring& k) { return m.has(k); })) {
+			std::fprintf(stderr, "Keys missing at %zu entries.\n", numKeys);
+			return 1;
+		}
+
+		std::vector<size_t> order(200000);
+		unsigned seed = 7;
+		for (size_t& idx : order) {
+			seed = seed * 1103515245u + 12345u;
+			idx = (seed >> 8) % numKeys;
+		}
+		size_t numLinear = std::min<size_t>(order.size(), 20000000 / numKeys); // the scan is quadratic overall
+
+		size_t found = 0;
+		double linearNs = bench_best_ns(3, [&]() {
+			for (size_t i = 0; i < numLinear; ++i) {
+				const std::wstring& key = keys[order[i]];
+				found += std::find_if(linear.begin(), linear.end(), [&](const map_t::entry& e) { return e.key == key; }) != linear.end();
+			}
+		}) / numLinear;
+		double hashedNs = bench_best_ns(3, [&]() {
+			for (size_t idx : order) found += m.get_if_exists(keys[idx]) != nullptr;
+		}) / order.size();
+		double unorderedNs = bench_best_ns(3, [&]() {
+			for (size_t idx : order) found += um.find(keys[idx]) != um.end();
+		}) / order.size();
+		bench_keep(found);
+		std::printf("%-8zu %12.1f %12.1f %14.1f\n", numKeys, linearNs, hashedNs, unorderedNs);
+	}
+	return 0;
+}
+
+// Removals from 100k entries, in random order, us per removal; and removing every other key,
+// one by one or with a single remove_if(), in ms. The former map erased from the middle of the
+// vector after a linear search; it's too slow for all 100k, so only 2k removals are timed there.
+static int removals() {
+	const size_t NUM_KEYS = 100000, NUM_FORMER = 2000;
+	std::vector<std::wstring> keys = make_keys(NUM_KEYS);
+	std::vector<size_t> order(NUM_KEYS);
+	for (size_t i = 0; i < NUM_KEYS; ++i) order[i] = i;
+	unsigned seed = 3;
+	for (size_t i = NUM_KEYS - 1; i > 0; --i) { // Fisher-Yates
+		seed = seed * 1103515245u + 12345u;
+		std::swap(order[i], order[(seed >> 8) % (i + 1)]);
+	}
+
+	std::vector<map_t::entry> formerEntries;
+	map_t full;
+	for (const std::wstring& key : keys) {
+		formerEntries.emplace_back(key, L"value");
+		full[key] = L"value";
+	}
+
+	std::vector<map_t::entry> former;
+	double formerNs = bench_best_ns(1, [&]() {
+		former = formerEntries;
+		for (size_t i = 0; i < NUM_FORMER; ++i) {
+			const std::wstring& key = keys[order[i]];
+			former.erase(std::find_if(former.begin(), former.end(), [&](const map_t::entry& e) { return e.key == key; }));
+		}
+	}) / NUM_FORMER;
+	bool formerOk = former.size() == NUM_KEYS - NUM_FORMER;
+	// the copy made before each run is timed too, so it's subtracted
+	double copyNs = bench_best_ns(1, [&]() { former = formerEntries; }) / NUM_FORMER;
+
+	map_t m;
+	double removeNs = bench_best_ns(3, [&]() {
+		m = map_t{};
+		m.insert_range(full.begin(), full.end());
+		for (size_t idx : order) m.remove(keys[idx]);
+	});
+	if (!m.empty() || !formerOk) {
+		std::fprintf(stderr, "Wrong sizes after removals.\n");
+		return 1;
+	}
+	double fillNs = bench_best_ns(3, [&]() {
+		m = map_t{};
+		m.insert_range(full.begin(), full.end());
+	});
+
+	double oneByOneNs = bench_best_ns(3, [&]() {
+		m = map_t{};
+		m.insert_range(full.begin(), full.end());
+		for (size_t i = 0; i < NUM_KEYS; i += 2) m.remove(keys[i]);
+	}) - fillNs;
+	double removeIfNs = bench_best_ns(3, [&]() {
+		m = map_t{};
+		m.insert_range(full.begin(), full.end());
+		size_t i = 0;
+		m.remove_if([&i](const map_t::entry&) { return i++ % 2 == 0; });
+	}) - fillNs;
+	if (m.size() != NUM_KEYS / 2 || m.begin()->key != keys[1]) {
+		std::fprintf(stderr, "Wrong entries after remove_if.\n");
+		return 1;
+	}
+
+	std::printf("\nRemoving from %zu entries:\n", NUM_KEYS);
+	std::printf("  random order, former:       %10.2f us/removal\n", (formerNs - copyNs) / 1000);
+	std::printf("  random order, remove():     %10.2f us/removal, %.1f ms for all\n",
+		(removeNs - fillNs) / NUM_KEYS / 1000, (removeNs - fillNs) / 1e6);
+	std::printf("  every other, remove():      %10.2f ms\n", oneByOneNs / 1e6);
+	std::printf("  every other, remove_if():   %10.2f ms\n", removeIfNs / 1e6);
+	return 0;
+}
+
+int main() {
+	int ret = lookups();
+	return ret ? ret : removals();
+}
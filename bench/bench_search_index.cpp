@@ -0,0 +1,79 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../search_index.h"
+#include "bench.h"
+using namespace wl;
+
+// Queries on 200k file names, as typed in a filter box: the time of each find(), for the top 50
+// results, as a list control shows, and for all of them.
+
+static unsigned seed = 1;
+
+static unsigned rnd(unsigned n) {
+	seed = seed * 1103515245u + 12345u;
+	return (seed >> 8) % n;
+}
+
+static std::vector<std::wstring> file_names(size_t count) {
+	static const wchar_t* words[] = {L"report", L"invoice", L"Budget", L"draft", L"final", L"photo",
+		L"IMG", L"backup", L"notes", L"meeting", L"Project", L"summary", L"scan", L"letter", L"contract",
+		L"setup", L"readme", L"data", L"export", L"config", L"Schedule", L"plan", L"review", L"copy"};
+	static const wchar_t* exts[] = {L".docx", L".pdf", L".jpg", L".txt", L".xlsx", L".png", L".zip", L".cpp"};
+	std::vector<std::wstring> names;
+	names.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		std::wstring name;
+		for (unsigned w = 0, numWords = 1 + rnd(3); w < numWords; ++w) {
+			if (w) name.append(rnd(2) ? L"_" : L" ");
+			name.append(words[rnd(static_cast<unsigned>(std::size(words)))]);
+		}
+		name.append(L"_").append(std::to_wstring(rnd(100000))).append(exts[rnd(static_cast<unsigned>(std::size(exts)))]);
+		names.emplace_back(std::move(name));
+	}
+	return names;
+}
+
+int main() {
+	const size_t NUM_ITEMS = 200'000;
+	std::vector<std::wstring> names = file_names(NUM_ITEMS);
+	double buildNs = bench_best_ns(1, [&]() { bench_keep(search_index{names}); });
+	search_index index{names};
+	std::printf("%zu items, index built in %.1f ms\n\n", NUM_ITEMS, buildNs / 1e6);
+
+	struct query final { const wchar_t* text; search_index::match how; const char* howName; };
+	const query queries[] = {
+		{L"r",          search_index::match::PREFIX,    "prefix"},
+		{L"rep",        search_index::match::PREFIX,    "prefix"},
+		{L"report_4",   search_index::match::PREFIX,    "prefix"},
+		{L"x",          search_index::match::SUBSTRING, "substring"},
+		{L"pdf",        search_index::match::SUBSTRING, "substring"},
+		{L"final_12",   search_index::match::SUBSTRING, "substring"},
+		{L"zzq",        search_index::match::SUBSTRING, "substring"},
+		{L"q",          search_index::match::FUZZY,     "fuzzy"},
+		{L"x",          search_index::match::FUZZY,     "fuzzy"},
+		{L"rpt",        search_index::match::FUZZY,     "fuzzy"},
+		{L"bdgtxls",    search_index::match::FUZZY,     "fuzzy"},
+		{L"mtgnts77",   search_index::match::FUZZY,     "fuzzy"},
+		{L"kzq",        search_index::match::FUZZY,     "fuzzy"},
+	};
+
+	std::printf("%-10s %-10s %10s %12s %12s\n", "query", "match", "results", "top 50 (ms)", "all (ms)");
+	double worstTop = 0;
+	for (const query& q : queries) {
+		size_t numResults = index.find(q.text, q.how).size();
+		double topNs = bench_best_ns(5, [&]() { bench_keep(index.find(q.text, q.how, 50)); });
+		double allNs = bench_best_ns(5, [&]() { bench_keep(index.find(q.text, q.how)); });
+		worstTop = std::max(worstTop, topNs);
+		std::printf("%-10ls %-10s %10zu %12.3f %12.3f\n", q.text, q.howName, numResults, topNs / 1e6, allNs / 1e6);
+	}
+	std::printf("\nWorst top 50 query: %.3f ms\n", worstTop / 1e6);
+	return 0;
+}
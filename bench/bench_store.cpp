@@ -0,0 +1,66 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <vector>
+#include "../internals/store.h"
+#include "bench.h"
+using namespace wl;
+
+// Handler lookup of the message store with 10, 100 and 1000 handlers, before freeze() with the
+// reverse linear search, then through the dispatch table. Half the handlers are for ids below
+// WM_USER, the others for ids from WM_APP. The stream is 60% unhandled system traffic, like mouse
+// moves and hit tests, and 40% handled ids. With 10 handlers freeze() keeps the linear search, so
+// both columns measure the same thing.
+static long long dispatch_all(_wli::store<UINT, LRESULT>& s, const std::vector<UINT>& stream) {
+	long long sum = 0;
+	for (UINT id : stream) {
+		if (auto* func = s.find(id)) sum += (*func)({id, 0, 0});
+	}
+	return sum;
+}
+
+int main() {
+	const UINT NOISE[] = {WM_MOUSEMOVE, WM_NCHITTEST, WM_SETCURSOR, WM_PAINT, WM_TIMER, WM_NCMOUSEMOVE};
+	const size_t NUM_NOISE = sizeof(NOISE) / sizeof(NOISE[0]);
+	std::printf("%9s %13s %13s %8s\n", "handlers", "linear (ns)", "frozen (ns)", "speedup");
+	for (size_t numHandlers : {10, 100, 1000}) {
+		_wli::store<UINT, LRESULT> s;
+		std::vector<UINT> ids;
+		size_t lowIdx = 0; // walks all ids below WM_USER, skipping the unhandled ones
+		for (size_t i = 0; i < numHandlers; ++i) {
+			UINT id = static_cast<UINT>(WM_APP + i);
+			if (i % 2) {
+				do {
+					id = static_cast<UINT>(0x001 + (lowIdx++ * 7) % 0x3FF);
+				} while (std::find(NOISE, NOISE + NUM_NOISE, id) != NOISE + NUM_NOISE);
+			}
+			ids.emplace_back(id);
+			s.add(id, [i](params) -> LRESULT { return static_cast<LRESULT>(i); });
+		}
+
+		std::vector<UINT> stream;
+		unsigned seed = 1;
+		for (size_t i = 0; i < 1024 * 1024; ++i) {
+			seed = seed * 1103515245u + 12345u;
+			unsigned r = seed >> 8;
+			stream.emplace_back((r % 10 < 6) ? NOISE[(r >> 4) % NUM_NOISE] : ids[(r >> 4) % numHandlers]);
+		}
+
+		long long linearSum = 0, frozenSum = 0;
+		double linearNs = bench_best_ns(3, [&]() { linearSum = dispatch_all(s, stream); });
+		s.freeze();
+		double frozenNs = bench_best_ns(3, [&]() { frozenSum = dispatch_all(s, stream); });
+		if (linearSum != frozenSum || std::any_of(NOISE, NOISE + NUM_NOISE, [&s](UINT id) { return s.find(id) != nullptr; })) {
+			std::fprintf(stderr, "Lookups differ with %zu handlers.\n", numHandlers);
+			return 1;
+		}
+		std::printf("%9zu %13.1f %13.1f %7.1fx\n", numHandlers,
+			linearNs / stream.size(), frozenNs / stream.size(), linearNs / frozenNs);
+	}
+	return 0;
+}
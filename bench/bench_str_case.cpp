@@ -0,0 +1,85 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <clocale>
+#include <cwctype>
+#include <string>
+#include "../str.h"
+#include "bench.h"
+using namespace wl;
+
+// Case mapping with the tables of internals/str_case.h, in millions of chars per second, over
+// 16M chars of ASCII, of Portuguese-like Latin-1 text, and of Cyrillic. A loop of the CRT towupper
+// and towlower in a UTF-8 locale stands in for CharUpperBuffW; the former remove_diacritics(),
+// which scanned a 56-char list for every char, is shown too. Each run includes copying the text.
+static void former_remove_diacritics(std::wstring& s) noexcept {
+	const wchar_t* diacritics   = L"ÁáÀàÃãÂâÄäÉéÈèÊêËëÍíÌìÎîÏïÓóÒòÕõÔôÖöÚúÙùÛûÜüÇçÅåÐðÑñØøÝý";
+	const wchar_t* replacements = L"AaAaAaAaAaEeEeEeEeIiIiIiIiOoOoOoOoOoUuUuUuUuCcAaDdNnOoYy";
+	for (wchar_t& ch : s) {
+		const wchar_t* pDiac = diacritics;
+		const wchar_t* pRepl = replacements;
+		while (*pDiac) {
+			if (ch == *pDiac) ch = *pRepl;
+			++pDiac;
+			++pRepl;
+		}
+	}
+}
+
+static std::wstring make_text(size_t numChars, const wchar_t* alphabet) {
+	size_t alphabetLen = std::char_traits<wchar_t>::length(alphabet);
+	std::wstring text(numChars, L' ');
+	unsigned seed = 1;
+	for (size_t i = 0; i < numChars; ++i) {
+		seed = seed * 1103515245u + 12345u;
+		if ((seed >> 16) % 6) text[i] = alphabet[(seed >> 8) % alphabetLen]; // a space every 6 chars or so
+	}
+	return text;
+}
+
+template<typename funcT>
+static double mchars_per_s(const std::wstring& text, funcT&& func) {
+	std::wstring work;
+	double ns = bench_best_ns(3, [&]() {
+		work = text;
+		func(work);
+		bench_keep(work);
+	});
+	return text.length() / ns * 1000;
+}
+
+int main() {
+	bool hasCrtTables = std::setlocale(LC_CTYPE, "C.UTF-8") || std::setlocale(LC_CTYPE, ".UTF-8");
+	const size_t NUM_CHARS = 16 * 1024 * 1024;
+	const char* NAMES[] = {"ASCII", "Latin-1", "Cyrillic"};
+	const wchar_t* ALPHABETS[] = {
+		L"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ,.",
+		L"abcdefghijklmnopqrstuvwxyzABCDEFGHIJáàãâçéêíóõôúÁÃÇÉÓ,.",
+		L"абвгдеёжзийклмнопрстуфхцчшщъыьэюяАБВГДЕЖЗИЙКЛМН,.",
+	};
+
+	std::printf("%-9s %9s %9s %9s %9s %9s %9s %9s  (M chars/s)\n", "text", "towupper", "upper",
+		"towlower", "lower", "casefold", "former rd", "remove_d");
+	for (int kind = 0; kind < 3; ++kind) {
+		std::wstring text = make_text(NUM_CHARS, ALPHABETS[kind]);
+		std::wstring viaCrt = text;
+		for (wchar_t& ch : viaCrt) ch = static_cast<wchar_t>(std::towupper(ch));
+		if (hasCrtTables && viaCrt != str::upper(text)) {
+			std::fprintf(stderr, "Uppercase differs from the CRT for %s.\n", NAMES[kind]);
+			return 1;
+		}
+		std::printf("%-9s %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f\n", NAMES[kind],
+			mchars_per_s(text, [](std::wstring& s) { for (wchar_t& ch : s) ch = static_cast<wchar_t>(std::towupper(ch)); }),
+			mchars_per_s(text, [](std::wstring& s) { str::upper_in_place(s); }),
+			mchars_per_s(text, [](std::wstring& s) { for (wchar_t& ch : s) ch = static_cast<wchar_t>(std::towlower(ch)); }),
+			mchars_per_s(text, [](std::wstring& s) { str::lower_in_place(s); }),
+			mchars_per_s(text, [](std::wstring& s) { str::casefold_in_place(s); }),
+			mchars_per_s(text, [](std::wstring& s) { former_remove_diacritics(s); }),
+			mchars_per_s(text, [](std::wstring& s) { str::remove_diacritics(s); }));
+	}
+	return 0;
+}
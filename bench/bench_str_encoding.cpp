@@ -0,0 +1,76 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <cstring>
+#include <vector>
+#include "../str.h"
+#include "bench.h"
+using namespace wl;
+
+// Encoding sniff of text without BOM, from 1 KB to 100 MB; pass "1g" to add 1 GB. Each input is
+// scanned whole: pure ASCII, UTF-8 with a non-ASCII char every 20 or so, and ASCII with a single
+// Windows-1252 byte at the very end. The former sniff, which stopped at the first Latin-1 pair
+// and didn't validate anything, is shown for comparison.
+static str::encoding former_sniff(const BYTE* data, size_t sz) noexcept {
+	bool canBeWin1252 = false;
+	for (size_t i = 0; i < sz; ++i) {
+		if (data[i] > 0x7F) {
+			canBeWin1252 = true;
+			if (i + 1 < sz && ((data[i] == 0xC2 && data[i + 1] >= 0xA1 && data[i + 1] <= 0xBF)
+				|| (data[i] == 0xC3 && data[i + 1] >= 0x80 && data[i + 1] <= 0xBF)))
+			{
+				return str::encoding::UTF8;
+			}
+		}
+	}
+	return canBeWin1252 ? str::encoding::WIN1252 : str::encoding::ASCII;
+}
+
+static std::vector<BYTE> make_input(size_t numBytes, int kind) {
+	std::vector<BYTE> data(numBytes);
+	unsigned seed = 1;
+	for (size_t i = 0; i < numBytes; ++i) {
+		seed = seed * 1103515245u + 12345u;
+		data[i] = static_cast<BYTE>('a' + (seed >> 8) % 26);
+		if (kind == 1 && i + 3 <= numBytes && (seed >> 16) % 20 == 0) { // U+20AC, euro sign
+			data[i] = 0xE2;
+			data[++i] = 0x82;
+			data[++i] = 0xAC;
+		}
+	}
+	if (kind == 2) data[numBytes - 1] = 0xE9; // é in Windows-1252
+	return data;
+}
+
+int main(int argc, char** argv) {
+	std::vector<size_t> sizes = {1024, 1024 * 1024, 100 * 1024 * 1024};
+	if (argc > 1 && std::strcmp(argv[1], "1g") == 0) sizes.emplace_back(1024 * 1024 * 1024);
+	const char* NAMES[] = {"ASCII", "UTF-8", "1252"};
+	const str::encoding EXPECTED[] = {str::encoding::ASCII, str::encoding::UTF8, str::encoding::WIN1252};
+
+	std::printf("%-6s %12s %12s %12s\n", "input", "bytes", "former GB/s", "sniff GB/s");
+	for (size_t numBytes : sizes) {
+		for (int kind = 0; kind < 3; ++kind) {
+			std::vector<BYTE> data = make_input(numBytes, kind);
+			size_t reps = (64 * 1024 * 1024) / numBytes + 1; // short inputs are sniffed many times per run
+			str::encoding former = str::encoding::UNKNOWN, sniffed = str::encoding::UNKNOWN;
+			double formerNs = bench_best_ns(3, [&]() {
+				for (size_t r = 0; r < reps; ++r) former = former_sniff(data.data(), numBytes);
+			}) / reps;
+			double sniffNs = bench_best_ns(3, [&]() {
+				for (size_t r = 0; r < reps; ++r) sniffed = str::get_encoding(data.data(), numBytes).encType;
+			}) / reps;
+			if (sniffed != EXPECTED[kind]) {
+				std::fprintf(stderr, "Wrong encoding for %s at %zu bytes.\n", NAMES[kind], numBytes);
+				return 1;
+			}
+			bench_keep(former);
+			std::printf("%-6s %12zu %12.2f %12.2f\n", NAMES[kind], numBytes, numBytes / formerNs, numBytes / sniffNs);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,68 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <cwchar>
+#include <string>
+#include "../str.h"
+#include "bench.h"
+using namespace wl;
+
+// str::format() and str::format_to() against the former swprintf-based format, which ran
+// swprintf twice: once to measure, once to write into the allocated string. The CRT of glibc
+// can't measure with a null buffer, so here the first pass goes into a scratch buffer instead.
+template<typename ...argsT>
+static std::wstring former_format(const wchar_t* strFormat, const argsT&... args) {
+	wchar_t scratch[512];
+	int len = std::swprintf(scratch, 512, strFormat, args...);
+	std::wstring ret(len + 1, L'\0'); // room for terminating null
+	std::swprintf(&ret[0], len + 1, strFormat, args...);
+	ret.resize(len); // remove terminating null
+	return ret;
+}
+
+template<typename formerT, typename newT, typename toT>
+static int run(const char* name, const std::wstring& expected, formerT&& former, newT&& fmt, toT&& fmtTo) {
+	const int REPS = 200000;
+	if (former() != expected || fmt() != expected) {
+		std::fprintf(stderr, "Wrong output for %s.\n", name);
+		return 1;
+	}
+	double formerNs = bench_best_ns(5, [&]() { for (int i = 0; i < REPS; ++i) bench_keep(former()); }) / REPS;
+	double fmtNs = bench_best_ns(5, [&]() { for (int i = 0; i < REPS; ++i) bench_keep(fmt()); }) / REPS;
+	double fmtToNs = bench_best_ns(5, [&]() {
+		wchar_t buf[128];
+		for (int i = 0; i < REPS; ++i) {
+			fmtTo(buf);
+			bench_keep(buf);
+		}
+	}) / REPS;
+	std::printf("%-10s %12.1f %12.1f %12.1f\n", name, formerNs, fmtNs, fmtToNs);
+	return 0;
+}
+
+int main() {
+	std::wstring name = L"Explorer";
+	int count = 42;
+	double ratio = 0.8125;
+	HWND hWnd = reinterpret_cast<HWND>(static_cast<UINT_PTR>(0x1A2B));
+
+	std::printf("%-10s %12s %12s %12s\n", "format", "former ns", "format ns", "format_to ns");
+	int ret = 0;
+	ret |= run("int", L"42 items",
+		[&]() { return former_format(L"%d items", count); },
+		[&]() { return str::format(L"%d items", count); },
+		[&](wchar_t* buf) { str::format_to(buf, 128, L"%d items", count); });
+	ret |= run("mixed", L"Explorer has 42 items, 81.25%",
+		[&]() { return former_format(L"%ls has %d items, %.2f%%", name.c_str(), count, ratio * 100); },
+		[&]() { return str::format(L"%s has %d items, %.2f%%", name, count, ratio * 100); },
+		[&](wchar_t* buf) { str::format_to(buf, 128, L"%s has %d items, %.2f%%", name, count, ratio * 100); });
+	ret |= run("hex", L"00001A2B|0x1a2b|    -7",
+		[&]() { return former_format(L"%08X|%#x|%6d", 0x1A2Bu, 0x1A2Bu, -7); },
+		[&]() { return str::format(L"%08X|%#x|%6d", hWnd, hWnd, -7); },
+		[&](wchar_t* buf) { str::format_to(buf, 128, L"%08X|%#x|%6d", hWnd, hWnd, -7); });
+	return ret;
+}
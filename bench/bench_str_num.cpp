@@ -0,0 +1,120 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <charconv>
+#include <cstdlib>
+#include <cwchar>
+#include <vector>
+#include "../str.h"
+#include "bench.h"
+using namespace wl;
+
+// Number to text of internals/str_num.h, ns per number, over 64-bit integers of mixed lengths
+// and doubles of mixed magnitudes. Compared with swprintf, with std::to_chars plus a widening
+// copy, and with the former to_wstring_with_separator(), which took an int and built the text
+// by prepending each group of 3; lstrcatW and _itow are replaced by the CRT here.
+static std::wstring former_with_separator(int number, wchar_t separator) {
+	std::wstring ret;
+	ret.reserve(32);
+	int abso = std::abs(number);
+	BYTE blocks = 0;
+	while (abso >= 1000) {
+		abso = (abso - (abso % 1000)) / 1000;
+		++blocks;
+	}
+	abso = std::abs(number);
+	bool firstPass = true;
+	do {
+		int num = abso % 1000;
+		wchar_t buf[8]{};
+		if (blocks) {
+			if (num < 100) std::wcscat(buf, L"0");
+			if (num < 10) std::wcscat(buf, L"0");
+		}
+		std::swprintf(buf + std::wcslen(buf), 8 - std::wcslen(buf), L"%d", num);
+		if (firstPass) firstPass = false;
+		else ret.insert(0, 1, separator);
+		ret.insert(0, buf);
+		abso = (abso - (abso % 1000)) / 1000;
+	} while (blocks--);
+	if (number < 0) ret.insert(0, 1, L'-');
+	return ret;
+}
+
+static size_t to_chars_wide(wchar_t* buf, const char* pFirst, const char* pLast) noexcept {
+	size_t len = pLast - pFirst;
+	for (size_t i = 0; i < len; ++i) buf[i] = pFirst[i];
+	buf[len] = L'\0';
+	return len;
+}
+
+template<typename valT, typename funcT>
+static double per_number_ns(const std::vector<valT>& vals, funcT&& func) {
+	return bench_best_ns(5, [&]() {
+		wchar_t buf[64];
+		for (valT v : vals) {
+			func(buf, v);
+			bench_keep(buf);
+		}
+	}) / vals.size();
+}
+
+int main() {
+	const size_t COUNT = 200000;
+	std::vector<long long> ints(COUNT);
+	std::vector<int> ints32(COUNT);
+	std::vector<double> doubles(COUNT);
+	unsigned long long seed = 88172645463325252ull;
+	for (size_t i = 0; i < COUNT; ++i) {
+		seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17; // xorshift64
+		ints[i] = static_cast<long long>(seed >> (seed % 60)) * ((seed & 1) ? -1 : 1); // 1 to 19 digits
+		ints32[i] = static_cast<int>(ints[i] % 2000000000);
+		doubles[i] = static_cast<double>(seed >> 11) / (1ull << 53) * 1e6 / static_cast<double>(1ull << (seed % 40));
+	}
+
+	// Correctness: integers match std::to_chars, doubles read back to the same value.
+	for (size_t i = 0; i < COUNT; ++i) {
+		wchar_t buf[64], expected[64];
+		char narrow[64];
+		str::number_to(buf, 64, ints[i]);
+		to_chars_wide(expected, narrow, std::to_chars(narrow, narrow + 64, ints[i]).ptr);
+		str::number_to(buf + 32, 32, doubles[i]);
+		if (lstrcmpW(buf, expected) || std::wcstod(buf + 32, nullptr) != doubles[i]
+			|| former_with_separator(ints32[i], L',') != str::to_wstring(ints32[i], {0, L','}))
+		{
+			std::fprintf(stderr, "Wrong text for %lld or %.17g.\n", ints[i], doubles[i]);
+			return 1;
+		}
+	}
+
+	std::printf("%-22s %10s\n", "conversion", "ns/number");
+	std::printf("%-22s %10.1f\n", "int64 swprintf", per_number_ns(ints, [](wchar_t* buf, long long v) {
+		std::swprintf(buf, 64, L"%lld", v); }));
+	std::printf("%-22s %10.1f\n", "int64 to_chars+widen", per_number_ns(ints, [](wchar_t* buf, long long v) {
+		char narrow[32];
+		to_chars_wide(buf, narrow, std::to_chars(narrow, narrow + 32, v).ptr); }));
+	std::printf("%-22s %10.1f\n", "int64 number_to", per_number_ns(ints, [](wchar_t* buf, long long v) {
+		str::number_to(buf, 64, v); }));
+	std::printf("%-22s %10.1f\n", "int32 , former", per_number_ns(ints32, [](wchar_t*, int v) {
+		bench_keep(former_with_separator(v, L',')); }));
+	std::printf("%-22s %10.1f\n", "int32 , to_wstring", per_number_ns(ints32, [](wchar_t*, int v) {
+		bench_keep(str::to_wstring(v, {0, L','})); }));
+	std::printf("%-22s %10.1f\n", "int64 , number_to", per_number_ns(ints, [](wchar_t* buf, long long v) {
+		str::number_to(buf, 64, v, {0, L','}); }));
+	std::printf("%-22s %10.1f\n", "double %.17g swprintf", per_number_ns(doubles, [](wchar_t* buf, double v) {
+		std::swprintf(buf, 64, L"%.17g", v); }));
+	std::printf("%-22s %10.1f\n", "double to_chars+widen", per_number_ns(doubles, [](wchar_t* buf, double v) {
+		char narrow[64];
+		to_chars_wide(buf, narrow, std::to_chars(narrow, narrow + 64, v).ptr); }));
+	std::printf("%-22s %10.1f\n", "double number_to", per_number_ns(doubles, [](wchar_t* buf, double v) {
+		str::number_to(buf, 64, v); }));
+	std::printf("%-22s %10.1f\n", "double %.2f swprintf", per_number_ns(doubles, [](wchar_t* buf, double v) {
+		std::swprintf(buf, 64, L"%.2f", v); }));
+	std::printf("%-22s %10.1f\n", "double .2 number_to", per_number_ns(doubles, [](wchar_t* buf, double v) {
+		str::number_to(buf, 64, v, {2}); }));
+	return 0;
+}
@@ -0,0 +1,50 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "../str.h"
+#include "bench.h"
+using namespace wl;
+
+// str::replacer against one str::replace call per needle, on a template of about 1 MB where
+// placeholders make 5% of the text.
+int main() {
+	std::printf("%8s %14s %14s %8s\n", "needles", "replace (ms)", "replacer (ms)", "speedup");
+	for (size_t numNeedles : {1, 4, 16, 64, 256}) {
+		std::vector<std::pair<std::wstring, std::wstring>> pairs;
+		for (size_t i = 0; i < numNeedles; ++i) {
+			pairs.emplace_back(L"{{key" + std::to_wstring(i) + L"}}", L"value number " + std::to_wstring(i));
+		}
+
+		std::wstring haystack;
+		unsigned seed = 1;
+		while (haystack.length() < 1024 * 1024) {
+			seed = seed * 1103515245u + 12345u;
+			if ((seed >> 8) % 20) haystack.append(L"lorem ipsum dolor sit amet, consectetur ");
+			else haystack.append(pairs[(seed >> 12) % numNeedles].first);
+		}
+
+		std::wstring viaReplace, viaReplacer;
+		double replaceNs = bench_best_ns(5, [&]() {
+			viaReplace = haystack;
+			for (const auto& pair : pairs) str::replace(viaReplace, pair.first, pair.second);
+		});
+		str::replacer rep{pairs};
+		double replacerNs = bench_best_ns(5, [&]() {
+			viaReplacer = rep.replace(haystack);
+		});
+		if (viaReplace != viaReplacer) {
+			std::fprintf(stderr, "Outputs differ with %zu needles.\n", numNeedles);
+			return 1;
+		}
+		std::printf("%8zu %14.2f %14.2f %7.1fx\n", numNeedles,
+			replaceNs / 1e6, replacerNs / 1e6, replaceNs / replacerNs);
+	}
+	return 0;
+}
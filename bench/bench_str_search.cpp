@@ -0,0 +1,51 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <string>
+#include "../str.h"
+#include "bench.h"
+using namespace wl;
+
+// Case-insensitive search of a needle found only at the end of about 1 MB of mixed-case text:
+// the former way, which upper-cased a copy of the haystack and then searched it, against
+// str::findi, which builds a finderi each call, and a finderi built once. The reverse search
+// goes through the same text with the needle at the beginning.
+int main() {
+	std::wstring haystack;
+	unsigned seed = 1;
+	const wchar_t* WORDS[] = {L"Lorem ", L"IPSUM ", L"dolor ", L"Sit ", L"amet, ", L"Über ", L"straße ", L"ΑΒΓ "};
+	while (haystack.length() < 1024 * 1024) {
+		seed = seed * 1103515245u + 12345u;
+		haystack.append(WORDS[(seed >> 8) % (sizeof(WORDS) / sizeof(WORDS[0]))]);
+	}
+
+	std::printf("%7s %13s %13s %13s %13s\n", "needle", "upper (ms)", "findi (ms)", "finderi (ms)", "rfind (ms)");
+	for (const wchar_t* needle : {L"zq", L"zqxjk", L"zqxjk lorem ", L"zqxjk lorem ipsum dolor sit amet"}) {
+		std::wstring text = haystack + L"ZQXJK LOREM IPSUM DOLOR SIT AMET";
+		std::wstring textRev = L"ZQXJK LOREM IPSUM DOLOR SIT AMET" + haystack;
+		size_t expected = haystack.length();
+
+		size_t viaUpper = 0, viaFindi = 0, viaFinderi = 0, viaRfind = 0;
+		double upperNs = bench_best_ns(5, [&]() {
+			std::wstring hay = text, ndl = needle; // what findi did before
+			for (wchar_t& ch : hay) ch = _wli::str_case::to_upper(ch);
+			for (wchar_t& ch : ndl) ch = _wli::str_case::to_upper(ch);
+			viaUpper = hay.find(ndl);
+		});
+		double findiNs = bench_best_ns(5, [&]() { viaFindi = str::findi(text, needle); });
+		str::finderi finder{needle};
+		double finderiNs = bench_best_ns(5, [&]() { viaFinderi = finder.find(text); });
+		double rfindNs = bench_best_ns(5, [&]() { viaRfind = finder.rfind(textRev); });
+		if (viaUpper != expected || viaFindi != expected || viaFinderi != expected || viaRfind != 0) {
+			std::fprintf(stderr, "Wrong match with needle of %zu chars.\n", std::wstring{needle}.length());
+			return 1;
+		}
+		std::printf("%7zu %13.2f %13.2f %13.2f %13.2f\n", std::wstring{needle}.length(),
+			upperNs / 1e6, findiNs / 1e6, finderiNs / 1e6, rfindNs / 1e6);
+	}
+	return 0;
+}
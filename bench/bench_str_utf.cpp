@@ -0,0 +1,63 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../internals/str_utf.h"
+#include "bench.h"
+using namespace wl;
+
+// Throughput of the UTF-8 to UTF-16 transcoder and back, in GB/s of UTF-8, over 16 MB of text:
+// pure ASCII, Latin-1 text where a few letters take 2 bytes, and CJK where each char takes 3.
+// With a 32-bit wchar_t, as on Linux, the SSE2 widening is skipped; only the ASCII scan uses it.
+static std::wstring make_text(const wchar_t* alphabet, size_t numChars) {
+	std::wstring s(numChars, L' ');
+	size_t alphabetLen = std::char_traits<wchar_t>::length(alphabet);
+	unsigned seed = 1;
+	for (wchar_t& ch : s) {
+		seed = seed * 1103515245u + 12345u;
+		ch = alphabet[(seed >> 8) % alphabetLen];
+	}
+	return s;
+}
+
+int main() {
+	const size_t TARGET_BYTES = 16 * 1024 * 1024;
+	struct input final { const char* name; const wchar_t* alphabet; size_t bytesPerChar; };
+	const input INPUTS[] = {
+		{"ASCII",   L"the quick brown fox jumps over the lazy dog, THE QUICK BROWN FOX 0123456789\n", 1},
+		{"Latin-1", L"les élèves étaient à l'école, où ça coûte cher; Straße über Köln ", 1},
+		{"CJK",     L"日本語の文章を変換する速度を測定します。中文字符串转换速度测试", 3},
+	};
+
+	std::printf("%-8s %10s %12s %12s\n", "input", "MB", "decode GB/s", "encode GB/s");
+	for (const input& in : INPUTS) {
+		std::wstring wide = make_text(in.alphabet, TARGET_BYTES / in.bytesPerChar);
+		std::vector<unsigned char> utf8(_wli::str_utf::utf8_max_len(wide.length()));
+		utf8.resize(_wli::str_utf::utf16_to_utf8(wide.c_str(), wide.length(), utf8.data()).written);
+
+		std::vector<wchar_t> decoded(_wli::str_utf::utf16_max_len(utf8.size()));
+		std::vector<unsigned char> encoded(_wli::str_utf::utf8_max_len(wide.length()));
+		_wli::str_utf::result dec, enc;
+		double decodeNs = bench_best_ns(5, [&]() {
+			dec = _wli::str_utf::utf8_to_utf16(utf8.data(), utf8.size(), decoded.data());
+		});
+		double encodeNs = bench_best_ns(5, [&]() {
+			enc = _wli::str_utf::utf16_to_utf8(wide.c_str(), wide.length(), encoded.data());
+		});
+		if (dec.written != wide.length() || dec.numInvalid || enc.written != utf8.size()
+			|| !std::equal(wide.begin(), wide.end(), decoded.begin()))
+		{
+			std::fprintf(stderr, "Round trip failed for %s.\n", in.name);
+			return 1;
+		}
+		std::printf("%-8s %10.1f %12.2f %12.2f\n", in.name, utf8.size() / 1048576.0,
+			utf8.size() / decodeNs, utf8.size() / encodeNs);
+	}
+	return 0;
+}
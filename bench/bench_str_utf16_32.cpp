@@ -0,0 +1,92 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../str.h"
+#include "bench.h"
+using namespace wl;
+
+// str::to_wstring over UTF-16 and UTF-32 blobs with BOM, both byte orders, against a plain loop
+// assembling each unit from its bytes. Text is mostly Latin and CJK, with 1% of chars outside
+// the BMP. Sizes are 1 MB and 100 MB; pass "1g" to add 1 GB, which needs 3 to 5 GB of memory.
+static std::vector<BYTE> make_blob(size_t numBytes, int unitSize, bool bigEndian) {
+	std::vector<BYTE> blob;
+	blob.reserve(numBytes + 4);
+	unsigned bom = 0xFEFF;
+	auto put = [&](unsigned unit) {
+		for (int b = 0; b < unitSize; ++b) {
+			int shift = bigEndian ? (unitSize - 1 - b) * 8 : b * 8;
+			blob.emplace_back(static_cast<BYTE>(unit >> shift));
+		}
+	};
+	put(bom);
+	unsigned seed = 1;
+	while (blob.size() < numBytes) {
+		seed = seed * 1103515245u + 12345u;
+		unsigned r = (seed >> 8) % 100;
+		unsigned cp = (r == 0) ? 0x1F600 + (seed >> 16) % 64 // emoji
+			: (r < 30) ? 0x4E00 + (seed >> 12) % 0x5000 // CJK
+			: L'a' + (seed >> 12) % 26;
+		if (unitSize == 2 && cp > 0xFFFF) {
+			put(0xD800 + ((cp - 0x10000) >> 10));
+			put(0xDC00 + ((cp - 0x10000) & 0x3FF));
+		} else {
+			put(cp);
+		}
+	}
+	return blob;
+}
+
+// What a straightforward decoder does: one unit at a time, no swapping in bulk.
+static std::wstring plain_decode(const std::vector<BYTE>& blob, int unitSize, bool bigEndian) {
+	std::wstring out;
+	out.reserve(blob.size() / unitSize * (unitSize == 4 ? 2 : 1));
+	for (size_t i = unitSize; i + unitSize <= blob.size(); i += unitSize) { // skips the BOM
+		unsigned unit = 0;
+		for (int b = 0; b < unitSize; ++b) {
+			int shift = bigEndian ? (unitSize - 1 - b) * 8 : b * 8;
+			unit |= static_cast<unsigned>(blob[i + b]) << shift;
+		}
+		if (unitSize == 4 && unit > 0xFFFF) {
+			out.push_back(static_cast<wchar_t>(0xD800 + ((unit - 0x10000) >> 10)));
+			out.push_back(static_cast<wchar_t>(0xDC00 + ((unit - 0x10000) & 0x3FF)));
+		} else {
+			out.push_back(static_cast<wchar_t>(unit));
+		}
+	}
+	return out;
+}
+
+int main(int argc, char** argv) {
+	std::vector<size_t> sizes = {1024 * 1024, 100 * 1024 * 1024};
+	if (argc > 1 && std::strcmp(argv[1], "1g") == 0) sizes.emplace_back(1024 * 1024 * 1024);
+
+	std::printf("%-8s %8s %12s %12s\n", "input", "MB", "plain GB/s", "str GB/s");
+	for (size_t numBytes : sizes) {
+		for (int unitSize : {2, 4}) {
+			for (bool bigEndian : {false, true}) {
+				std::vector<BYTE> blob = make_blob(numBytes, unitSize, bigEndian);
+				int runs = numBytes > 100 * 1024 * 1024 ? 1 : 3;
+				std::wstring viaPlain, viaStr;
+				double plainNs = bench_best_ns(runs, [&]() { viaPlain = plain_decode(blob, unitSize, bigEndian); });
+				viaPlain.shrink_to_fit();
+				double strNs = bench_best_ns(runs, [&]() { viaStr = str::to_wstring(blob); });
+				if (viaPlain != viaStr) {
+					std::fprintf(stderr, "Outputs differ at %zu bytes.\n", numBytes);
+					return 1;
+				}
+				char name[16];
+				std::snprintf(name, sizeof(name), "UTF-%d%s", unitSize * 8, bigEndian ? "BE" : "LE");
+				std::printf("%-8s %8.0f %12.2f %12.2f\n", name, blob.size() / 1048576.0,
+					blob.size() / plainNs, blob.size() / strNs);
+			}
+		}
+	}
+	return 0;
+}
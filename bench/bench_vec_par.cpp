@@ -0,0 +1,80 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "../vec.h"
+#include "bench.h"
+using namespace wl;
+
+// Scaling of vec::par from 1 to N threads, in ms, where N is the number of cores, or the first
+// argument. Each algorithm is also run serially, with its std:: counterpart, which is the baseline
+// of the speedups. The pool has one worker per core, so more threads than cores only add chunks.
+int main(int argc, char** argv) {
+	size_t maxThreads = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+	if (!maxThreads) maxThreads = 1;
+	const size_t NUM_DOUBLES = 20000000, NUM_SORTED = 4000000;
+
+	std::vector<double> d(NUM_DOUBLES);
+	for (size_t i = 0; i < d.size(); ++i) d[i] = (i * 2654435761u % 1000) * 0.001;
+	std::vector<unsigned> unsorted(NUM_SORTED);
+	for (size_t i = 0; i < unsorted.size(); ++i) unsorted[i] = static_cast<unsigned>(i * 2654435761u);
+	auto work = [](double x) { return std::sqrt(x + 1.0) * 0.5; };
+	auto isNegative = [](double x) { return x < 0; };
+	auto isSmall = [](double x) { return x < 0.5; };
+
+	std::vector<double> transformed, pruned, serialPruned;
+	std::vector<unsigned> sorted = unsorted, serialSorted = unsorted;
+	double sum = 0;
+	double serial[5] = {
+		bench_best_ns(3, [&]() { // allocates its output, like vec::par::transform()
+			transformed = std::vector<double>(d.size());
+			std::transform(d.begin(), d.end(), transformed.begin(), work);
+		}),
+		bench_best_ns(3, [&]() { sum = std::accumulate(d.begin(), d.end(), 0.0); }),
+		bench_best_ns(3, [&]() { bench_keep(std::find_if(d.begin(), d.end(), isNegative)); }),
+		bench_best_ns(3, [&]() { pruned = d; vec::remove_if(pruned, isSmall); }),
+		bench_best_ns(3, [&]() { sorted = unsorted; std::sort(sorted.begin(), sorted.end()); }),
+	};
+	serialPruned = pruned;
+	serialSorted = sorted;
+	double serialSum = sum;
+
+	std::printf("%-8s %12s %12s %12s %12s %12s  (ms; 20M doubles, 4M unsigned sorted)\n",
+		"threads", "transform", "reduce", "find_if", "remove_if", "sort");
+	std::printf("%-8s %12.1f %12.1f %12.1f %12.1f %12.1f\n", "serial",
+		serial[0] / 1e6, serial[1] / 1e6, serial[2] / 1e6, serial[3] / 1e6, serial[4] / 1e6);
+
+	for (size_t numThreads = 1; numThreads <= maxThreads; numThreads = (numThreads * 2 > maxThreads && numThreads < maxThreads) ? maxThreads : numThreads * 2) {
+		vec::par::options opts{numThreads, 0};
+		std::vector<double> parTransformed;
+		size_t found = 0;
+		double par[5] = {
+			bench_best_ns(3, [&]() { parTransformed = vec::par::transform(d, work, opts); }),
+			bench_best_ns(3, [&]() { sum = vec::par::reduce(d, 0.0, std::plus<>{}, opts); }),
+			bench_best_ns(3, [&]() { found = vec::par::find_if(d, isNegative, opts); }),
+			bench_best_ns(3, [&]() { pruned = d; vec::par::remove_if(pruned, isSmall, opts); }),
+			bench_best_ns(3, [&]() { sorted = unsorted; vec::par::sort(sorted, std::less<>{}, opts); }),
+		};
+		if (parTransformed != transformed || std::abs(sum - serialSum) > 1e-6 * serialSum
+			|| found != static_cast<size_t>(-1) || pruned != serialPruned || sorted != serialSorted)
+		{
+			std::fprintf(stderr, "Results differ from the serial ones with %zu threads.\n", numThreads);
+			return 1;
+		}
+		std::printf("%-8zu", numThreads);
+		for (int i = 0; i < 5; ++i) std::printf(" %7.1f %4.2fx", par[i] / 1e6, serial[i] / par[i]);
+		std::printf("\n");
+		if (numThreads == maxThreads) break;
+	}
+	return 0;
+}
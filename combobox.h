@@ -8,6 +8,7 @@
 #pragma once
 #include "internals/base_native_ctrl_pubm.h"
 #include "internals/styler.h"
+#include "search_index.h"
 #include "str.h"
 #include "wnd.h"
 
@@ -91,6 +92,34 @@ public:
 		return buf;
 	}
 
+	// Returns the texts of all items.
+	std::vector<std::wstring> get_all_texts() const {
+		std::vector<std::wstring> texts;
+		size_t totItems = this->count();
+		texts.reserve(totItems);
+		for (size_t i = 0; i < totItems; ++i) {
+			texts.emplace_back(this->get_text(i));
+		}
+		return texts;
+	}
+
+	// Replaces the items with the entries which match the query, best first; an empty query shows
+	// all of them. The index must have been built with the positions of the entries as ids.
+	// Items are inserted at explicit positions, so the ranking is kept even with CBS_SORT.
+	combobox& filter(const std::vector<std::wstring>& allEntries, const search_index& index,
+		std::wstring_view query, search_index::match how = search_index::match::FUZZY)
+	{
+		SendMessageW(this->_hWnd, WM_SETREDRAW, FALSE, 0);
+		this->remove_all();
+		WPARAM pos = 0;
+		for (size_t id : index.find_ids(query, how)) {
+			SendMessageW(this->_hWnd, CB_INSERTSTRING, pos++, reinterpret_cast<LPARAM>(allEntries[id].c_str())); // CB_ADDSTRING would sort
+		}
+		SendMessageW(this->_hWnd, WM_SETREDRAW, TRUE, 0);
+		InvalidateRect(this->_hWnd, nullptr, TRUE);
+		return *this;
+	}
+
 	std::wstring get_selected_text() const {
 		return this->get_text(this->get_selected_index());
 	}
@@ -0,0 +1,292 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "internals/params.h"
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define WL_DISPATCH_PROFILER_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define WL_DISPATCH_PROFILER_TSC
+#endif
+
+namespace wl {
+
+// Measures the message handlers and thread callbacks of all windows, including subclasses. It's
+// only called if WL_PROFILE_DISPATCH is defined before including WinLamb; otherwise it costs nothing.
+// Each handler has call count, total and max time, and a latency histogram; calls longer than the
+// frame budget are counted apart. The latest calls are kept in a ring buffer, which can be queried
+// at runtime, or exported as Chrome trace JSON, to be opened in chrome://tracing or Perfetto.
+class dispatch_profiler final {
+public:
+	enum class kind : unsigned char { MESSAGE, COMMAND, NOTIFY, THREAD_UI, THREAD_DETACHED };
+
+	struct handler_id final {
+		kind     what;
+		UINT_PTR id;   // message, command id or notification idFrom; zero for thread callbacks
+		UINT     code; // notification code
+
+		bool operator==(const handler_id& other) const noexcept {
+			return this->what == other.what && this->id == other.id && this->code == other.code;
+		}
+	};
+
+	static const size_t HISTOGRAM_BUCKETS = 32; // bucket i counts calls in [2^(i-1), 2^i) ns, the last one everything above
+
+	struct handler_stats final {
+		handler_id         id;
+		unsigned long long calls = 0;
+		unsigned long long overBudget = 0; // calls longer than the frame budget
+		double             totalNs = 0;
+		double             maxNs = 0;
+		unsigned long long histogram[HISTOGRAM_BUCKETS] = {};
+
+		double mean_ns() const noexcept { return this->calls ? this->totalNs / this->calls : 0; }
+
+		// Upper bound of the histogram bucket where the given percentile falls.
+		double percentile_ns(double pct) const noexcept {
+			unsigned long long target = static_cast<unsigned long long>(this->calls * pct / 100), seen = 0;
+			for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+				seen += this->histogram[i];
+				if (seen > target) return std::min(static_cast<double>(1ull << i), this->maxNs);
+			}
+			return this->maxNs;
+		}
+	};
+
+	struct event final {
+		handler_id id;
+		HWND       hWnd;
+		unsigned   thread;  // sequential number, in order of each thread's first call
+		double     startUs; // since the profiler was created
+		double     durationNs;
+		bool       overBudget;
+	};
+
+	// Times its own lifetime, recording it for the handler when destroyed.
+	class scope final {
+	private:
+		handler_id         _id;
+		HWND               _hWnd;
+		unsigned long long _start;
+
+	public:
+		~scope() {
+			if (this->_start) instance()._record(this->_id, this->_hWnd, this->_start, _ticks());
+		}
+
+		scope(handler_id id, HWND hWnd) noexcept :
+			_id(id), _hWnd(hWnd), _start(instance()._enabled.load(std::memory_order_relaxed) ? _ticks() : 0) { }
+
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+	};
+
+private:
+	struct _handler_hash final {
+		size_t operator()(const handler_id& h) const noexcept {
+			return static_cast<size_t>((static_cast<unsigned long long>(h.id) * 0x9E3779B97F4A7C15ull)
+				^ (static_cast<unsigned long long>(h.code) << 8) ^ static_cast<unsigned long long>(h.what));
+		}
+	};
+
+	struct _event final {
+		handler_id         id;
+		HWND               hWnd;
+		unsigned           thread;
+		unsigned long long start, end;
+	};
+
+	mutable std::mutex                                          _mutex;
+	std::atomic<bool>                                           _enabled{true};
+	std::atomic<unsigned>                                       _nextThread{0};
+	std::unordered_map<handler_id, handler_stats, _handler_hash> _stats;
+	std::vector<_event>                                         _ring;
+	size_t                                                      _ringCapacity = 16 * 1024, _ringNext = 0;
+	unsigned long long                                          _originTicks = 0, _budgetTicks = 0;
+	double                                                      _nsPerTick = 1;
+
+public:
+	// The single profiler, shared by all windows and threads.
+	static dispatch_profiler& instance() {
+		static dispatch_profiler profiler;
+		return profiler;
+	}
+
+	// Identifies the handler of a message, as base_msg dispatches it.
+	static handler_id message_id(UINT msg, WPARAM wp, LPARAM lp) noexcept {
+		if (msg == WM_COMMAND) return {kind::COMMAND, LOWORD(wp), 0};
+		if (msg == WM_NOTIFY) {
+			const NMHDR* pNm = reinterpret_cast<const NMHDR*>(lp);
+			return {kind::NOTIFY, pNm->idFrom, pNm->code};
+		}
+		return {kind::MESSAGE, msg, 0};
+	}
+
+	// Pauses or resumes the recording.
+	dispatch_profiler& enable(bool enabled) noexcept {
+		this->_enabled.store(enabled, std::memory_order_relaxed);
+		return *this;
+	}
+
+	// Calls longer than the budget are flagged; default is a 60 Hz frame.
+	dispatch_profiler& set_budget(std::chrono::nanoseconds budget) {
+		std::lock_guard<std::mutex> lock{this->_mutex};
+		this->_budgetTicks = static_cast<unsigned long long>(budget.count() / this->_nsPerTick);
+		return *this;
+	}
+
+	// How many of the latest calls are kept; the ring buffer is cleared.
+	dispatch_profiler& set_ring_capacity(size_t numEvents) {
+		std::lock_guard<std::mutex> lock{this->_mutex};
+		this->_ring.clear();
+		this->_ring.shrink_to_fit();
+		this->_ringCapacity = numEvents;
+		this->_ringNext = 0;
+		return *this;
+	}
+
+	dispatch_profiler& reset() {
+		std::lock_guard<std::mutex> lock{this->_mutex};
+		this->_stats.clear();
+		this->_ring.clear();
+		this->_ringNext = 0;
+		return *this;
+	}
+
+	// Returns the stats of all handlers called so far, the most time consuming first.
+	std::vector<handler_stats> stats() const {
+		std::vector<handler_stats> all;
+		{
+			std::lock_guard<std::mutex> lock{this->_mutex};
+			all.reserve(this->_stats.size());
+			for (const auto& idAndStats : this->_stats) all.emplace_back(idAndStats.second);
+		}
+		std::sort(all.begin(), all.end(),
+			[](const handler_stats& a, const handler_stats& b) noexcept { return a.totalNs > b.totalNs; });
+		return all;
+	}
+
+	// Returns the stats of the handlers which exceeded the budget at least once.
+	std::vector<handler_stats> over_budget() const {
+		std::vector<handler_stats> all = this->stats();
+		all.erase(std::remove_if(all.begin(), all.end(),
+			[](const handler_stats& s) noexcept { return !s.overBudget; }), all.end());
+		return all;
+	}
+
+	// Returns the calls in the ring buffer, oldest first.
+	std::vector<event> recent_events() const {
+		std::lock_guard<std::mutex> lock{this->_mutex};
+		std::vector<event> events;
+		events.reserve(this->_ring.size());
+		for (size_t i = 0; i < this->_ring.size(); ++i) {
+			const _event& e = this->_ring[(this->_ringNext + i) % this->_ring.size()];
+			events.push_back({e.id, e.hWnd, e.thread,
+				(e.start - this->_originTicks) * this->_nsPerTick / 1000,
+				(e.end - e.start) * this->_nsPerTick,
+				e.end - e.start > this->_budgetTicks});
+		}
+		return events;
+	}
+
+	// Returns the calls in the ring buffer in Chrome trace event format, as UTF-8 JSON.
+	std::string chrome_trace_json() const {
+		std::vector<event> events = this->recent_events();
+		std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+		char buf[256];
+		for (size_t i = 0; i < events.size(); ++i) {
+			const event& e = events[i];
+			snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+				"\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"hwnd\":\"%p\",\"overBudget\":%s}}",
+				i ? "," : "", name_of(e.id).c_str(), e.overBudget ? "slow" : "dispatch", e.thread,
+				e.startUs, e.durationNs / 1000, static_cast<void*>(e.hWnd), e.overBudget ? "true" : "false");
+			json.append(buf);
+		}
+		json.append("]}");
+		return json;
+	}
+
+	// Returns a readable name, like "WM 0x0200", "WM_COMMAND 1001" or "WM_NOTIFY 2000 -12".
+	static std::string name_of(const handler_id& id) {
+		char buf[64] = {};
+		switch (id.what) {
+		case kind::MESSAGE:         snprintf(buf, sizeof(buf), "WM 0x%04X", static_cast<UINT>(id.id)); break;
+		case kind::COMMAND:         snprintf(buf, sizeof(buf), "WM_COMMAND %u", static_cast<UINT>(id.id)); break;
+		case kind::NOTIFY:          snprintf(buf, sizeof(buf), "WM_NOTIFY %llu %d", static_cast<unsigned long long>(id.id), static_cast<int>(id.code)); break;
+		case kind::THREAD_UI:       return "run_thread_ui";
+		case kind::THREAD_DETACHED: return "run_thread_detached";
+		}
+		return buf;
+	}
+
+private:
+	dispatch_profiler() {
+		// Calibrates the tick rate against the steady clock, spinning for a couple of milliseconds.
+		using clock = std::chrono::steady_clock;
+		clock::time_point t0 = clock::now();
+		unsigned long long ticks0 = _ticks();
+		clock::time_point t1 = t0;
+		while (t1 - t0 < std::chrono::milliseconds(2)) t1 = clock::now();
+		unsigned long long ticks1 = _ticks();
+		double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+		this->_nsPerTick = (ticks1 > ticks0) ? ns / (ticks1 - ticks0) : 1;
+		this->_originTicks = ticks0;
+		this->_budgetTicks = static_cast<unsigned long long>(16'666'667 / this->_nsPerTick);
+	}
+
+	static unsigned long long _ticks() noexcept {
+#ifdef WL_DISPATCH_PROFILER_TSC
+		return __rdtsc(); // a few cycles, constant rate on all current x86 CPUs
+#else
+		return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count()) + 1; // never zero, which means "not timing"
+#endif
+	}
+
+	unsigned _thread_number() noexcept {
+		thread_local unsigned number = this->_nextThread.fetch_add(1, std::memory_order_relaxed);
+		return number;
+	}
+
+	void _record(const handler_id& id, HWND hWnd, unsigned long long start, unsigned long long end) noexcept {
+		unsigned thread = this->_thread_number();
+		double ns = (end - start) * this->_nsPerTick;
+		size_t bucket = 0;
+		for (unsigned long long n = static_cast<unsigned long long>(ns); n && bucket + 1 < HISTOGRAM_BUCKETS; n >>= 1) ++bucket;
+
+		try {
+			std::lock_guard<std::mutex> lock{this->_mutex};
+			handler_stats& s = this->_stats[id];
+			s.id = id;
+			++s.calls;
+			s.overBudget += (end - start > this->_budgetTicks);
+			s.totalNs += ns;
+			s.maxNs = std::max(s.maxNs, ns);
+			++s.histogram[bucket];
+
+			if (!this->_ringCapacity) return;
+			if (this->_ring.size() < this->_ringCapacity) {
+				this->_ring.push_back({id, hWnd, thread, start, end});
+			} else {
+				this->_ring[this->_ringNext] = {id, hWnd, thread, start, end};
+				this->_ringNext = (this->_ringNext + 1) % this->_ringCapacity;
+			}
+		} catch (...) { } // out of memory: the call isn't recorded, but the handler must not fail
+	}
+};
+
+}//namespace wl
@@ -19,14 +19,14 @@ class download final {
 public:
 	using session = _wli::download_session;
 	using url_crack = _wli::download_url;
+	using header_map = insert_order_map<std::wstring, std::wstring, map_key::ignore_case>; // header names are case-insensitive
 
 private:
 	const session& _session;
 	HINTERNET      _hConnect = nullptr, _hRequest = nullptr;
 	size_t         _contentLength = 0, _totalGot = 0;
 	std::wstring   _url, _verb, _referrer;
-	insert_order_map<std::wstring, std::wstring> _requestHeaders;
-	insert_order_map<std::wstring, std::wstring> _responseHeaders;
+	header_map     _requestHeaders, _responseHeaders;
 	std::function<void()> _startCallback, _progressCallback;
 
 public:
@@ -106,8 +106,8 @@ public:
 		return this->abort(); // cleanup
 	}
 
-	const insert_order_map<std::wstring, std::wstring>& get_request_headers() const noexcept  { return this->_requestHeaders; }
-	const insert_order_map<std::wstring, std::wstring>& get_response_headers() const noexcept { return this->_responseHeaders; }
+	const header_map& get_request_headers() const noexcept  { return this->_requestHeaders; }
+	const header_map& get_response_headers() const noexcept { return this->_responseHeaders; }
 	size_t get_content_length() const noexcept   { return this->_contentLength; }
 	size_t get_total_downloaded() const noexcept { return this->_totalGot; }
 
@@ -150,7 +150,7 @@ private:
 		// Add the request headers to request handle.
 		std::wstring rhTmp;
 		rhTmp.reserve(20);
-		for (const insert_order_map<std::wstring, std::wstring>::entry& rh : this->_requestHeaders) {
+		for (const header_map::entry& rh : this->_requestHeaders) {
 			rhTmp = rh.key;
 			rhTmp += L": ";
 			rhTmp += rh.value;
@@ -187,26 +187,29 @@ private:
 
 		// Parse the raw response headers into an associative array.
 		this->_responseHeaders.clear();
-		std::vector<std::wstring> lines = str::split_lines(rawReh);
+		str::trim_nulls(rawReh);
 
-		for (const std::wstring& line : lines) {
+		for (std::wstring_view line : str::split_lines_view(rawReh)) { // no allocations until stored
 			if (line.empty()) {
 				continue;
 			}
 			size_t colonIdx = line.find_first_of(L':');
-			if (colonIdx == std::wstring::npos) { // not a key/value pair, probably response line
-				this->_responseHeaders[L""] = line; // empty key
+			if (colonIdx == std::wstring_view::npos) { // not a key/value pair, probably response line
+				this->_responseHeaders[L""] = std::wstring{line}; // empty key
 			} else {
-				std::wstring kk = line.substr(0, colonIdx);
-				std::wstring vv = line.substr(colonIdx + 1, line.length() - (colonIdx + 1));
-				this->_responseHeaders[str::trim(kk)] = str::trim(vv);
+				this->_responseHeaders[str::trim_view(line.substr(0, colonIdx))] =
+					str::trim_view(line.substr(colonIdx + 1));
 			}
 		}
 
-		// Retrieve content length, if informed by server.
+		// Retrieve content length, if informed by server; any case, and no key is built.
 		const std::wstring* contLen = this->_responseHeaders.get_if_exists(L"Content-Length");
-		if (contLen && str::is_uint(*contLen)) { // yes, server informed content length
-			this->_contentLength = std::stoul(*contLen);
+		if (contLen) {
+			size_t len = 0;
+			str::from_chars_result res = str::from_chars(*contLen, len);
+			if (res.ec == std::errc{} && res.stop == contLen->length()) { // yes, server informed content length
+				this->_contentLength = len;
+			}
 		}
 	}
 
@@ -15,41 +15,39 @@ namespace wl {
 // Wrapper to INI file.
 class file_ini final {
 public:
-	insert_order_map<std::wstring, insert_order_map<std::wstring, std::wstring>> sections;
+	// Like the Windows profile functions, section and key names are case-insensitive.
+	using section = insert_order_map<std::wstring, std::wstring, map_key::ignore_case>;
+	insert_order_map<std::wstring, section, map_key::ignore_case> sections;
 
-	const insert_order_map<std::wstring, std::wstring>& operator[](const std::wstring& sectionName) const {
+	const section& operator[](std::wstring_view sectionName) const {
 		return this->sections.operator[](sectionName);
 	}
 
-	insert_order_map<std::wstring, std::wstring>& operator[](const std::wstring& sectionName) noexcept {
+	section& operator[](std::wstring_view sectionName) {
 		return this->sections.operator[](sectionName);
 	}
 
 	file_ini& load_from_file(const wchar_t* filePath) {
-		std::wstring content = str::to_wstring(file_mapped::util::read(filePath));
-		std::vector<std::wstring> lines = str::split_lines(content);
-		insert_order_map<std::wstring, std::wstring>* curSection = nullptr; // section-less keys will be ignored
-		std::wstring tmpName, tmpValue; // temporary buffers
-
-		for (std::wstring& line : lines) {
-			if (str::trim(line).empty()) { // skip blank lines
-				continue;
-			} else if (line[0] == L'[' && line.back() == L']') { // begin of section found
-				tmpName.clear();
-				tmpName.insert(0, &line[1], line.length() - 2); // extract section name
-				curSection = &this->sections[str::trim(tmpName)]; // if inexistent, will be inserted
-			} else if (curSection && line[0] != L';' && line[0] != L'#') { // lines starting with ; or # will be ignored
-				size_t idxEq = line.find_first_of(L'=');
-				if (idxEq != std::wstring::npos) {
-					tmpName.clear();
-					tmpName.insert(0, &line[0], idxEq); // extract key name
-					tmpValue.clear();
-					tmpValue.insert(0, &line[idxEq + 1], line.length() - (idxEq + 1)); // extract value
-					(*curSection)[tmpName] = tmpValue;
-				}
-			}
+		// The file is decoded in chunks straight from its memory mapping, so neither
+		// a copy of the raw file nor the whole decoded text is ever held in memory.
+		const size_t CHUNK_SIZE = 64 * 1024;
+		file_mapped fin;
+		fin.open(filePath, file::access::READONLY);
+
+		section* curSection = nullptr; // section-less keys will be ignored
+		size_t fileSize = fin.size();
+
+		// The encoding is detected over the whole file, not just the first chunk: a Windows-1252
+		// file can be pure ASCII for a long stretch before its first accented char.
+		str::encoding enc = fileSize ? str::get_encoding(fin.p_mem(), fileSize).encType : str::encoding::UNKNOWN;
+		str::decoder dec{(enc == str::encoding::ASCII) ? str::encoding::UTF8 : enc};
+
+		for (size_t off = 0; off < fileSize; off += CHUNK_SIZE) {
+			dec.feed(fin.p_mem() + off, (fileSize - off < CHUNK_SIZE) ? fileSize - off : CHUNK_SIZE);
+			this->_consume_lines(dec.output(), false, curSection);
 		}
-
+		dec.finish();
+		this->_consume_lines(dec.output(), true, curSection);
 		return *this;
 	}
 
@@ -66,8 +64,8 @@ public:
 		std::wstring out;
 		bool isFirst = true;
 
-		using sectionT = insert_order_map<std::wstring, insert_order_map<std::wstring, std::wstring>>::entry;
-		using entryT = insert_order_map<std::wstring, std::wstring>::entry;
+		using sectionT = insert_order_map<std::wstring, section, map_key::ignore_case>::entry;
+		using entryT = section::entry;
 
 		for (const sectionT& sectionEntry : this->sections) {
 			if (isFirst) {
@@ -89,7 +87,7 @@ public:
 	bool structure_is(const std::wstring& structure) const {
 		using strvecT = std::vector<std::wstring>;
 		for (const insert_order_map<std::wstring, strvecT>::entry& descrSectionEntry : this->_parse_structure(structure)) {
-			const insert_order_map<std::wstring, std::wstring>* pCurSection = this->sections.get_if_exists(descrSectionEntry.key);
+			const section* pCurSection = this->sections.get_if_exists(descrSectionEntry.key);
 			if (!pCurSection) return false; // section name not found
 			for (const std::wstring& descrKeyEntry : descrSectionEntry.value) {
 				if (!pCurSection->has(descrKeyEntry)) return false; // key name not found
@@ -99,6 +97,41 @@ public:
 	}
 
 private:
+	void _consume_lines(std::wstring& text, bool isLast, section*& curSection) {
+		// Parses all complete lines, leaving an incomplete last one in the text.
+		std::wstring_view textView = text;
+		size_t base = 0;
+		for (;;) {
+			size_t lineEnd = text.find_first_of(L"\r\n", base);
+			if (lineEnd == std::wstring::npos) break;
+			if (text[lineEnd] == L'\r' && lineEnd + 1 == text.length() && !isLast) break; // may be half of \r\n
+
+			this->_parse_line(textView.substr(base, lineEnd - base), curSection);
+			base = lineEnd + ((text[lineEnd] == L'\r' && lineEnd + 1 < text.length() && text[lineEnd + 1] == L'\n') ? 2 : 1);
+		}
+		text.erase(0, base);
+
+		if (isLast && !text.empty()) {
+			this->_parse_line(text, curSection);
+			text.clear();
+		}
+	}
+
+	void _parse_line(std::wstring_view line, section*& curSection) {
+		// Names are looked up straight from the views, and only allocated when first inserted.
+		line = str::trim_view(line);
+		if (line.empty()) { // skip blank lines
+			return;
+		} else if (line[0] == L'[' && line.back() == L']') { // begin of section found
+			curSection = &this->sections[str::trim_view(line.substr(1, line.length() - 2))]; // if inexistent, will be inserted
+		} else if (curSection && line[0] != L';' && line[0] != L'#') { // lines starting with ; or # will be ignored
+			size_t idxEq = line.find_first_of(L'=');
+			if (idxEq != std::wstring_view::npos) {
+				(*curSection)[line.substr(0, idxEq)] = line.substr(idxEq + 1);
+			}
+		}
+	}
+
 	insert_order_map<std::wstring, std::vector<std::wstring>> _parse_structure(const std::wstring& structure) const {
 		using strvecT = std::vector<std::wstring>;
 		insert_order_map<std::wstring, strvecT> parsed;
@@ -0,0 +1,437 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "internals/flat_search.h"
+
+namespace wl {
+namespace _wli {
+
+template<typename wrapped_itT>
+class flat_base_iterator {
+protected:
+	wrapped_itT _it;
+public:
+	using iterator_category = typename std::iterator_traits<wrapped_itT>::iterator_category;
+	using value_type        = typename std::iterator_traits<wrapped_itT>::value_type;
+	using difference_type   = typename std::iterator_traits<wrapped_itT>::difference_type;
+	using pointer           = typename std::iterator_traits<wrapped_itT>::pointer;
+	using reference         = typename std::iterator_traits<wrapped_itT>::reference;
+
+	flat_base_iterator() = default;
+	flat_base_iterator(const flat_base_iterator& other) noexcept { this->operator=(other); }
+	flat_base_iterator(const wrapped_itT& it) noexcept : _it(it) { }
+	flat_base_iterator& operator=(const flat_base_iterator& other) noexcept { this->_it = other._it; return *this; }
+	flat_base_iterator  operator+(std::ptrdiff_t off) const { return {this->_it + off}; }
+	flat_base_iterator  operator-(std::ptrdiff_t off) const { return {this->_it - off}; }
+	difference_type     operator-(const flat_base_iterator& other) const { return this->_it - other._it; }
+	flat_base_iterator& operator+=(std::ptrdiff_t off)      { this->_it += off; return *this; }
+	flat_base_iterator& operator-=(std::ptrdiff_t off)      { this->_it -= off; return *this; }
+	flat_base_iterator& operator++()    { ++this->_it; return *this; }
+	flat_base_iterator  operator++(int) { flat_base_iterator tmp = *this; ++this->_it; return tmp; }
+	flat_base_iterator& operator--()    { --this->_it; return *this; }
+	flat_base_iterator  operator--(int) { flat_base_iterator tmp = *this; --this->_it; return tmp; }
+	bool                operator==(const flat_base_iterator& other) const noexcept { return this->_it == other._it; }
+	bool                operator!=(const flat_base_iterator& other) const noexcept { return !this->operator==(other); }
+	bool                operator>(const flat_base_iterator& other) const noexcept  { return this->_it > other._it; }
+	bool                operator<(const flat_base_iterator& other) const noexcept  { return this->_it < other._it; }
+	bool                operator>=(const flat_base_iterator& other) const noexcept { return this->_it >= other._it; }
+	bool                operator<=(const flat_base_iterator& other) const noexcept { return this->_it <= other._it; }
+};
+
+}//namespace _wli
+
+// Associative container kept as a vector sorted by key, for tables which are built once and
+// then mostly read. Lookups are O(log n) over contiguous memory; insertions and removals are O(n),
+// so bulk construction, which sorts only once, is the way to fill it.
+// With a transparent comparator, like the default std::less<>, keys can be looked up by any
+// comparable type, like a literal for std::wstring keys, without building a temporary key.
+template<typename keyT, typename valueT, typename compareT = std::less<>>
+class flat_map final {
+public:
+	struct entry final {
+		keyT   key;
+		valueT value;
+
+		entry() = default;
+		explicit entry(const keyT& key) : key{key} { }
+		entry(const keyT& key, const valueT& value) : key{key}, value{value} { }
+	};
+
+private:
+	template<typename T>
+	using _if_lookup_by = std::enable_if_t<_wli::is_transparent_compare<compareT>::value && !std::is_same_v<T, keyT>>;
+
+	struct _key_of final {
+		const keyT& operator()(const entry& e) const noexcept { return e.key; }
+	};
+
+	std::vector<entry> _entries;
+	_wli::flat_search<keyT, compareT> _search;
+	compareT _comp;
+
+public:
+	flat_map() = default;
+	flat_map(std::initializer_list<entry> entries) { this->assign(std::vector<entry>{entries}); }
+	explicit flat_map(std::vector<entry>&& entries) { this->assign(std::move(entries)); }
+
+	size_t    size() const noexcept  { return this->_entries.size(); }
+	bool      empty() const noexcept { return this->_entries.empty(); }
+	flat_map& reserve(size_t numEntries) { this->_entries.reserve(numEntries); return *this; }
+
+	flat_map& clear() noexcept {
+		this->_entries.clear();
+		this->_search.clear();
+		return *this;
+	}
+
+	// Replaces all entries, sorting them once; among repeated keys, the last one wins.
+	flat_map& assign(std::vector<entry>&& entries) {
+		this->_entries = std::move(entries);
+		this->_sort_unique(this->_entries);
+		this->_search.rebuild(this->_entries, _key_of{});
+		return *this;
+	}
+
+	const valueT& operator[](const keyT& key) const { return this->_at(key); }
+	template<typename T, typename = _if_lookup_by<T>>
+	const valueT& operator[](const T& key) const    { return this->_at(key); }
+
+	valueT& operator[](const keyT& key) { return this->_at_or_add(key); }
+	template<typename T, typename = _if_lookup_by<T>>
+	valueT& operator[](const T& key)    { return this->_at_or_add(key); }
+
+	// Returns pointer to value, if key doesn't exist returns nullptr.
+	const valueT* get_if_exists(const keyT& key) const { return this->_get_if_exists(key); }
+	template<typename T, typename = _if_lookup_by<T>>
+	const valueT* get_if_exists(const T& key) const    { return this->_get_if_exists(key); }
+
+	// Returns pointer to value, if key doesn't exist returns nullptr.
+	valueT* get_if_exists(const keyT& key) { return const_cast<valueT*>(this->_get_if_exists(key)); }
+	template<typename T, typename = _if_lookup_by<T>>
+	valueT* get_if_exists(const T& key)    { return const_cast<valueT*>(this->_get_if_exists(key)); }
+
+	// Does the key exist?
+	bool has(const keyT& key) const { return this->_find(key) != NONE; }
+	template<typename T, typename = _if_lookup_by<T>>
+	bool has(const T& key) const    { return this->_find(key) != NONE; }
+
+	flat_map& remove(const keyT& key) { return this->_remove(key); }
+	template<typename T, typename = _if_lookup_by<T>>
+	flat_map& remove(const T& key)    { return this->_remove(key); }
+
+	// Adds the entries, or std::pair objects, with a single sort and merge; the values of existing keys are replaced.
+	template<typename itT>
+	flat_map& insert_range(itT first, itT last) {
+		std::vector<entry> added;
+		if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<itT>::iterator_category>) {
+			added.reserve(static_cast<size_t>(std::distance(first, last)));
+		}
+		for (; first != last; ++first) {
+			added.emplace_back(keyT(_key_of_item(*first)), _value_of_item(*first));
+		}
+		this->_sort_unique(added);
+
+		std::vector<entry> merged;
+		merged.reserve(this->_entries.size() + added.size());
+		auto cur = this->_entries.begin(), add = added.begin();
+		while (cur != this->_entries.end() && add != added.end()) {
+			if (this->_comp(cur->key, add->key)) {
+				merged.emplace_back(std::move(*cur++));
+			} else {
+				if (!this->_comp(add->key, cur->key)) ++cur; // same key, replaced
+				merged.emplace_back(std::move(*add++));
+			}
+		}
+		std::move(cur, this->_entries.end(), std::back_inserter(merged));
+		std::move(add, added.end(), std::back_inserter(merged));
+		this->_entries.swap(merged);
+		this->_search.rebuild(this->_entries, _key_of{});
+		return *this;
+	}
+
+	flat_map& insert_range(std::initializer_list<entry> entries) {
+		return this->insert_range(entries.begin(), entries.end());
+	}
+
+private:
+	static constexpr size_t NONE = static_cast<size_t>(-1);
+
+	static const keyT&   _key_of_item(const entry& e) noexcept   { return e.key; }
+	static const valueT& _value_of_item(const entry& e) noexcept { return e.value; }
+	template<typename K, typename V>
+	static const K&      _key_of_item(const std::pair<K, V>& p) noexcept   { return p.first; }
+	template<typename K, typename V>
+	static const V&      _value_of_item(const std::pair<K, V>& p) noexcept { return p.second; }
+
+	void _sort_unique(std::vector<entry>& entries) const {
+		std::stable_sort(entries.begin(), entries.end(),
+			[this](const entry& a, const entry& b) { return this->_comp(a.key, b.key); });
+		size_t numUnique = 0;
+		for (size_t i = 0; i < entries.size(); ++i) {
+			if (i + 1 < entries.size() && !this->_comp(entries[i].key, entries[i + 1].key)) continue; // a later one wins
+			if (numUnique != i) entries[numUnique] = std::move(entries[i]);
+			++numUnique;
+		}
+		entries.erase(entries.begin() + numUnique, entries.end());
+	}
+
+	template<typename T>
+	size_t _lower_bound(const T& key) const {
+		return this->_search.lower_bound(this->_entries, _key_of{}, this->_comp, key);
+	}
+
+	template<typename T>
+	size_t _find(const T& key) const {
+		size_t idx = this->_lower_bound(key);
+		return (idx < this->_entries.size() && !this->_comp(key, this->_entries[idx].key)) ? idx : NONE;
+	}
+
+	template<typename T>
+	const valueT& _at(const T& key) const {
+		size_t idx = this->_find(key);
+		if (idx == NONE) {
+			throw std::out_of_range("Key doesn't exist.");
+		}
+		return this->_entries[idx].value;
+	}
+
+	template<typename T>
+	valueT& _at_or_add(const T& key) {
+		size_t idx = this->_lower_bound(key);
+		if (idx == this->_entries.size() || this->_comp(key, this->_entries[idx].key)) {
+			this->_entries.emplace(this->_entries.begin() + idx, keyT(key)); // inexistent, so add
+			this->_search.rebuild(this->_entries, _key_of{});
+		}
+		return this->_entries[idx].value;
+	}
+
+	template<typename T>
+	const valueT* _get_if_exists(const T& key) const {
+		size_t idx = this->_find(key);
+		return (idx == NONE) ? nullptr : &this->_entries[idx].value;
+	}
+
+	template<typename T>
+	flat_map& _remove(const T& key) {
+		size_t idx = this->_find(key);
+		if (idx != NONE) { // won't fail if inexistent
+			this->_entries.erase(this->_entries.begin() + idx);
+			this->_search.rebuild(this->_entries, _key_of{});
+		}
+		return *this;
+	}
+
+	using _const_base = _wli::flat_base_iterator<typename std::vector<entry>::const_iterator>;
+	using _base = _wli::flat_base_iterator<typename std::vector<entry>::iterator>;
+	using _const_reverse_base = _wli::flat_base_iterator<typename std::vector<entry>::const_reverse_iterator>;
+	using _reverse_base = _wli::flat_base_iterator<typename std::vector<entry>::reverse_iterator>;
+
+public:
+	class const_iterator final : public _const_base {
+	public:
+		const_iterator() = default;
+		const_iterator(const const_iterator& other) noexcept : _const_base(other) { }
+		const_iterator(const typename std::vector<entry>::const_iterator& it) noexcept : _const_base(it) { }
+		const_iterator& operator=(const const_iterator& other) noexcept { _const_base::operator=(other); return *this; }
+		const entry&    operator*() const  { return this->_it.operator*(); }
+		const entry*    operator->() const { return this->_it.operator->(); }
+	};
+
+	class iterator final : public _base {
+	public:
+		iterator() = default;
+		iterator(const iterator& other) noexcept : _base(other) { }
+		iterator(const typename std::vector<entry>::iterator& it) noexcept : _base(it) { }
+		iterator& operator=(const iterator& other) noexcept { _base::operator=(other); return *this; }
+		entry&    operator*()  { return this->_it.operator*(); } // changing the key breaks the order
+		entry*    operator->() { return this->_it.operator->(); }
+	};
+
+	const_iterator cbegin() const noexcept { return {this->_entries.cbegin()}; }
+	const_iterator begin() const noexcept  { return {this->_entries.cbegin()}; }
+	iterator       begin() noexcept        { return {this->_entries.begin()}; }
+	const_iterator cend() const noexcept   { return {this->_entries.cend()}; }
+	const_iterator end() const noexcept    { return {this->_entries.cend()}; }
+	iterator       end() noexcept          { return {this->_entries.end()}; }
+
+	class const_reverse_iterator final : public _const_reverse_base {
+	public:
+		const_reverse_iterator() = default;
+		const_reverse_iterator(const const_reverse_iterator& other) noexcept : _const_reverse_base(other) { }
+		const_reverse_iterator(const typename std::vector<entry>::const_reverse_iterator& it) noexcept : _const_reverse_base(it) { }
+		const_reverse_iterator& operator=(const const_reverse_iterator& other) noexcept { _const_reverse_base::operator=(other); return *this; }
+		const entry&            operator*() const  { return this->_it.operator*(); }
+		const entry*            operator->() const { return this->_it.operator->(); }
+		const_iterator          base() const { return {this->_it.base()}; }
+	};
+
+	class reverse_iterator final : public _reverse_base {
+	public:
+		reverse_iterator() = default;
+		reverse_iterator(const reverse_iterator& other) noexcept : _reverse_base(other) { }
+		reverse_iterator(const typename std::vector<entry>::reverse_iterator& it) noexcept : _reverse_base(it) { }
+		reverse_iterator& operator=(const reverse_iterator& other) noexcept { _reverse_base::operator=(other); return *this; }
+		entry&            operator*()  { return this->_it.operator*(); }
+		entry*            operator->() { return this->_it.operator->(); }
+		iterator          base() const { return {this->_it.base()}; }
+	};
+
+	const_reverse_iterator crbegin() const noexcept { return {this->_entries.crbegin()}; }
+	const_reverse_iterator rbegin() const noexcept  { return {this->_entries.crbegin()}; }
+	reverse_iterator       rbegin() noexcept        { return {this->_entries.rbegin()}; }
+	const_reverse_iterator crend() const noexcept   { return {this->_entries.crend()}; }
+	const_reverse_iterator rend() const noexcept    { return {this->_entries.crend()}; }
+	reverse_iterator       rend() noexcept          { return {this->_entries.rend()}; }
+};
+
+// Set kept as a sorted vector, like flat_map; its keys can't be changed through the iterators.
+template<typename keyT, typename compareT = std::less<>>
+class flat_set final {
+private:
+	template<typename T>
+	using _if_lookup_by = std::enable_if_t<_wli::is_transparent_compare<compareT>::value && !std::is_same_v<T, keyT>>;
+
+	struct _key_of final {
+		const keyT& operator()(const keyT& k) const noexcept { return k; }
+	};
+
+	std::vector<keyT> _keys;
+	_wli::flat_search<keyT, compareT> _search;
+	compareT _comp;
+
+public:
+	flat_set() = default;
+	flat_set(std::initializer_list<keyT> keys) { this->assign(std::vector<keyT>{keys}); }
+	explicit flat_set(std::vector<keyT>&& keys) { this->assign(std::move(keys)); }
+
+	size_t    size() const noexcept  { return this->_keys.size(); }
+	bool      empty() const noexcept { return this->_keys.empty(); }
+	flat_set& reserve(size_t numKeys) { this->_keys.reserve(numKeys); return *this; }
+
+	flat_set& clear() noexcept {
+		this->_keys.clear();
+		this->_search.clear();
+		return *this;
+	}
+
+	// Replaces all keys, sorting them once; repeated keys are dropped.
+	flat_set& assign(std::vector<keyT>&& keys) {
+		this->_keys = std::move(keys);
+		this->_sort_unique(this->_keys);
+		this->_search.rebuild(this->_keys, _key_of{});
+		return *this;
+	}
+
+	// Does the key exist?
+	bool has(const keyT& key) const { return this->_find(key) != NONE; }
+	template<typename T, typename = _if_lookup_by<T>>
+	bool has(const T& key) const    { return this->_find(key) != NONE; }
+
+	// Adds the key, if not present yet.
+	flat_set& insert(const keyT& key) {
+		size_t idx = this->_search.lower_bound(this->_keys, _key_of{}, this->_comp, key);
+		if (idx == this->_keys.size() || this->_comp(key, this->_keys[idx])) {
+			this->_keys.emplace(this->_keys.begin() + idx, key);
+			this->_search.rebuild(this->_keys, _key_of{});
+		}
+		return *this;
+	}
+
+	flat_set& remove(const keyT& key) { return this->_remove(key); }
+	template<typename T, typename = _if_lookup_by<T>>
+	flat_set& remove(const T& key)    { return this->_remove(key); }
+
+	// Adds the keys with a single sort and merge.
+	template<typename itT>
+	flat_set& insert_range(itT first, itT last) {
+		std::vector<keyT> added(first, last);
+		this->_sort_unique(added);
+		std::vector<keyT> merged;
+		merged.reserve(this->_keys.size() + added.size());
+		std::set_union(std::make_move_iterator(this->_keys.begin()), std::make_move_iterator(this->_keys.end()),
+			std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()),
+			std::back_inserter(merged), this->_comp);
+		this->_keys.swap(merged);
+		this->_search.rebuild(this->_keys, _key_of{});
+		return *this;
+	}
+
+	flat_set& insert_range(std::initializer_list<keyT> keys) {
+		return this->insert_range(keys.begin(), keys.end());
+	}
+
+private:
+	static constexpr size_t NONE = static_cast<size_t>(-1);
+
+	void _sort_unique(std::vector<keyT>& keys) const {
+		std::sort(keys.begin(), keys.end(), this->_comp);
+		keys.erase(std::unique(keys.begin(), keys.end(),
+			[this](const keyT& a, const keyT& b) { return !this->_comp(a, b); }), keys.end()); // sorted, so a <= b
+	}
+
+	template<typename T>
+	size_t _find(const T& key) const {
+		size_t idx = this->_search.lower_bound(this->_keys, _key_of{}, this->_comp, key);
+		return (idx < this->_keys.size() && !this->_comp(key, this->_keys[idx])) ? idx : NONE;
+	}
+
+	template<typename T>
+	flat_set& _remove(const T& key) {
+		size_t idx = this->_find(key);
+		if (idx != NONE) { // won't fail if inexistent
+			this->_keys.erase(this->_keys.begin() + idx);
+			this->_search.rebuild(this->_keys, _key_of{});
+		}
+		return *this;
+	}
+
+	using _const_base = _wli::flat_base_iterator<typename std::vector<keyT>::const_iterator>;
+	using _const_reverse_base = _wli::flat_base_iterator<typename std::vector<keyT>::const_reverse_iterator>;
+
+public:
+	class const_iterator final : public _const_base {
+	public:
+		const_iterator() = default;
+		const_iterator(const const_iterator& other) noexcept : _const_base(other) { }
+		const_iterator(const typename std::vector<keyT>::const_iterator& it) noexcept : _const_base(it) { }
+		const_iterator& operator=(const const_iterator& other) noexcept { _const_base::operator=(other); return *this; }
+		const keyT&     operator*() const  { return this->_it.operator*(); }
+		const keyT*     operator->() const { return this->_it.operator->(); }
+	};
+
+	const_iterator cbegin() const noexcept { return {this->_keys.cbegin()}; }
+	const_iterator begin() const noexcept  { return {this->_keys.cbegin()}; }
+	const_iterator cend() const noexcept   { return {this->_keys.cend()}; }
+	const_iterator end() const noexcept    { return {this->_keys.cend()}; }
+
+	class const_reverse_iterator final : public _const_reverse_base {
+	public:
+		const_reverse_iterator() = default;
+		const_reverse_iterator(const const_reverse_iterator& other) noexcept : _const_reverse_base(other) { }
+		const_reverse_iterator(const typename std::vector<keyT>::const_reverse_iterator& it) noexcept : _const_reverse_base(it) { }
+		const_reverse_iterator& operator=(const const_reverse_iterator& other) noexcept { _const_reverse_base::operator=(other); return *this; }
+		const keyT&             operator*() const  { return this->_it.operator*(); }
+		const keyT*             operator->() const { return this->_it.operator->(); }
+		const_iterator          base() const { return {this->_it.base()}; }
+	};
+
+	const_reverse_iterator crbegin() const noexcept { return {this->_keys.crbegin()}; }
+	const_reverse_iterator rbegin() const noexcept  { return {this->_keys.crbegin()}; }
+	const_reverse_iterator crend() const noexcept   { return {this->_keys.crend()}; }
+	const_reverse_iterator rend() const noexcept    { return {this->_keys.crend()}; }
+};
+
+}//namespace wl
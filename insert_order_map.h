@@ -6,12 +6,84 @@
  */
 
 #pragma once
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "internals/str_case.h"
 
 namespace wl {
+namespace _wli {
+
+template<typename T, typename = void>
+struct is_std_hashable : std::false_type { };
+template<typename T>
+struct is_std_hashable<T, std::void_t<decltype(std::hash<T>{}(std::declval<const T&>()))>> : std::true_type { };
+
+}//namespace _wli
+
+// Key policies for insert_order_map, which tell how keys are hashed and compared.
+// LOOKUP_BY<T> tells which other types can be searched for directly, without building a key.
+namespace map_key {
+
+// Default policy: std::hash and operator==. std::wstring keys can be looked up by views and literals.
+template<typename keyT>
+struct exact final {
+	static constexpr bool IS_STRING = std::is_same_v<keyT, std::wstring>;
+	static constexpr bool HASHABLE = _wli::is_std_hashable<keyT>::value;
+	template<typename T>
+	static constexpr bool LOOKUP_BY = IS_STRING && std::is_convertible_v<const T&, std::wstring_view>;
+
+	template<typename T>
+	static size_t hash(const T& key) noexcept {
+		if constexpr (IS_STRING) return std::hash<std::wstring_view>{}(std::wstring_view{key}); // same as std::hash<std::wstring>
+		else return std::hash<keyT>{}(key);
+	}
+
+	template<typename T>
+	static bool equal(const keyT& a, const T& b) noexcept {
+		if constexpr (IS_STRING) return std::wstring_view{a} == std::wstring_view{b};
+		else return a == b;
+	}
+};
+
+// Case-insensitive policy, for keys convertible to std::wstring_view, like std::wstring and str_pool::atom.
+struct ignore_case final {
+	static constexpr bool HASHABLE = true;
+	template<typename T>
+	static constexpr bool LOOKUP_BY = std::is_convertible_v<const T&, std::wstring_view>;
+
+	template<typename T>
+	static size_t hash(const T& key) noexcept {
+		unsigned long long h = 0xCBF29CE484222325ull; // FNV-1a over the folded chars, no folded copy is made
+		for (wchar_t ch : std::wstring_view{key}) {
+			h = (h ^ static_cast<unsigned long long>(_wli::str_case::fold(ch))) * 0x100000001B3ull;
+		}
+		return static_cast<size_t>(h ^ (h >> 32));
+	}
+
+	template<typename keyT, typename T>
+	static bool equal(const keyT& a, const T& b) noexcept {
+		std::wstring_view va{a}, vb{b};
+		if (va.length() != vb.length()) return false;
+		for (size_t i = 0; i < va.length(); ++i) {
+			if (va[i] != vb[i] && _wli::str_case::fold(va[i]) != _wli::str_case::fold(vb[i])) return false;
+		}
+		return true;
+	}
+};
+
+}//namespace map_key
 
 // Vector-based associative container which keeps the insertion order.
-template<typename keyT, typename valueT>
+// Past a few entries, lookups go through a hash index kept alongside the entries, if the key is hashable;
+// then removed entries are only flagged, and compacted in a single pass once they are many.
+template<typename keyT, typename valueT, typename policyT = map_key::exact<keyT>>
 class insert_order_map final {
 public:
 	struct entry final {
@@ -24,168 +96,421 @@ public:
 	};
 
 private:
-	std::vector<entry> _entries;
+	template<typename T>
+	using _if_lookup_by = std::enable_if_t<policyT::template LOOKUP_BY<T>>;
+
+	static constexpr size_t   HASH_THRESHOLD = 16; // below that, a linear scan is faster than hashing
+	static constexpr unsigned EMPTY = 0, TOMBSTONE = static_cast<unsigned>(-1); // other slots are entry index + 1
+
+	std::vector<entry>         _entries; // removed ones stay until compaction, but only while there's an index
+	std::vector<unsigned char> _dead;    // flags removed entries; empty if there are none
+	std::vector<unsigned>      _hashes;  // hash of each entry, computed once; empty while there's no index
+	std::vector<unsigned>      _slots;   // open addressing with linear probing, empty until the threshold
+	unsigned                   _slotBits = 0;
+	size_t                     _numDead = 0, _numTombstones = 0;
 
 public:
 	insert_order_map() = default;
-	insert_order_map(insert_order_map&& other) noexcept : _entries{std::move(other._entries)} { }
-	insert_order_map(std::initializer_list<entry> entries) : _entries{entries} { }
+	insert_order_map(insert_order_map&& other) noexcept { this->operator=(std::move(other)); }
+	insert_order_map(std::initializer_list<entry> entries) : _entries{entries} { this->_rebuild_index(); }
+
+	size_t size() const noexcept  { return this->_entries.size() - this->_numDead; }
+	bool   empty() const noexcept { return this->size() == 0; }
+
+	insert_order_map& reserve(size_t numEntries) {
+		this->_entries.reserve(numEntries);
+		if (!this->_slots.empty()) {
+			this->_hashes.reserve(numEntries);
+			if (numEntries * 2 > this->_slots.size()) this->_rebuild_index(numEntries); // won't grow again until then
+		}
+		return *this;
+	}
+
+	// Drops removed entries and frees unused memory.
+	insert_order_map& shrink_to_fit() {
+		this->_rebuild_index(); // sized to the current entries
+		this->_entries.shrink_to_fit();
+		this->_dead.shrink_to_fit();
+		this->_hashes.shrink_to_fit();
+		return *this;
+	}
 
-	size_t            size() const noexcept      { return this->_entries.size(); }
-	bool              empty() const noexcept     { return this->_entries.empty(); }
-	insert_order_map& clear() noexcept           { this->_entries.clear(); return *this; }
-	insert_order_map& reserve(size_t numEntries) { this->_entries.reserve(numEntries); return *this; }
+	insert_order_map& clear() noexcept {
+		this->_entries.clear();
+		this->_dead.clear();
+		this->_hashes.clear();
+		this->_slots.clear();
+		this->_slotBits = 0;
+		this->_numDead = this->_numTombstones = 0;
+		return *this;
+	}
 
 	insert_order_map& operator=(insert_order_map&& other) noexcept {
-		this->empty();
+		this->clear();
 		this->_entries.swap(other._entries);
+		this->_dead.swap(other._dead);
+		this->_hashes.swap(other._hashes);
+		this->_slots.swap(other._slots);
+		std::swap(this->_slotBits, other._slotBits);
+		std::swap(this->_numDead, other._numDead);
+		std::swap(this->_numTombstones, other._numTombstones);
+		return *this;
+	}
+
+	// The lookup methods below also accept, without building a temporary key,
+	// any type allowed by the policy, like a std::wstring_view or a literal for std::wstring keys.
+
+	const valueT& operator[](const keyT& key) const { return this->_at(key); }
+	template<typename T, typename = _if_lookup_by<T>>
+	const valueT& operator[](const T& key) const    { return this->_at(key); }
+
+	valueT& operator[](const keyT& key) { return this->_at_or_add(key); }
+	template<typename T, typename = _if_lookup_by<T>>
+	valueT& operator[](const T& key)    { return this->_at_or_add(key); }
+
+	// Returns pointer to value, if key doesn't exist returns nullptr.
+	const valueT* get_if_exists(const keyT& key) const noexcept { return this->_get_if_exists(key); }
+	template<typename T, typename = _if_lookup_by<T>>
+	const valueT* get_if_exists(const T& key) const noexcept    { return this->_get_if_exists(key); }
+
+	// Returns pointer to value, if key doesn't exist returns nullptr.
+	valueT* get_if_exists(const keyT& key) noexcept { return const_cast<valueT*>(this->_get_if_exists(key)); }
+	template<typename T, typename = _if_lookup_by<T>>
+	valueT* get_if_exists(const T& key) noexcept    { return const_cast<valueT*>(this->_get_if_exists(key)); }
+
+	// Does the key exist?
+	bool has(const keyT& key) const noexcept { return this->_find(key) != NONE; }
+	template<typename T, typename = _if_lookup_by<T>>
+	bool has(const T& key) const noexcept    { return this->_find(key) != NONE; }
+
+	// Amortized constant time once there's an index; iterators to other entries stay valid until a compaction.
+	insert_order_map& remove(const keyT& key) { return this->_remove(key); }
+	template<typename T, typename = _if_lookup_by<T>>
+	insert_order_map& remove(const T& key)    { return this->_remove(key); }
+
+	// Removes all entries for which pred(const entry&) returns true, in a single pass.
+	template<typename predT>
+	insert_order_map& remove_if(predT&& pred) {
+		std::vector<unsigned char> dead(this->_entries.size(), 0);
+		size_t numRemoved = 0;
+		for (size_t i = 0; i < this->_entries.size(); ++i) {
+			if (!this->_is_dead(i) && pred(static_cast<const entry&>(this->_entries[i]))) {
+				dead[i] = 1;
+				++numRemoved;
+			}
+		}
+		if (numRemoved) {
+			for (size_t i = 0; i < this->_dead.size(); ++i) dead[i] |= this->_dead[i];
+			this->_dead.swap(dead);
+			this->_numDead += numRemoved;
+			this->_rebuild_index(); // which drops them
+		}
+		return *this;
+	}
+
+	// Adds the entries, or std::pair objects, in order; the values of existing keys are replaced.
+	template<typename itT>
+	insert_order_map& insert_range(itT first, itT last) {
+		if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<itT>::iterator_category>) {
+			this->reserve(this->size() + static_cast<size_t>(std::distance(first, last))); // at most one reallocation
+		}
+		for (; first != last; ++first) {
+			this->_at_or_add(_key_of(*first)) = _value_of(*first);
+		}
+		return *this;
+	}
+
+	insert_order_map& insert_range(std::initializer_list<entry> entries) {
+		return this->insert_range(entries.begin(), entries.end());
+	}
+
+	// Adds the entries of the other map in its order, replacing the values of existing keys.
+	insert_order_map& merge(const insert_order_map& other) {
+		return this->insert_range(other.begin(), other.end());
+	}
+
+	// Adds the entries of the other map in its order, replacing the values of existing keys; the other map is emptied.
+	insert_order_map& merge(insert_order_map&& other) {
+		if (&other == this) return *this; // merging into itself changes nothing
+		if (this->empty()) return this->operator=(std::move(other));
+		this->reserve(this->size() + other.size());
+		for (entry& e : other) {
+			this->_at_or_add(e.key) = std::move(e.value);
+		}
+		other.clear();
 		return *this;
 	}
 
-	const valueT& operator[](const keyT& key) const {
-		typename std::vector<entry>::const_iterator ite = this->_find(key);
-		if (ite == this->_entries.cend()) {
+private:
+	static constexpr size_t NONE = static_cast<size_t>(-1);
+
+	bool _is_dead(size_t idx) const noexcept { return !this->_dead.empty() && this->_dead[idx]; }
+
+	static const keyT&   _key_of(const entry& e) noexcept   { return e.key; }
+	static const valueT& _value_of(const entry& e) noexcept { return e.value; }
+	template<typename K, typename V>
+	static const K&      _key_of(const std::pair<K, V>& p) noexcept   { return p.first; }
+	template<typename K, typename V>
+	static const V&      _value_of(const std::pair<K, V>& p) noexcept { return p.second; }
+
+	template<typename T>
+	const valueT& _at(const T& key) const {
+		size_t idx = this->_find(key);
+		if (idx == NONE) {
 			throw std::out_of_range("Key doesn't exist.");
 		}
-		return ite->value;
+		return this->_entries[idx].value;
 	}
 
-	valueT& operator[](const keyT& key) noexcept {
-		typename std::vector<entry>::iterator ite = this->_find(key);
-		if (ite == this->_entries.end()) {
-			this->_entries.emplace_back(key); // inexistent, so add
+	template<typename T>
+	valueT& _at_or_add(const T& key) {
+		unsigned h = this->_slots.empty() ? 0 : _hash(key); // computed once for both the search and the insertion
+		size_t idx = this->_find(key, h);
+		if (idx == NONE) {
+			this->_entries.emplace_back(keyT(key)); // inexistent, so add
+			this->_index_added(h);
 			return this->_entries.back().value;
 		}
-		return ite->value;
+		return this->_entries[idx].value;
 	}
 
-	// Returns pointer to value, if key doesn't exist returns nullptr.
-	const valueT* get_if_exists(const keyT& key) const noexcept {
+	template<typename T>
+	const valueT* _get_if_exists(const T& key) const noexcept {
 		// Saves time, instead of calling has() and operator[]().
-		typename std::vector<entry>::const_iterator ite = this->_find(key);
-		return (ite == this->_entries.cend()) ?
-			nullptr : &ite->value;
+		size_t idx = this->_find(key);
+		return (idx == NONE) ? nullptr : &this->_entries[idx].value;
 	}
 
-	// Returns pointer to value, if key doesn't exist returns nullptr.
-	valueT* get_if_exists(const keyT& key) noexcept {
-		typename std::vector<entry>::iterator ite = this->_find(key);
-		return (ite == this->_entries.end()) ?
-			nullptr : &ite->value;
+	template<typename T>
+	insert_order_map& _remove(const T& key) {
+		if (this->_slots.empty()) { // few entries, or not hashable
+			size_t idx = this->_find(key, 0);
+			if (idx != NONE) this->_entries.erase(this->_entries.begin() + idx); // won't fail if inexistent
+			return *this;
+		}
+
+		size_t s = this->_find_slot(key, _hash(key));
+		if (s == NONE) return *this;
+		size_t idx = this->_slots[s] - 1;
+		this->_slots[s] = TOMBSTONE;
+		++this->_numTombstones;
+		if (this->_dead.empty()) this->_dead.resize(this->_entries.size(), 0);
+		this->_dead[idx] = 1;
+		++this->_numDead;
+		if constexpr (std::is_default_constructible_v<valueT>) {
+			this->_entries[idx].value = valueT{}; // frees its memory right away
+		}
+
+		if (this->size() < HASH_THRESHOLD / 2 // small again, back to linear scans
+			|| this->_numDead * 2 > this->_entries.size()
+			|| this->_numTombstones * 4 > this->_slots.size())
+		{
+			this->_rebuild_index(); // compaction
+		}
+		return *this;
 	}
 
-	// Does the key exist?
-	bool has(const keyT& key) const noexcept {
-		return this->_find(key) != this->_entries.cend();
+	template<typename T>
+	static unsigned _hash(const T& key) noexcept {
+		if constexpr (policyT::HASHABLE) {
+			unsigned long long h = policyT::hash(key);
+			return static_cast<unsigned>((h ^ (h >> 29)) * 0x9E3779B97F4A7C15ull >> 32); // pointer-like hashes have weak low bits
+		} else {
+			return 0;
+		}
+	}
+
+	template<typename T>
+	size_t _find(const T& key) const noexcept {
+		return this->_find(key, this->_slots.empty() ? 0 : _hash(key));
 	}
 
-	insert_order_map& remove(const keyT& key) {
-		typename std::vector<entry>::iterator ite = this->_find(key);
-		if (ite != this->_entries.end()) { // won't fail if inexistent
-			this->_entries.erase(ite);
+	template<typename T>
+	size_t _find(const T& key, unsigned h) const noexcept {
+		if (this->_slots.empty()) { // no removed entries without an index
+			for (size_t i = 0; i < this->_entries.size(); ++i) {
+				if (policyT::equal(this->_entries[i].key, key)) return i;
+			}
+			return NONE;
 		}
-		return *this;
+		size_t s = this->_find_slot(key, h);
+		return (s == NONE) ? NONE : this->_slots[s] - 1;
 	}
 
-private:
-	typename std::vector<entry>::const_iterator _find(const keyT& key) const noexcept {
-		for (typename std::vector<entry>::const_iterator ite = this->_entries.cbegin();
-			ite != this->_entries.cend(); ++ite)
-		{
-			if (ite->key == key) return ite;
+	template<typename T>
+	size_t _find_slot(const T& key, unsigned h) const noexcept {
+		size_t mask = this->_slots.size() - 1;
+		for (size_t s = h & mask; ; s = (s + 1) & mask) {
+			unsigned slot = this->_slots[s];
+			if (slot == EMPTY) return NONE;
+			if (slot != TOMBSTONE && this->_hashes[slot - 1] == h // full hashes are compared first, which rules out most keys
+				&& policyT::equal(this->_entries[slot - 1].key, key)) return s;
 		}
-		return this->_entries.cend();
 	}
 
-	typename std::vector<entry>::iterator _find(const keyT& key) noexcept {
-		for (typename std::vector<entry>::iterator ite = this->_entries.begin();
-			ite != this->_entries.end(); ++ite)
-		{
-			if (ite->key == key) return ite;
+	void _place(size_t idx) noexcept { // the key must not be in the index yet
+		size_t mask = this->_slots.size() - 1;
+		size_t s = this->_hashes[idx] & mask;
+		while (this->_slots[s] != EMPTY && this->_slots[s] != TOMBSTONE) s = (s + 1) & mask;
+		if (this->_slots[s] == TOMBSTONE) --this->_numTombstones;
+		this->_slots[s] = static_cast<unsigned>(idx + 1);
+	}
+
+	void _compact() { // drops the removed entries, keeping the order
+		size_t numLive = 0;
+		for (size_t i = 0; i < this->_entries.size(); ++i) {
+			if (this->_is_dead(i)) continue;
+			if (numLive != i) {
+				this->_entries[numLive] = std::move(this->_entries[i]);
+				if (!this->_hashes.empty()) this->_hashes[numLive] = this->_hashes[i];
+			}
+			++numLive;
+		}
+		this->_entries.erase(this->_entries.begin() + numLive, this->_entries.end());
+		if (!this->_hashes.empty()) this->_hashes.resize(numLive);
+		this->_dead.clear();
+		this->_numDead = 0;
+	}
+
+	void _rebuild_index(size_t minCapacity = 0) {
+		if (this->_numDead) this->_compact();
+		this->_slots.clear();
+		this->_numTombstones = 0;
+		if (!policyT::HASHABLE || this->_entries.size() < HASH_THRESHOLD) {
+			this->_hashes.clear();
+			return;
+		}
+
+		for (size_t i = this->_hashes.size(); i < this->_entries.size(); ++i) { // already known hashes are kept
+			this->_hashes.emplace_back(_hash(this->_entries[i].key));
+		}
+		size_t capacity = (minCapacity > this->_entries.size()) ? minCapacity : this->_entries.size();
+		this->_slotBits = 4;
+		while ((size_t{1} << this->_slotBits) < capacity * 2 + 2) ++this->_slotBits;
+		++this->_slotBits; // at most 1/4 full after a rebuild
+		this->_slots.assign(size_t{1} << this->_slotBits, EMPTY);
+		for (size_t i = 0; i < this->_entries.size(); ++i) {
+			if (this->_find(this->_entries[i].key, this->_hashes[i]) == NONE) this->_place(i); // on repeated keys, the first one wins
+		}
+	}
+
+	void _index_added(unsigned h) {
+		if (this->_slots.empty()) {
+			if (this->_entries.size() >= HASH_THRESHOLD) this->_rebuild_index(this->_entries.capacity()); // built once it pays off
+		} else {
+			this->_hashes.emplace_back(h);
+			if (!this->_dead.empty()) this->_dead.emplace_back(0);
+			if ((this->size() + this->_numTombstones) * 2 > this->_slots.size()) {
+				this->_rebuild_index(); // grows, and drops the removed entries
+			} else {
+				this->_place(this->_entries.size() - 1);
+			}
 		}
-		return this->_entries.end();
 	}
 
 private:
-	template<typename wrapped_itT>
+	// Walks the entries, skipping the removed ones; reverse iterators keep the index + 1, like std::reverse_iterator.
+	// Being bidirectional, there's no operator+: std::next() and std::advance() make the O(n) walk explicit.
+	template<typename mapT, typename entryT, bool REVERSE>
 	class _base_iterator {
 	protected:
-		typename wrapped_itT _it;
+		mapT*  _map = nullptr;
+		size_t _pos = 0;
+
+		entryT& _get() const { return this->_map->_entries[REVERSE ? this->_pos - 1 : this->_pos]; }
+		bool _dead_at(size_t pos) const noexcept {
+			return REVERSE ? (pos > 0 && this->_map->_is_dead(pos - 1)) : (pos < this->_map->_entries.size() && this->_map->_is_dead(pos));
+		}
+		void _skip() noexcept { // moves forward to the next live entry, if not on one
+			if (REVERSE) { while (this->_dead_at(this->_pos)) --this->_pos; }
+			else { while (this->_dead_at(this->_pos)) ++this->_pos; }
+		}
+		void _next() noexcept { REVERSE ? --this->_pos : ++this->_pos; this->_skip(); }
+		void _prev() noexcept {
+			do { REVERSE ? ++this->_pos : --this->_pos; } while (this->_dead_at(this->_pos));
+		}
 	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type        = std::remove_const_t<entryT>;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = entryT*;
+		using reference         = entryT&;
+
 		_base_iterator() = default;
 		_base_iterator(const _base_iterator& other) noexcept { this->operator=(other); }
-		_base_iterator(const wrapped_itT& it) noexcept : _it(it) { }
-		_base_iterator& operator=(const _base_iterator& other) noexcept { this->_it = other._it; return *this; }
-		_base_iterator  operator+(std::ptrdiff_t off) const { return {this->_it + off}; }
-		_base_iterator  operator-(std::ptrdiff_t off) const { return {this->_it - off}; }
-		_base_iterator& operator+=(std::ptrdiff_t off)      { this->_it += off; return *this; }
-		_base_iterator& operator-=(std::ptrdiff_t off)      { this->_it -= off; return *this; }
-		_base_iterator& operator++()    { ++this->_it; return *this; }
-		_base_iterator  operator++(int) { _base_iterator tmp = *this; ++this->_it; return tmp; }
-		_base_iterator& operator--()    { --this->_it; return *this; }
-		_base_iterator  operator--(int) { _base_iterator tmp = *this; --this->_it; return tmp; }
-		bool            operator==(const _base_iterator& other) const noexcept { return this->_it == other._it; }
+		_base_iterator(mapT* map, size_t pos) noexcept : _map{map}, _pos{pos} { this->_skip(); }
+		_base_iterator& operator=(const _base_iterator& other) noexcept { this->_map = other._map; this->_pos = other._pos; return *this; }
+		_base_iterator& operator++()    { this->_next(); return *this; }
+		_base_iterator  operator++(int) { _base_iterator tmp = *this; this->_next(); return tmp; }
+		_base_iterator& operator--()    { this->_prev(); return *this; }
+		_base_iterator  operator--(int) { _base_iterator tmp = *this; this->_prev(); return tmp; }
+		bool            operator==(const _base_iterator& other) const noexcept { return this->_pos == other._pos; }
 		bool            operator!=(const _base_iterator& other) const noexcept { return !this->operator==(other); }
-		bool            operator>(const _base_iterator& other) const noexcept  { return this->_it > other._it; }
-		bool            operator<(const _base_iterator& other) const noexcept  { return this->_it < other._it; }
+		bool            operator>(const _base_iterator& other) const noexcept  { return REVERSE ? this->_pos < other._pos : this->_pos > other._pos; }
+		bool            operator<(const _base_iterator& other) const noexcept  { return REVERSE ? this->_pos > other._pos : this->_pos < other._pos; }
 	};
 
+	using _const_base = _base_iterator<const insert_order_map, const entry, false>;
+	using _base = _base_iterator<insert_order_map, entry, false>;
+	using _const_reverse_base = _base_iterator<const insert_order_map, const entry, true>;
+	using _reverse_base = _base_iterator<insert_order_map, entry, true>;
+
 public:
-	class const_iterator final : public _base_iterator<typename std::vector<entry>::const_iterator> {
+	class const_iterator final : public _const_base {
 	public:
 		const_iterator() = default;
-		const_iterator(const const_iterator& other) noexcept : _base_iterator(other) { }
-		const_iterator(const typename std::vector<entry>::const_iterator& it) noexcept : _base_iterator<typename std::vector<entry>::const_iterator>(it) { }
-		const_iterator& operator=(const const_iterator& other) noexcept { return this->_base_iterator(other); }
-		const entry&    operator*() const  { return this->_it.operator*(); }
-		const entry*    operator->() const { return this->_it.operator->(); }
+		const_iterator(const const_iterator& other) noexcept : _const_base(other) { }
+		const_iterator(const insert_order_map* map, size_t pos) noexcept : _const_base(map, pos) { }
+		const_iterator& operator=(const const_iterator& other) noexcept { _const_base::operator=(other); return *this; }
+		const entry&    operator*() const  { return this->_get(); }
+		const entry*    operator->() const { return &this->_get(); }
 	};
 
-	class iterator final : public _base_iterator<typename std::vector<entry>::iterator> {
+	class iterator final : public _base {
 	public:
 		iterator() = default;
-		iterator(const iterator& other) noexcept : _base_iterator(other) { }
-		iterator(const typename std::vector<entry>::iterator& it) noexcept : _base_iterator<typename std::vector<entry>::iterator>(it) { }
-		iterator& operator=(const iterator& other) noexcept { return this->_base_iterator(other); }
-		entry&    operator*()  { return this->_it.operator*(); }
-		entry*    operator->() { return this->_it.operator->(); }
+		iterator(const iterator& other) noexcept : _base(other) { }
+		iterator(insert_order_map* map, size_t pos) noexcept : _base(map, pos) { }
+		iterator& operator=(const iterator& other) noexcept { _base::operator=(other); return *this; }
+		entry&    operator*()  { return this->_get(); }
+		entry*    operator->() { return &this->_get(); }
 	};
 
-	const_iterator cbegin() const noexcept { return {this->_entries.cbegin()}; }
-	const_iterator begin() const noexcept  { return {this->_entries.cbegin()}; }
-	iterator       begin() noexcept        { return {this->_entries.begin()}; }
-	const_iterator cend() const noexcept   { return {this->_entries.cend()}; }
-	const_iterator end() const noexcept    { return {this->_entries.cend()}; }
-	iterator       end() noexcept          { return {this->_entries.end()}; }
+	const_iterator cbegin() const noexcept { return {this, 0}; }
+	const_iterator begin() const noexcept  { return {this, 0}; }
+	iterator       begin() noexcept        { return {this, 0}; }
+	const_iterator cend() const noexcept   { return {this, this->_entries.size()}; }
+	const_iterator end() const noexcept    { return {this, this->_entries.size()}; }
+	iterator       end() noexcept          { return {this, this->_entries.size()}; }
 
-	class const_reverse_iterator final : public _base_iterator<typename std::vector<entry>::const_reverse_iterator> {
+	class const_reverse_iterator final : public _const_reverse_base {
 	public:
 		const_reverse_iterator() = default;
-		const_reverse_iterator(const const_reverse_iterator& other) noexcept : _base_iterator(other) { }
-		const_reverse_iterator(const typename std::vector<entry>::const_reverse_iterator& it) noexcept : _base_iterator<typename std::vector<entry>::const_reverse_iterator>(it) { }
-		const_reverse_iterator& operator=(const const_reverse_iterator& other) noexcept { return this->_base_iterator(other); }
-		const entry&            operator*() const  { return this->_it.operator*(); }
-		const entry*            operator->() const { return this->_it.operator->(); }
-		const_iterator          base() const { return {this->_it.base()}; }
+		const_reverse_iterator(const const_reverse_iterator& other) noexcept : _const_reverse_base(other) { }
+		const_reverse_iterator(const insert_order_map* map, size_t pos) noexcept : _const_reverse_base(map, pos) { }
+		const_reverse_iterator& operator=(const const_reverse_iterator& other) noexcept { _const_reverse_base::operator=(other); return *this; }
+		const entry&            operator*() const  { return this->_get(); }
+		const entry*            operator->() const { return &this->_get(); }
+		const_iterator          base() const { return {this->_map, this->_pos}; }
 	};
 
-	class reverse_iterator final : public _base_iterator<typename std::vector<entry>::reverse_iterator> {
+	class reverse_iterator final : public _reverse_base {
 	public:
 		reverse_iterator() = default;
-		reverse_iterator(const reverse_iterator& other) noexcept : _base_iterator(other) { }
-		reverse_iterator(const typename std::vector<entry>::reverse_iterator& it) noexcept : _base_iterator<typename std::vector<entry>::reverse_iterator>(it) { }
-		reverse_iterator& operator=(const reverse_iterator& other) noexcept { return this->_base_iterator(other); }
-		entry&            operator*()  { return this->_it.operator*(); }
-		entry*            operator->() { return this->_it.operator->(); }
-		iterator          base() const { return {this->_it.base()}; }
+		reverse_iterator(const reverse_iterator& other) noexcept : _reverse_base(other) { }
+		reverse_iterator(insert_order_map* map, size_t pos) noexcept : _reverse_base(map, pos) { }
+		reverse_iterator& operator=(const reverse_iterator& other) noexcept { _reverse_base::operator=(other); return *this; }
+		entry&            operator*()  { return this->_get(); }
+		entry*            operator->() { return &this->_get(); }
+		iterator          base() const { return {this->_map, this->_pos}; }
 	};
 
-	const_reverse_iterator crbegin() const noexcept { return {this->_entries.crbegin()}; }
-	const_reverse_iterator rbegin() const noexcept  { return {this->_entries.crbegin()}; }
-	reverse_iterator       rbegin() noexcept        { return {this->_entries.rbegin()}; }
-	const_reverse_iterator crend() const noexcept   { return {this->_entries.crend()}; }
-	const_reverse_iterator rend() const noexcept    { return {this->_entries.crend()}; }
-	reverse_iterator       rend() noexcept          { return {this->_entries.rend()}; }
+	const_reverse_iterator crbegin() const noexcept { return {this, this->_entries.size()}; }
+	const_reverse_iterator rbegin() const noexcept  { return {this, this->_entries.size()}; }
+	reverse_iterator       rbegin() noexcept        { return {this, this->_entries.size()}; }
+	const_reverse_iterator crend() const noexcept   { return {this, 0}; }
+	const_reverse_iterator rend() const noexcept    { return {this, 0}; }
+	reverse_iterator       rend() noexcept          { return {this, 0}; }
 };
 
 }//namespace wl
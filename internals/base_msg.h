@@ -6,10 +6,17 @@
  */
 
 #pragma once
+#include <stdexcept>
+#include <utility>
 #include "lippincott.h"
-#include "params_wm.h"
+#ifndef WL_HEADLESS
+#include "params_wm.h" // message crackers, not needed by the dispatch itself
 #include "params_wmn.h"
+#endif
 #include "store.h"
+#ifdef WL_PROFILE_DISPATCH
+#include "../dispatch_profiler.h"
+#endif
 
 namespace wl {
 namespace _wli {
@@ -35,8 +42,13 @@ public:
 	}
 
 	std::pair<bool, retT> process_msg(UINT msg, WPARAM wp, LPARAM lp) noexcept {
-		this->_canAdd = false; // lock, no further message handlers can be added
-		std::function<retT(params)>* pUserLambda = nullptr;
+		if (this->_canAdd) {
+			this->_canAdd = false; // lock, no further message handlers can be added
+			this->msgs.freeze(); // so the handlers can be compiled into dispatch tables
+			this->cmds.freeze();
+			this->ntfs.freeze();
+		}
+		delegate<retT(params)>* pUserLambda = nullptr;
 
 		// WM_COMMAND and WM_NOTIFY messages could have been orthogonally inserted into
 		// store<> just like any other messages, however they'd be at the bottom of
@@ -60,6 +72,9 @@ public:
 
 		if (pUserLambda) {
 			try { // any exception from a message lambda which was not caught
+#ifdef WL_PROFILE_DISPATCH
+				dispatch_profiler::scope profile{dispatch_profiler::message_id(msg, wp, lp), this->_hWnd};
+#endif
 				return {true, (*pUserLambda)({msg, wp, lp})};
 			} catch (...) {
 				lippincott();
@@ -7,7 +7,7 @@
 
 #pragma once
 #include "base_msg.h"
-#include <process.h>
+#include "thread_pool.h"
 
 namespace wl {
 namespace _wli {
@@ -17,9 +17,9 @@ template<typename retT, retT RET_VAL>
 class base_thread final {
 private:
 	struct _callback_pack final {
-		std::function<void()> func;
-		HWND                  hWnd = nullptr;
-		std::exception_ptr    curExcept = nullptr;
+		delegate<void()>   func;
+		HWND               hWnd = nullptr;
+		std::exception_ptr curExcept = nullptr;
 	};
 
 	static const UINT WM_THREAD_MESSAGE = WM_APP + 0x3FFF;
@@ -36,35 +36,40 @@ public:
 		});
 	}
 
-	// Runs code asynchronously in a new detached thread.
-	void run_thread_detached(std::function<void()> func) const noexcept {
-		// Analog to std::thread([](){ ... }).detach(), but exception-safe.
-		_callback_pack* pPack = new _callback_pack{std::move(func), this->_baseMsg.hwnd()};
-
-		uintptr_t hThread = _beginthreadex(nullptr, 0, [](void* ptr) noexcept -> unsigned int {
-			_callback_pack* pPack = reinterpret_cast<_callback_pack*>(ptr);
-			try {
-				pPack->func(); // invoke user callback
-			} catch (...) {
-				_callback_pack* pCrashed = new _callback_pack{[]{}, pPack->hWnd, std::current_exception()};
-				SendMessageW(pPack->hWnd, WM_THREAD_MESSAGE, 0, reinterpret_cast<LPARAM>(pCrashed));
-			}
-			delete pPack;
-			_endthreadex(0); // http://www.codeproject.com/Articles/7732/A-class-to-synchronise-thread-completions/
-			return 0;
-		}, pPack, 0, nullptr);
-
-		CloseHandle(reinterpret_cast<HANDLE>(hThread));
+	// Runs code asynchronously in a worker of the process-wide thread pool; returns false if it
+	// couldn't be queued.
+	bool run_thread_detached(delegate<void()> func, task_priority prio = task_priority::NORMAL) const noexcept {
+		// Analog to std::thread([](){ ... }).detach(), but exception-safe, and without creating a
+		// thread each time. If the pool queues are full, the UI thread doesn't wait, since the
+		// queued tasks may be waiting on it with run_thread_ui(); other threads wait for a while.
+		HWND hWnd = this->_baseMsg.hwnd();
+		std::chrono::milliseconds timeout = (GetWindowThreadProcessId(hWnd, nullptr) == GetCurrentThreadId())
+			? std::chrono::milliseconds::zero() : std::chrono::seconds(1);
+		try {
+			return thread_pool::instance().submit([func = std::move(func), hWnd]() noexcept {
+				try {
+#ifdef WL_PROFILE_DISPATCH
+					dispatch_profiler::scope profile{{dispatch_profiler::kind::THREAD_DETACHED, 0, 0}, hWnd};
+#endif
+					func(); // invoke user callback
+				} catch (...) {
+					_callback_pack crashed{nullptr, hWnd, std::current_exception()};
+					SendMessageW(hWnd, WM_THREAD_MESSAGE, 0, reinterpret_cast<LPARAM>(&crashed));
+				}
+			}, prio, timeout);
+		} catch (...) { // no memory for the task, or no thread for the pool
+			return false;
+		}
 	}
 
 	// Runs code synchronously in the UI thread.
-	void run_thread_ui(std::function<void()> func) const noexcept {
+	void run_thread_ui(delegate<void()> func) const noexcept {
 		// This method is analog to SendMessage (synchronous), but intended to be called
 		// from another thread, so a callback function can, tunelled by wndproc, run in
 		// the original thread of the window, thus allowing GUI updates. This avoids the
 		// user to deal with a custom WM_ message.
-		_callback_pack* pPack = new _callback_pack{std::move(func), this->_baseMsg.hwnd()};
-		SendMessageW(this->_baseMsg.hwnd(), WM_THREAD_MESSAGE, 0, reinterpret_cast<LPARAM>(pPack));
+		_callback_pack pack{std::move(func), this->_baseMsg.hwnd()}; // SendMessage is synchronous, so it can live in the stack
+		SendMessageW(this->_baseMsg.hwnd(), WM_THREAD_MESSAGE, 0, reinterpret_cast<LPARAM>(&pack));
 	}
 
 private:
@@ -79,13 +84,15 @@ private:
 			}
 		} else { // from run_thread_ui()
 			try {
+#ifdef WL_PROFILE_DISPATCH
+				dispatch_profiler::scope profile{{dispatch_profiler::kind::THREAD_UI, 0, 0}, pPack->hWnd};
+#endif
 				pPack->func(); // invoke user callback
 			} catch (...) {
 				lippincott();
 				PostQuitMessage(-1);
 			}
 		}
-		delete pPack;
 	}
 };
 
@@ -21,13 +21,16 @@ public:
 	base_thread_pubm(base_thread<retT, RET_VAL>& baseThread) :
 		_baseThread(baseThread) { }
 
-	// Runs code asynchronously in a new detached thread.
-	void run_thread_detached(std::function<void()> func) const noexcept {
-		return this->_baseThread.run_thread_detached(std::move(func));
+	// Runs code asynchronously in a worker of the process-wide thread pool, which has one worker per
+	// core. Code which blocks for long, like waiting on a socket or a process, must use its own thread.
+	// Returns false if the code won't run: the pool queues were full, which the UI thread doesn't
+	// wait for, and other threads wait for up to a second; or there was no memory.
+	bool run_thread_detached(delegate<void()> func, task_priority prio = task_priority::NORMAL) const noexcept {
+		return this->_baseThread.run_thread_detached(std::move(func), prio);
 	}
 
 	// Runs code synchronously in the UI thread.
-	void run_thread_ui(std::function<void()> func) const noexcept {
+	void run_thread_ui(delegate<void()> func) const noexcept {
 		return this->_baseThread.run_thread_ui(std::move(func));
 	}
 };
@@ -0,0 +1,148 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bytes of a delegate buffer; callables up to this size are stored without allocation.
+// The default fits a lambda capturing 4 pointers, or "this" and a few values.
+#ifndef WL_DELEGATE_BUFFER
+#define WL_DELEGATE_BUFFER (4 * sizeof(void*))
+#endif
+
+namespace wl {
+namespace _wli {
+
+template<typename signatureT, size_t BUF_SIZE = WL_DELEGATE_BUFFER>
+class delegate;
+
+// Move-only replacement for std::function. Callables which fit the buffer and can be moved without
+// throwing are stored in place, others are allocated. There's no RTTI: the delegate keeps a pointer
+// to the function which calls the stored type, and another one to move and destroy it, which is
+// null for trivial callables, like lambdas capturing only "this", so these are just copied.
+template<typename retT, typename... argsT, size_t BUF_SIZE>
+class delegate<retT(argsT...), BUF_SIZE> final {
+private:
+	static_assert(BUF_SIZE >= sizeof(void*), "Delegate buffer must be able to hold a pointer.");
+
+	enum class _op { MOVE, DESTROY };
+	using _invoke_func = retT(*)(void*, argsT&&...);
+	using _manage_func = void(*)(_op, void*, void*) noexcept;
+
+	template<typename funcT>
+	static constexpr bool _IS_INLINE = sizeof(funcT) <= BUF_SIZE
+		&& alignof(funcT) <= alignof(std::max_align_t)
+		&& std::is_nothrow_move_constructible_v<funcT>;
+
+	alignas(std::max_align_t) mutable unsigned char _buf[BUF_SIZE] = {}; // zeroed, since trivial callables are moved by copying it all
+	_invoke_func _invoke = &_invoke_empty;
+	_manage_func _manage = nullptr; // null if the buffer can be simply copied
+
+public:
+	~delegate() {
+		this->_reset();
+	}
+
+	delegate() noexcept { }
+	delegate(std::nullptr_t) noexcept { }
+	delegate(delegate&& other) noexcept { this->_take(other); }
+
+	template<typename funcT, typename decayT = std::decay_t<funcT>,
+		typename = std::enable_if_t<!std::is_same_v<decayT, delegate>
+			&& std::is_invocable_r_v<retT, decayT&, argsT...>>>
+	delegate(funcT&& func) {
+		if constexpr (std::is_pointer_v<std::remove_reference_t<funcT>> || std::is_member_pointer_v<decayT>) { // a function name can't be null
+			if (!func) return; // a null function pointer makes an empty delegate, like std::function
+		}
+
+		if constexpr (_IS_INLINE<decayT>) {
+			::new (static_cast<void*>(this->_buf)) decayT(std::forward<funcT>(func));
+			this->_invoke = [](void* buf, argsT&&... args) -> retT {
+				return _call(*std::launder(reinterpret_cast<decayT*>(buf)), std::forward<argsT>(args)...);
+			};
+			if constexpr (!std::is_trivially_copyable_v<decayT>) {
+				this->_manage = [](_op op, void* buf, void* dest) noexcept {
+					decayT* pFunc = std::launder(reinterpret_cast<decayT*>(buf));
+					if (op == _op::MOVE) ::new (dest) decayT(std::move(*pFunc));
+					pFunc->~decayT();
+				};
+			}
+		} else {
+			decayT* pFunc = new decayT(std::forward<funcT>(func));
+			std::memcpy(this->_buf, &pFunc, sizeof(pFunc));
+			this->_invoke = [](void* buf, argsT&&... args) -> retT {
+				return _call(**reinterpret_cast<decayT**>(buf), std::forward<argsT>(args)...);
+			};
+			this->_manage = [](_op op, void* buf, void* dest) noexcept {
+				if (op == _op::MOVE) std::memcpy(dest, buf, sizeof(decayT*)); // the pointer goes along
+				else delete *reinterpret_cast<decayT**>(buf);
+			};
+		}
+	}
+
+	delegate& operator=(delegate&& other) noexcept {
+		if (this != &other) {
+			this->_reset();
+			this->_take(other);
+		}
+		return *this;
+	}
+
+	delegate& operator=(std::nullptr_t) noexcept {
+		this->_reset();
+		return *this;
+	}
+
+	explicit operator bool() const noexcept {
+		return this->_invoke != &_invoke_empty;
+	}
+
+	// Calls the stored callable; throws std::bad_function_call if empty.
+	retT operator()(argsT... args) const {
+		return this->_invoke(this->_buf, std::forward<argsT>(args)...);
+	}
+
+private:
+	template<typename funcT>
+	static retT _call(funcT& func, argsT&&... args) {
+		if constexpr (std::is_void_v<retT>) {
+			std::invoke(func, std::forward<argsT>(args)...); // discards any result
+		} else {
+			return std::invoke(func, std::forward<argsT>(args)...);
+		}
+	}
+
+	[[noreturn]] static retT _invoke_empty(void*, argsT&&...) {
+		throw std::bad_function_call();
+	}
+
+	void _take(delegate& other) noexcept {
+		if (other._manage) {
+			other._manage(_op::MOVE, other._buf, this->_buf);
+		} else if (other) {
+			std::memcpy(this->_buf, other._buf, BUF_SIZE);
+		}
+		this->_invoke = other._invoke;
+		this->_manage = other._manage;
+		other._invoke = &_invoke_empty;
+		other._manage = nullptr;
+	}
+
+	void _reset() noexcept {
+		if (this->_manage) this->_manage(_op::DESTROY, this->_buf, nullptr);
+		this->_invoke = &_invoke_empty;
+		this->_manage = nullptr;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,106 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define WL_FLAT_SEARCH_PREFETCH
+#endif
+
+namespace wl {
+namespace _wli {
+
+template<typename compareT, typename = void>
+struct is_transparent_compare : std::false_type { };
+template<typename compareT>
+struct is_transparent_compare<compareT, std::void_t<typename compareT::is_transparent>> : std::true_type { };
+
+// Lower bound search over a sorted vector, used by flat_map and flat_set.
+// Small trivial keys, like ints and message ids, are also copied in Eytzinger order, where the
+// binary search tree is laid out breadth-first: the first levels share a few cache lines, and the
+// descendants a few levels down are adjacent, so they are prefetched while the search goes on.
+// Other trivial keys are searched in place without a branch on the comparison; keys like strings,
+// whose comparison branches anyway, use a plain binary search, which lets the CPU speculate ahead.
+template<typename keyT, typename compareT>
+class flat_search final {
+public:
+	static constexpr bool EYTZINGER = std::is_trivially_copyable_v<keyT> && sizeof(keyT) <= sizeof(void*);
+	static constexpr bool BRANCHLESS = std::is_trivially_copyable_v<keyT>;
+
+private:
+	struct _node final {
+		keyT     key;
+		unsigned idx; // position in the sorted vector
+	};
+
+	static constexpr size_t NODES_PER_LINE = (sizeof(_node) < 64) ? 64 / sizeof(_node) : 1;
+
+	std::vector<_node> _nodes; // 1-based, so the children of k are 2k and 2k+1
+
+public:
+	void clear() noexcept { this->_nodes.clear(); }
+
+	// Must be called after each change to the sorted vector.
+	template<typename elemT, typename keyOfT>
+	void rebuild(const std::vector<elemT>& sorted, keyOfT&& keyOf) {
+		if constexpr (EYTZINGER) {
+			this->_nodes.resize(sorted.size() + 1);
+			size_t next = 0;
+			this->_fill(sorted, keyOf, 1, next);
+		}
+	}
+
+	// Returns the index of the first element not less than the key, or the size if none.
+	template<typename elemT, typename keyOfT, typename T>
+	size_t lower_bound(const std::vector<elemT>& sorted, keyOfT&& keyOf,
+		const compareT& comp, const T& key) const
+	{
+		size_t n = sorted.size();
+		if (!n) return 0;
+
+		if constexpr (EYTZINGER) {
+			const _node* nodes = this->_nodes.data();
+			size_t k = 1, found = 0;
+			while (k <= n) {
+#ifdef WL_FLAT_SEARCH_PREFETCH
+				_mm_prefetch(reinterpret_cast<const char*>(nodes + std::min(k * NODES_PER_LINE, n)), _MM_HINT_T0);
+#endif
+				bool goRight = comp(nodes[k].key, key);
+				found = goRight ? found : k; // last node where we went left is the answer
+				k = 2 * k + goRight;
+			}
+			return found ? nodes[found].idx : n;
+		} else if constexpr (BRANCHLESS) {
+			const elemT* base = sorted.data();
+			while (n > 1) {
+				size_t half = n / 2;
+				base = comp(keyOf(base[half]), key) ? base + half : base; // compiled to a conditional move
+				n -= half;
+			}
+			return static_cast<size_t>(base - sorted.data()) + comp(keyOf(*base), key);
+		} else {
+			return static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), key,
+				[&](const elemT& e, const T& k) { return comp(keyOf(e), k); }) - sorted.begin());
+		}
+	}
+
+private:
+	template<typename elemT, typename keyOfT>
+	void _fill(const std::vector<elemT>& sorted, keyOfT& keyOf, size_t k, size_t& next) {
+		if (k >= this->_nodes.size()) return;
+		this->_fill(sorted, keyOf, 2 * k, next); // in-order traversal visits the keys sorted
+		this->_nodes[k] = {keyOf(sorted[next]), static_cast<unsigned>(next)};
+		++next;
+		this->_fill(sorted, keyOf, 2 * k + 1, next);
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,84 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+// Minimal stand-ins for the Win32 declarations used by the message dispatch: params, store and
+// base_msg. With WL_HEADLESS defined, these headers include this one instead of <Windows.h>, so
+// the dispatch can be tested and benchmarked without a window, on any compiler and platform.
+// The Windows.h stub of the tests builds on this one, so they never disagree.
+// Types have the sizes of Windows on the same pointer size; only the message dispatch is supported.
+
+typedef unsigned short WORD;
+typedef unsigned int   UINT;
+typedef uint32_t       DWORD; // unsigned long is 64 bits on Linux and macOS
+typedef int            BOOL;
+typedef intptr_t       INT_PTR;
+typedef uintptr_t      UINT_PTR;
+typedef intptr_t       LONG_PTR;
+typedef uintptr_t      DWORD_PTR;
+typedef UINT_PTR       WPARAM;
+typedef LONG_PTR       LPARAM;
+typedef LONG_PTR       LRESULT;
+typedef struct HWND__* HWND;
+static_assert(sizeof(WORD) == 2 && sizeof(UINT) == 4 && sizeof(DWORD) == 4, "Win32 integer sizes.");
+
+#ifndef TRUE
+#define TRUE  1
+#define FALSE 0
+#endif
+
+#define LOWORD(l) (static_cast<WORD>(static_cast<DWORD_PTR>(l) & 0xFFFF))
+#define HIWORD(l) (static_cast<WORD>((static_cast<DWORD_PTR>(l) >> 16) & 0xFFFF))
+#define MAKEWPARAM(l, h) (static_cast<WPARAM>(static_cast<DWORD>(static_cast<WORD>(l) | (static_cast<DWORD>(static_cast<WORD>(h)) << 16))))
+#define MAKELPARAM(l, h) (static_cast<LPARAM>(static_cast<DWORD>(static_cast<WORD>(l) | (static_cast<DWORD>(static_cast<WORD>(h)) << 16))))
+
+#define WM_PAINT        0x000F
+#define WM_SETCURSOR    0x0020
+#define WM_NOTIFY       0x004E
+#define WM_NCHITTEST    0x0084
+#define WM_NCPAINT      0x0085
+#define WM_NCMOUSEMOVE  0x00A0
+#define WM_COMMAND      0x0111
+#define WM_TIMER        0x0113
+#define WM_MOUSEMOVE    0x0200
+#define WM_LBUTTONDOWN  0x0201
+#define WM_LBUTTONUP    0x0202
+#define WM_MOUSEWHEEL   0x020A
+#define WM_MOUSEHOVER   0x02A1
+#define WM_MOUSELEAVE   0x02A3
+#define WM_USER         0x0400
+#define WM_APP          0x8000
+
+#define BN_CLICKED      0
+#define EN_CHANGE       0x0300
+
+#define NM_CLICK        (0U - 2U)
+#define NM_DBLCLK       (0U - 3U)
+#define NM_CUSTOMDRAW   (0U - 12U)
+#define NM_HOVER        (0U - 13U)
+#define LVN_FIRST       (0U - 100U)
+#define LVN_ITEMCHANGED (LVN_FIRST - 1)
+#define LVN_HOTTRACK    (LVN_FIRST - 21)
+#define LVN_GETDISPINFO (LVN_FIRST - 77)
+
+#define MB_ICONERROR    0x00000010L
+
+struct NMHDR {
+	HWND     hwndFrom;
+	UINT_PTR idFrom;
+	UINT     code;
+};
+
+inline int MessageBoxA(HWND, const char* text, const char* caption, UINT) {
+	std::fprintf(stderr, "%s\n%s\n", caption, text); // unhandled exceptions are reported here
+	return 0;
+}
+
+inline void PostQuitMessage(int) { }
@@ -6,8 +6,13 @@
  */
 
 #pragma once
+#include <stdexcept>
 #include <system_error>
+#ifdef WL_HEADLESS
+#include "headless.h"
+#else
 #include <Windows.h>
+#endif
 
 namespace wl {
 namespace _wli {
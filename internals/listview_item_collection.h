@@ -8,6 +8,8 @@
 #pragma once
 #include <vector>
 #include "listview_item.h"
+#include "../search_index.h"
+#include "../str.h"
 
 namespace wl {
 namespace _wli {
@@ -213,6 +215,46 @@ public:
 		return (iFoc == -1) ? listview_item::npos : static_cast<size_t>(iFoc);
 	}
 
+	// Sorts the items by the texts of the given column. Sort keys are computed once per item, and
+	// the listview only compares their ranks, instead of comparing texts at each step.
+	listview_item_collection& sort_by_text(size_t columnIndex = 0,
+		str::collate how = str::collate::NATURAL_IGNORE_CASE, bool ascending = true)
+	{
+		std::vector<size_t> order = str::sort_order(this->get_texts(this->get_all(), columnIndex), how);
+		std::vector<size_t> ranks(order.size());
+		for (size_t pos = 0; pos < order.size(); ++pos) {
+			ranks[order[pos]] = ascending ? pos : order.size() - 1 - pos;
+		}
+
+		ListView_SortItemsEx(this->_hList, // with SortItemsEx, the indexes received are the positions before sorting
+			[](LPARAM idx1, LPARAM idx2, LPARAM lp) -> int {
+				const std::vector<size_t>& ranks = *reinterpret_cast<const std::vector<size_t>*>(lp);
+				return (ranks[idx1] < ranks[idx2]) ? -1 : (ranks[idx1] > ranks[idx2]) ? 1 : 0;
+			},
+			reinterpret_cast<LPARAM>(&ranks));
+		return *this;
+	}
+
+	// Builds a search index with the texts of the given column, whose ids are the item indexes.
+	search_index build_search_index(size_t columnIndex = 0) const {
+		return search_index{this->get_texts(this->get_all(), columnIndex)};
+	}
+
+	// Selects the items which match the query in the index, and scrolls to the best one;
+	// an empty query selects nothing.
+	listview_item_collection& select_matches(const search_index& index,
+		std::wstring_view query, search_index::match how = search_index::match::FUZZY)
+	{
+		this->select_none();
+		if (query.empty()) return *this;
+		std::vector<size_t> indexes = index.find_ids(query, how);
+		this->select(indexes);
+		if (!indexes.empty()) {
+			ListView_EnsureVisible(this->_hList, static_cast<int>(indexes.front()), FALSE);
+		}
+		return *this;
+	}
+
 	// Return the texts, from the given column, from the given items.
 	std::vector<std::wstring> get_texts(const std::vector<listview_item>& itemsToGet,
 		size_t columnIndex = 0) const
@@ -0,0 +1,195 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "base_msg.h"
+
+namespace wl {
+namespace _wli {
+
+// A recorded or synthetic stream of window messages, replayed straight into a base_msg, with no
+// window involved; with WL_HEADLESS defined, it builds on any platform. Each WM_NOTIFY carries its
+// own copy of the notification struct, which lParam points to when replayed.
+class msg_replay final {
+public:
+	struct stats final {
+		size_t messages;     // dispatched in all rounds
+		size_t handled;      // of these, how many had a handler
+		double msgsPerSec;
+		double p50Ns, p99Ns, maxNs; // dispatch latency, clock overhead discounted
+		double allocsPerMsg; // zero if no allocation counter was given
+	};
+
+private:
+	static const size_t NOTIFY_BYTES = 128; // room for the bigger notification structs, like NMLVDISPINFO
+
+	struct alignas(std::max_align_t) _notify_block final {
+		unsigned char bytes[NOTIFY_BYTES];
+	};
+
+	std::vector<params>        _msgs; // lParam of WM_NOTIFY is an index in _notifies
+	std::vector<_notify_block> _notifies;
+	unsigned                   _seed = 1;
+
+public:
+	size_t size() const noexcept { return this->_msgs.size(); }
+	bool   empty() const noexcept { return this->_msgs.empty(); }
+
+	msg_replay& clear() noexcept {
+		this->_msgs.clear();
+		this->_notifies.clear();
+		return *this;
+	}
+
+	// Appends a message; for WM_NOTIFY, the NMHDR pointed by lParam is copied.
+	msg_replay& add(UINT msg, WPARAM wp = 0, LPARAM lp = 0) {
+		if (msg == WM_NOTIFY) return this->add_notify(*reinterpret_cast<const NMHDR*>(lp));
+		this->_msgs.push_back({msg, wp, lp});
+		return *this;
+	}
+
+	msg_replay& add_command(WORD cmdId, WORD notifCode = 0) {
+		this->_msgs.push_back({WM_COMMAND, MAKEWPARAM(cmdId, notifCode), 0});
+		return *this;
+	}
+
+	msg_replay& add_notify(UINT_PTR idFrom, UINT code) {
+		NMHDR nm{};
+		nm.idFrom = idFrom;
+		nm.code = code;
+		return this->add_notify(nm);
+	}
+
+	// Appends a WM_NOTIFY with a copy of the given notification struct, which begins with NMHDR.
+	template<typename nmT>
+	msg_replay& add_notify(const nmT& nm) {
+		static_assert(std::is_trivially_copyable_v<nmT> && sizeof(nmT) <= NOTIFY_BYTES,
+			"Notification struct must be trivially copyable and fit the notify block.");
+		_notify_block block{};
+		std::memcpy(block.bytes, &nm, sizeof(nmT));
+		this->_msgs.push_back({WM_NOTIFY, static_cast<WPARAM>(reinterpret_cast<const NMHDR&>(nm).idFrom),
+			static_cast<LPARAM>(this->_notifies.size())});
+		this->_notifies.emplace_back(block);
+		return *this;
+	}
+
+	// Appends mouse traffic as a moving pointer generates it: hit tests, cursor updates and moves,
+	// with an occasional hover, timer and paint.
+	msg_replay& add_mouse_storm(size_t count) {
+		for (size_t i = 0; i < count; ) {
+			LPARAM pos = MAKELPARAM(this->_random() % 1920, this->_random() % 1080);
+			this->add(WM_NCHITTEST, 0, pos).add(WM_SETCURSOR, 0, MAKELPARAM(1, WM_MOUSEMOVE)).add(WM_MOUSEMOVE, 0, pos);
+			i += 3;
+			switch (this->_random() % 16) {
+			case 0: this->add(WM_MOUSEHOVER, 0, pos); ++i; break;
+			case 1: this->add(WM_TIMER, 1); ++i; break;
+			case 2: this->add(WM_PAINT); ++i; break;
+			}
+		}
+		return *this;
+	}
+
+	// Appends notifications of a scrolling owner-drawn listview: mostly custom draw and display
+	// info requests, then hot tracking and item changes.
+	msg_replay& add_listview_burst(UINT_PTR idFrom, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			unsigned r = this->_random() % 20;
+			this->add_notify(idFrom, r < 12 ? NM_CUSTOMDRAW
+				: r < 17 ? LVN_GETDISPINFO
+				: r < 19 ? LVN_HOTTRACK : LVN_ITEMCHANGED);
+		}
+		return *this;
+	}
+
+	// Appends WM_COMMAND messages randomly picked from the given ids, a quarter of them EN_CHANGE.
+	msg_replay& add_commands(const std::vector<WORD>& cmdIds, size_t count) {
+		for (size_t i = 0; i < count && !cmdIds.empty(); ++i) {
+			this->add_command(cmdIds[this->_random() % cmdIds.size()],
+				(this->_random() % 4) ? BN_CLICKED : EN_CHANGE);
+		}
+		return *this;
+	}
+
+	// Dispatches the whole stream once, returning how many messages had a handler.
+	template<typename retT>
+	size_t replay(base_msg<retT>& baseMsg) {
+		std::vector<params> msgs = this->_resolved();
+		size_t handled = 0;
+		for (const params& p : msgs) {
+			handled += baseMsg.process_msg(p.message, p.wParam, p.lParam).first;
+		}
+		return handled;
+	}
+
+	// Dispatches the stream the given number of rounds, timing the whole, then once more timing each
+	// message. To count allocations, pass a function returning the number of allocations so far,
+	// usually incremented by a replaced global operator new.
+	template<typename retT>
+	stats bench(base_msg<retT>& baseMsg, size_t rounds = 1, size_t (*allocCount)() = nullptr) {
+		using clock = std::chrono::steady_clock;
+		std::vector<params> msgs = this->_resolved();
+		std::vector<long long> latencies(msgs.size()); // allocated before any timing
+		stats s{};
+		if (msgs.empty()) return s;
+
+		size_t allocsBefore = allocCount ? allocCount() : 0;
+		clock::time_point t0 = clock::now();
+		for (size_t r = 0; r < rounds; ++r) {
+			for (const params& p : msgs) {
+				s.handled += baseMsg.process_msg(p.message, p.wParam, p.lParam).first;
+			}
+		}
+		double secs = std::chrono::duration<double>(clock::now() - t0).count();
+		s.messages = msgs.size() * rounds;
+		s.msgsPerSec = secs > 0 ? s.messages / secs : 0;
+		if (allocCount) s.allocsPerMsg = static_cast<double>(allocCount() - allocsBefore) / s.messages;
+
+		long long overhead = -1; // cost of reading the clock twice, to be discounted
+		for (int i = 0; i < 1000; ++i) {
+			clock::time_point a = clock::now();
+			long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - a).count();
+			overhead = (overhead < 0) ? ns : std::min(overhead, ns);
+		}
+		for (size_t i = 0; i < msgs.size(); ++i) {
+			clock::time_point a = clock::now();
+			baseMsg.process_msg(msgs[i].message, msgs[i].wParam, msgs[i].lParam);
+			latencies[i] = std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - a).count() - overhead, 0LL);
+		}
+		s.p50Ns = static_cast<double>(_percentile(latencies, 50));
+		s.p99Ns = static_cast<double>(_percentile(latencies, 99));
+		s.maxNs = static_cast<double>(*std::max_element(latencies.begin(), latencies.end()));
+		return s;
+	}
+
+private:
+	unsigned _random() noexcept {
+		this->_seed = this->_seed * 1103515245u + 12345u; // deterministic, so runs are comparable
+		return this->_seed >> 8;
+	}
+
+	std::vector<params> _resolved() {
+		std::vector<params> msgs = this->_msgs;
+		for (params& p : msgs) {
+			if (p.message == WM_NOTIFY) p.lParam = reinterpret_cast<LPARAM>(this->_notifies[p.lParam].bytes);
+		}
+		return msgs;
+	}
+
+	static long long _percentile(std::vector<long long>& values, size_t pct) {
+		auto nth = values.begin() + (values.size() - 1) * pct / 100;
+		std::nth_element(values.begin(), nth, values.end());
+		return *nth;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -6,7 +6,11 @@
  */
 
 #pragma once
+#ifdef WL_HEADLESS
+#include "headless.h"
+#else
 #include <Windows.h>
+#endif
 
 namespace wl {
 
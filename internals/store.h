@@ -6,32 +6,48 @@
  */
 
 #pragma once
-#include <functional>
+#include <algorithm>
+#include <new>
+#include <type_traits>
 #include <vector>
+#include "delegate.h"
 #include "params.h"
 
 namespace wl {
 namespace _wli {
 
 // Generic storage for message identifiers and their respective lambda handlers.
+// Once frozen, which happens when the window starts processing messages, searches go through
+// a dispatch table: ids below WM_USER index a dense array, all others are found with a perfect hash.
 template<typename idT, typename retT>
 class store final {
 private:
 	struct _msg_unit final {
-		idT                         id;   // UINT, WORD or {UINT_PTR, UINT}
-		std::function<retT(params)> func; // retT is LRESULT or INT_PTR
+		idT      id{};        // UINT, WORD or {UINT_PTR, UINT}
+		unsigned funcIdx = 0; // in _funcs; ids added together share the same func
+	};
 
-		_msg_unit() = default;
-		_msg_unit(idT id, std::function<retT(params)> func) noexcept :
-			id(id), func(std::move(func)) { }
+	struct _slot final {
+		idT      id{};
+		unsigned funcIdx = 0; // zero is the empty func, so the slot is empty
 	};
 
-	std::vector<_msg_unit> _msgUnits;
+	static constexpr size_t DIRECT_LIMIT = 0x400; // WM_USER; all system messages are below it
+	static constexpr size_t MIN_TABLE_UNITS = 24; // below that, the reverse linear search is faster
+
+	std::vector<_msg_unit>              _msgUnits;
+	std::vector<delegate<retT(params)>> _funcs;    // retT is LRESULT or INT_PTR
+	std::vector<unsigned>               _direct;   // func index of each id below DIRECT_LIMIT, up to the greatest one with a handler
+	std::vector<unsigned>               _displace; // perfect hash: per bucket, the seed which puts all its ids in free slots
+	std::vector<_slot>                  _slots;
+	unsigned                            _bucketBits = 0, _slotBits = 0;
+	bool                                _frozen = false;
 
 public:
 	explicit store(size_t msgsReserve = 0) {
 		this->reserve(msgsReserve); // initial reserve is useful to save realloc time
 		this->_msgUnits.emplace_back(); // 1st element is sentinel room
+		this->_funcs.emplace_back(); // empty, pointed to by the sentinel
 	}
 
 	bool empty() const noexcept {
@@ -40,31 +56,169 @@ public:
 
 	void reserve(size_t msgsReserve) {
 		this->_msgUnits.reserve(msgsReserve + 1); // +1 because sentinel
+		this->_funcs.reserve(msgsReserve + 1);
+	}
+
+	void add(idT id, delegate<retT(params)> func) {
+		this->add({id}, std::move(func));
+	}
+
+	void add(std::initializer_list<idT> ids, delegate<retT(params)> func) {
+		if (this->_frozen) this->_drop_table(); // back to the linear search, until frozen again
+		this->_funcs.emplace_back(std::move(func)); // store user func once
+		unsigned funcIdx = static_cast<unsigned>(this->_funcs.size() - 1);
+		for (const idT& id : ids) {
+			this->_msgUnits.push_back({id, funcIdx}); // reverse search: messages can be overwritten by a later one
+		}
+	}
+
+	// Builds the dispatch table, keeping the later handler of a repeated id. A few handlers are
+	// faster to search linearly, and so is it if there's no memory for the table, or if the
+	// hashes of some ids are equal, so they can't be placed apart.
+	void freeze() noexcept {
+		if (this->_msgUnits.size() <= MIN_TABLE_UNITS) return;
+		try {
+			this->_frozen = this->_build_table();
+		} catch (const std::bad_alloc&) {
+			this->_frozen = false;
+		}
+		if (!this->_frozen) this->_drop_table();
+	}
+
+	delegate<retT(params)>* find(idT id) {
+		unsigned funcIdx = 0;
+		if (this->_frozen) {
+			funcIdx = this->_lookup(id);
+		} else {
+			this->_msgUnits[0].id = id; // sentinel for reverse linear search
+			const _msg_unit* revRunner = &this->_msgUnits.back(); // pointer to last element
+			while (revRunner->id != id) --revRunner;
+			funcIdx = revRunner->funcIdx; // if we stopped only at 1st element, id wasn't found
+		}
+		return funcIdx ? &this->_funcs[funcIdx] : nullptr;
+	}
+
+private:
+	static unsigned long long _mix(unsigned long long h) noexcept {
+		h ^= h >> 33; // MurmurHash3 finalizer
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ull;
+		return h ^ (h >> 33);
+	}
+
+	static unsigned long long _hash(const idT& id) noexcept {
+		if constexpr (std::is_integral_v<idT>) {
+			return _mix(static_cast<unsigned long long>(id));
+		} else { // notification {idFrom, code}
+			return _mix(static_cast<unsigned long long>(id.first) * 0x9E3779B97F4A7C15ull ^ id.second);
+		}
+	}
+
+	size_t _bucket_of(unsigned long long h) const noexcept {
+		return static_cast<size_t>(h >> 32) & ((size_t{1} << this->_bucketBits) - 1);
+	}
+
+	size_t _slot_of(unsigned long long h, unsigned seed) const noexcept {
+		unsigned long long step = (h >> 32) | 1; // odd, so each seed moves to a different slot
+		return static_cast<size_t>(h + seed * step) & ((size_t{1} << this->_slotBits) - 1);
+	}
+
+	unsigned _lookup(const idT& id) const noexcept {
+		if constexpr (std::is_integral_v<idT>) {
+			if (static_cast<size_t>(id) < DIRECT_LIMIT) {
+				return (static_cast<size_t>(id) < this->_direct.size()) ? this->_direct[id] : 0;
+			}
+		}
+		if (this->_slots.empty()) return 0;
+		unsigned long long h = _hash(id);
+		const _slot& slot = this->_slots[this->_slot_of(h, this->_displace[this->_bucket_of(h)])];
+		return (slot.funcIdx && slot.id == id) ? slot.funcIdx : 0;
 	}
 
-	void add(idT id, std::function<retT(params)> func) {
-		this->_msgUnits.emplace_back(id, std::move(func)); // reverse search: messages can be overwritten by a later one
+	void _drop_table() noexcept {
+		this->_direct.clear();
+		this->_displace.clear();
+		this->_slots.clear();
+		this->_bucketBits = this->_slotBits = 0;
+		this->_frozen = false;
 	}
 
-	void add(std::initializer_list<idT> ids, std::function<retT(params)> func) {
-		const idT* pIds = ids.begin();
-		this->add(pIds[0], std::move(func)); // store user func once
-		size_t funcIdx = this->_msgUnits.size() - 1;
-		for (size_t i = 1; i < ids.size(); ++i) {
-			if (pIds[i] != pIds[0]) { // avoid overwriting
-				this->add(pIds[i], [this, funcIdx](params p) -> retT {
-					return this->_msgUnits[funcIdx].func(p); // store light wrapper to 1st func
-				});
+	bool _build_table() {
+		this->_drop_table();
+		std::vector<std::pair<idT, unsigned>> hashed; // id and func index, for the perfect hash
+		for (size_t i = 1; i < this->_msgUnits.size(); ++i) {
+			const _msg_unit& unit = this->_msgUnits[i];
+			if constexpr (std::is_integral_v<idT>) {
+				if (static_cast<size_t>(unit.id) < DIRECT_LIMIT) {
+					if (static_cast<size_t>(unit.id) >= this->_direct.size()) this->_direct.resize(static_cast<size_t>(unit.id) + 1, 0);
+					this->_direct[unit.id] = unit.funcIdx; // a later handler overwrites
+					continue;
+				}
 			}
+			hashed.emplace_back(unit.id, unit.funcIdx);
+		}
+
+		std::stable_sort(hashed.begin(), hashed.end(), // keep only the later handler of each id
+			[](const std::pair<idT, unsigned>& a, const std::pair<idT, unsigned>& b) noexcept { return a.first < b.first; });
+		size_t numIds = 0;
+		for (size_t i = 0; i < hashed.size(); ++i) {
+			if (i + 1 < hashed.size() && hashed[i + 1].first == hashed[i].first) continue;
+			hashed[numIds++] = hashed[i];
+		}
+		hashed.resize(numIds);
+		if (hashed.empty()) return true;
+
+		std::vector<unsigned long long> hashes(hashed.size()); // ids with equal hashes never fit, however large the table
+		for (size_t i = 0; i < hashed.size(); ++i) hashes[i] = _hash(hashed[i].first);
+		std::sort(hashes.begin(), hashes.end());
+		if (std::adjacent_find(hashes.begin(), hashes.end()) != hashes.end()) return false;
+
+		// Hash and displace: ids are split in buckets of about 4, and the buckets, biggest
+		// first, look for a seed which puts all their ids in free slots of a table half full.
+		this->_slotBits = 1;
+		while ((size_t{1} << this->_slotBits) < hashed.size() * 2) ++this->_slotBits;
+		for (;; ++this->_slotBits) { // each failure doubles the table, which makes success very likely
+			if (this->_try_displace(hashed)) return true;
 		}
 	}
 
-	std::function<retT(params)>* find(idT id) {
-		this->_msgUnits[0].id = id; // sentinel for reverse linear search
-		_msg_unit* revRunner = &this->_msgUnits.back(); // pointer to last element
-		while (revRunner->id != id) --revRunner;
-		return revRunner == &this->_msgUnits[0] ? // if we stopped only at 1st element, id wasn't found
-			nullptr : &revRunner->func;
+	bool _try_displace(const std::vector<std::pair<idT, unsigned>>& hashed) {
+		const unsigned MAX_SEED = 4096;
+		this->_bucketBits = 0;
+		while ((size_t{1} << this->_bucketBits) * 4 < hashed.size()) ++this->_bucketBits;
+
+		std::vector<std::vector<size_t>> buckets(size_t{1} << this->_bucketBits);
+		for (size_t i = 0; i < hashed.size(); ++i) buckets[this->_bucket_of(_hash(hashed[i].first))].emplace_back(i);
+		std::vector<size_t> order(buckets.size());
+		for (size_t b = 0; b < order.size(); ++b) order[b] = b;
+		std::stable_sort(order.begin(), order.end(),
+			[&buckets](size_t a, size_t b) noexcept { return buckets[a].size() > buckets[b].size(); });
+
+		this->_displace.assign(buckets.size(), 0);
+		this->_slots.assign(size_t{1} << this->_slotBits, _slot{});
+		std::vector<size_t> placed;
+		for (size_t b : order) {
+			if (buckets[b].empty()) break;
+			bool fits = false;
+			for (unsigned seed = 0; seed < MAX_SEED && !fits; ++seed) {
+				placed.clear();
+				fits = true;
+				for (size_t i : buckets[b]) {
+					size_t s = this->_slot_of(_hash(hashed[i].first), seed);
+					if (this->_slots[s].funcIdx) { fits = false; break; }
+					this->_slots[s] = {hashed[i].first, hashed[i].second};
+					placed.emplace_back(s);
+				}
+				if (!fits) {
+					for (size_t s : placed) this->_slots[s] = _slot{}; // undo, try the next seed
+				} else {
+					this->_displace[b] = seed;
+				}
+			}
+			if (!fits) return false;
+		}
+		return true;
 	}
 };
 
@@ -0,0 +1,90 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include "str_case_tables.h"
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define WL_STR_CASE_SSE2
+#endif
+
+namespace wl {
+namespace _wli {
+namespace str_case {
+
+// Win32-free, table-driven case mapping of UTF-16 code units, so it can be used on any platform.
+// Chars outside the BMP, only possible with a 32-bit wchar_t, are never changed.
+// ASCII letters are never the result of folding a non-ASCII char.
+
+inline wchar_t map_table(const unsigned char* index, const short* deltas, wchar_t ch) noexcept {
+	if (static_cast<unsigned>(ch) > 0xFFFF) return ch;
+	unsigned block = index[ch / BLOCK_SIZE];
+	return static_cast<wchar_t>(static_cast<unsigned short>(ch + deltas[block * BLOCK_SIZE + ch % BLOCK_SIZE]));
+}
+
+inline wchar_t to_upper(wchar_t ch) noexcept {
+	if (ch < 0x80) return (ch >= L'a' && ch <= L'z') ? ch - 0x20 : ch; // ASCII, by far the most common case
+	return map_table(upper_index(), upper_deltas(), ch);
+}
+
+inline wchar_t to_lower(wchar_t ch) noexcept {
+	if (ch < 0x80) return (ch >= L'A' && ch <= L'Z') ? ch + 0x20 : ch;
+	return map_table(lower_index(), lower_deltas(), ch);
+}
+
+// Simple case folding, which is mostly towards lowercase.
+inline wchar_t fold(wchar_t ch) noexcept {
+	if (ch < 0x80) return (ch >= L'A' && ch <= L'Z') ? ch + 0x20 : ch;
+	return map_table(fold_index(), fold_deltas(), ch);
+}
+
+// Letter without its diacritics, like u for both u-acute and u-diaeresis-macron.
+inline wchar_t strip_diacritic(wchar_t ch) noexcept {
+	if (ch < 0x80) return ch;
+	return map_table(strip_index(), strip_deltas(), ch);
+}
+
+enum class mapping { UPPER, LOWER, FOLD, STRIP };
+
+template<mapping M>
+inline wchar_t map_char(wchar_t ch) noexcept {
+	if constexpr (M == mapping::UPPER) return to_upper(ch);
+	else if constexpr (M == mapping::LOWER) return to_lower(ch);
+	else if constexpr (M == mapping::FOLD) return fold(ch);
+	else return strip_diacritic(ch);
+}
+
+// Maps len chars from src into dest, which can be the same as src; blocks of ASCII chars are mapped 8 at a time.
+template<mapping M>
+inline void map_chars(const wchar_t* src, size_t len, wchar_t* dest) noexcept {
+	size_t i = 0;
+#ifdef WL_STR_CASE_SSE2
+	if (sizeof(wchar_t) == 2) {
+		const __m128i nonAsciiBits = _mm_set1_epi16(static_cast<short>(0xFF80));
+		const __m128i below = _mm_set1_epi16(M == mapping::UPPER ? L'a' - 1 : L'A' - 1); // letters to be changed
+		const __m128i above = _mm_set1_epi16(M == mapping::UPPER ? L'z' + 1 : L'Z' + 1);
+		for (; i + 8 <= len; i += 8) {
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, nonAsciiBits), _mm_setzero_si128())) != 0xFFFF) {
+				for (size_t j = i; j < i + 8; ++j) dest[j] = map_char<M>(src[j]); // some non-ASCII char
+				continue;
+			}
+			if constexpr (M != mapping::STRIP) {
+				__m128i isLetter = _mm_and_si128(_mm_cmpgt_epi16(block, below), _mm_cmplt_epi16(block, above));
+				__m128i delta = _mm_and_si128(isLetter, _mm_set1_epi16(0x20));
+				block = (M == mapping::UPPER) ? _mm_sub_epi16(block, delta) : _mm_add_epi16(block, delta);
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), block);
+		}
+	}
+#endif
+	for (; i < len; ++i) dest[i] = map_char<M>(src[i]);
+}
+
+}//namespace str_case
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,401 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "str_num.h"
+
+namespace wl {
+namespace _wli {
+
+// Single-pass, type-safe printf-style formatting.
+// Arguments carry their own types, so a specifier which would read garbage, like %f with an
+// integer or %s with a number, throws; integer specifiers also take enums, handles and pointers,
+// as printf does. Integers, strings and %f are converted without the CRT.
+namespace str_format {
+
+// Type-erased formatting argument, stored on the stack.
+struct arg final {
+	enum class type : unsigned char { SIGNED, UNSIGNED, FLOAT, CHAR, STRING, POINTER };
+
+	type          t;
+	unsigned char size; // bytes of the original integral type, for printf-like reinterpretation
+	union {
+		long long          i;
+		unsigned long long u;
+		double             d;
+		const void*        p;
+		struct { const wchar_t* ptr; size_t len; } s;
+	};
+};
+
+template<typename T>
+inline arg make_arg(const T& val) noexcept {
+	static_assert(!std::is_same<T, const char*>::value && !std::is_same<T, char*>::value,
+		"Non-wide char* being used on str::format(), str::to_wstring() can fix it.");
+	static_assert(!std::is_same<T, std::string>::value,
+		"Non-wide std::string being used on str::format(), str::to_wstring() can fix it.");
+
+	arg a{};
+	if constexpr (std::is_same<T, wchar_t>::value) {
+		a.t = arg::type::CHAR;
+		a.u = static_cast<unsigned long long>(val);
+	} else if constexpr (std::is_same<T, bool>::value) {
+		a.t = arg::type::UNSIGNED;
+		a.u = val ? 1 : 0;
+	} else if constexpr (std::is_enum<T>::value) {
+		return make_arg(static_cast<typename std::underlying_type<T>::type>(val));
+	} else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+		a.t = arg::type::SIGNED;
+		a.i = static_cast<long long>(val);
+	} else if constexpr (std::is_integral<T>::value) {
+		a.t = arg::type::UNSIGNED;
+		a.u = static_cast<unsigned long long>(val);
+	} else if constexpr (std::is_floating_point<T>::value) {
+		a.t = arg::type::FLOAT;
+		a.d = static_cast<double>(val);
+	} else if constexpr (std::is_same<T, const wchar_t*>::value || std::is_same<T, wchar_t*>::value) {
+		a.t = arg::type::STRING;
+		a.s.ptr = val ? val : L"(null)";
+		a.s.len = std::char_traits<wchar_t>::length(a.s.ptr);
+	} else if constexpr (std::is_same<T, std::wstring>::value || std::is_same<T, std::wstring_view>::value) {
+		a.t = arg::type::STRING;
+		a.s.ptr = val.data();
+		a.s.len = val.length();
+	} else if constexpr (std::is_pointer<T>::value || std::is_null_pointer<T>::value) {
+		a.t = arg::type::POINTER;
+		a.p = val;
+	} else {
+		static_assert(std::is_pointer<T>::value, "Type not supported by str::format().");
+	}
+	a.size = static_cast<unsigned char>(sizeof(T));
+	return a;
+}
+
+template<size_t N>
+inline arg make_arg(const wchar_t (&val)[N]) noexcept {
+	return make_arg(static_cast<const wchar_t*>(val)); // string literals
+}
+
+// Number of arguments a format string consumes, usable in static_assert.
+constexpr size_t count_args(const wchar_t* fmt) noexcept {
+	size_t count = 0;
+	while (*fmt) {
+		if (*fmt++ != L'%') continue;
+		if (*fmt == L'%') { ++fmt; continue; } // escaped
+		while (*fmt && *fmt != L'd' && *fmt != L'i' && *fmt != L'u' && *fmt != L'x' && *fmt != L'X'
+			&& *fmt != L'o' && *fmt != L'c' && *fmt != L'C' && *fmt != L's' && *fmt != L'S' && *fmt != L'p'
+			&& *fmt != L'f' && *fmt != L'F' && *fmt != L'e' && *fmt != L'E' && *fmt != L'g' && *fmt != L'G'
+			&& *fmt != L'a' && *fmt != L'A')
+		{
+			if (*fmt == L'*') ++count; // width or precision taken from an argument
+			++fmt;
+		}
+		if (*fmt) { ++count; ++fmt; }
+	}
+	return count;
+}
+
+// Appends to an existing std::wstring.
+class wstring_sink final {
+private:
+	std::wstring& _dest;
+public:
+	explicit wstring_sink(std::wstring& dest) noexcept : _dest{dest} { }
+	void append(const wchar_t* s, size_t n) { this->_dest.append(s, n); }
+	void fill(wchar_t ch, size_t n)         { this->_dest.append(n, ch); }
+};
+
+// Writes into a fixed buffer, truncating; counts the full length anyway.
+class buffer_sink final {
+private:
+	wchar_t* _buf;
+	size_t   _cap, _len = 0; // cap excludes the terminating null
+public:
+	buffer_sink(wchar_t* buf, size_t bufLen) noexcept : _buf{buf}, _cap{bufLen ? bufLen - 1 : 0} { }
+	size_t length() const noexcept { return this->_len; }
+	void   terminate() noexcept    { this->_buf[this->_len < this->_cap ? this->_len : this->_cap] = L'\0'; }
+
+	void append(const wchar_t* s, size_t n) noexcept {
+		if (this->_len < this->_cap) {
+			size_t room = this->_cap - this->_len;
+			memcpy(this->_buf + this->_len, s, (n < room ? n : room) * sizeof(wchar_t));
+		}
+		this->_len += n;
+	}
+	void fill(wchar_t ch, size_t n) noexcept {
+		for (size_t i = this->_len; i < this->_len + n && i < this->_cap; ++i) this->_buf[i] = ch;
+		this->_len += n;
+	}
+};
+
+struct spec final {
+	bool    left = false, plus = false, space = false, alt = false, zero = false;
+	int     width = 0, precision = -1;
+	wchar_t conv = L'\0';
+};
+
+template<typename sinkT>
+inline void put_padded(sinkT& sink, const spec& sp, const wchar_t* prefix, size_t prefixLen,
+	size_t numZeros, const wchar_t* body, size_t bodyLen)
+{
+	size_t total = prefixLen + numZeros + bodyLen;
+	size_t pad = (sp.width > 0 && static_cast<size_t>(sp.width) > total) ? sp.width - total : 0;
+	if (!sp.left && !sp.zero) sink.fill(L' ', pad);
+	sink.append(prefix, prefixLen);
+	if (!sp.left && sp.zero) sink.fill(L'0', pad); // zeros go between sign and digits
+	sink.fill(L'0', numZeros);
+	sink.append(body, bodyLen);
+	if (sp.left) sink.fill(L' ', pad);
+}
+
+template<typename sinkT>
+inline void put_integer(sinkT& sink, spec sp, const arg& a) {
+	if (a.t == arg::type::POINTER) { // handles and pointers, which printf takes as integers of their size
+		arg asInt = a;
+		asInt.t = arg::type::UNSIGNED;
+		asInt.u = reinterpret_cast<std::uintptr_t>(a.p);
+		return put_integer(sink, sp, asInt);
+	} else if (a.t != arg::type::SIGNED && a.t != arg::type::UNSIGNED && a.t != arg::type::CHAR) {
+		throw std::invalid_argument("str::format(): integer specifier used with a non-integer argument.");
+	}
+	unsigned long long mask = (a.size >= 8) ? ~0ull : ((1ull << (a.size * 8)) - 1);
+	unsigned long long mag = a.u & mask; // as unsigned of the original width, like printf
+	bool neg = false;
+
+	if ((sp.conv == L'd' || sp.conv == L'i') && a.t != arg::type::CHAR) {
+		long long v = a.i;
+		if (a.t == arg::type::UNSIGNED && a.size < 8 && (mag >> (a.size * 8 - 1))) {
+			v = static_cast<long long>(mag | ~mask); // high bit set: printf would read it as negative
+		} else if (a.t == arg::type::UNSIGNED) {
+			v = static_cast<long long>(a.u);
+		}
+		neg = v < 0;
+		mag = neg ? 0ull - static_cast<unsigned long long>(v) : static_cast<unsigned long long>(v);
+	}
+
+	wchar_t buf[str_num::MAX_INT_CHARS];
+	wchar_t* pEnd = buf + str_num::MAX_INT_CHARS;
+	wchar_t* pFirst = pEnd;
+	if (mag || sp.precision != 0) { // printf prints nothing for zero with zero precision
+		pFirst = (sp.conv == L'x' || sp.conv == L'X') ? str_num::write_hex_backwards(mag, pEnd, sp.conv == L'X')
+			: (sp.conv == L'o') ? str_num::write_oct_backwards(mag, pEnd)
+			: str_num::write_dec_backwards(mag, pEnd);
+	}
+	size_t numDigits = pEnd - pFirst;
+
+	wchar_t prefix[2];
+	size_t prefixLen = 0;
+	if (neg) prefix[prefixLen++] = L'-';
+	else if ((sp.conv == L'd' || sp.conv == L'i') && sp.plus) prefix[prefixLen++] = L'+';
+	else if ((sp.conv == L'd' || sp.conv == L'i') && sp.space) prefix[prefixLen++] = L' ';
+	else if (sp.alt && mag && (sp.conv == L'x' || sp.conv == L'X')) {
+		prefix[prefixLen++] = L'0';
+		prefix[prefixLen++] = sp.conv;
+	}
+
+	size_t numZeros = (sp.precision > 0 && static_cast<size_t>(sp.precision) > numDigits) ?
+		sp.precision - numDigits : 0;
+	if (sp.alt && sp.conv == L'o' && !numZeros && (!numDigits || *pFirst != L'0')) numZeros = 1;
+	if (sp.precision >= 0) sp.zero = false; // printf ignores 0 flag when precision is given
+	put_padded(sink, sp, prefix, prefixLen, numZeros, pFirst, numDigits);
+}
+
+template<typename sinkT>
+inline void put_float(sinkT& sink, const spec& sp, const arg& a) {
+	if (a.t != arg::type::FLOAT) {
+		throw std::invalid_argument("str::format(): floating-point specifier used with a non-float argument.");
+	}
+	int precision = sp.precision < 0 ? 6 : sp.precision;
+	unsigned long long bits = 0;
+	memcpy(&bits, &a.d, sizeof(bits));
+	bool isFinite = (bits & 0x7FF0000000000000ull) != 0x7FF0000000000000ull;
+
+	if ((sp.conv == L'f' || sp.conv == L'F') && isFinite) { // exact fixed notation without the CRT
+		wchar_t prefix[1];
+		size_t prefixLen = 0;
+		if (bits >> 63) prefix[prefixLen++] = L'-';
+		else if (sp.plus) prefix[prefixLen++] = L'+';
+		else if (sp.space) prefix[prefixLen++] = L' ';
+		double mag = a.d;
+		bits &= ~(1ull << 63);
+		memcpy(&mag, &bits, sizeof(bits));
+
+		wchar_t buf[128];
+		buffer_sink body{buf, 128};
+		str_num::put_fixed(body, mag, precision, {}, L'.');
+		if (sp.alt && !precision) body.append(L".", 1); // # keeps the point
+		if (body.length() < 128) {
+			put_padded(sink, sp, prefix, prefixLen, 0, buf, body.length());
+		} else { // huge values or precisions
+			std::wstring big;
+			wstring_sink bigSink{big};
+			str_num::put_fixed(bigSink, mag, precision, {}, L'.');
+			if (sp.alt && !precision) big.append(1, L'.');
+			put_padded(sink, sp, prefix, prefixLen, 0, big.c_str(), big.length());
+		}
+		return;
+	}
+
+	// %e, %g, %a and non-finite values are delegated to the CRT, in one call, into a stack buffer.
+	wchar_t fmt[32];
+	size_t n = 0;
+	fmt[n++] = L'%';
+	if (sp.left)  fmt[n++] = L'-';
+	if (sp.plus)  fmt[n++] = L'+';
+	if (sp.space) fmt[n++] = L' ';
+	if (sp.alt)   fmt[n++] = L'#';
+	if (sp.zero)  fmt[n++] = L'0';
+	fmt[n++] = L'*';
+	fmt[n++] = L'.';
+	fmt[n++] = L'*';
+	fmt[n++] = sp.conv;
+	fmt[n] = L'\0';
+
+	wchar_t buf[128];
+	int len = swprintf(buf, 128, fmt, sp.width, precision, a.d);
+	if (len >= 0 && len < 128) {
+		sink.append(buf, len);
+	} else { // huge %f values or widths
+		std::wstring big(static_cast<size_t>(sp.width) + precision + 330, L'\0');
+		len = swprintf(&big[0], big.length(), fmt, sp.width, precision, a.d);
+		sink.append(big.c_str(), len < 0 ? 0 : len);
+	}
+}
+
+template<typename sinkT>
+inline void put_string(sinkT& sink, const spec& sp, const arg& a) {
+	if (a.t == arg::type::CHAR || ((a.t == arg::type::SIGNED || a.t == arg::type::UNSIGNED) && sp.conv != L's' && sp.conv != L'S')) {
+		wchar_t ch = static_cast<wchar_t>(a.u);
+		put_padded(sink, spec{sp.left, false, false, false, false, sp.width}, nullptr, 0, 0, &ch, 1);
+		return;
+	} else if (a.t != arg::type::STRING) {
+		throw std::invalid_argument("str::format(): string specifier used with a non-string argument.");
+	}
+	size_t len = (sp.precision >= 0 && static_cast<size_t>(sp.precision) < a.s.len) ? sp.precision : a.s.len;
+	put_padded(sink, spec{sp.left, false, false, false, false, sp.width}, nullptr, 0, 0, a.s.ptr, len);
+}
+
+template<typename sinkT>
+inline void put_pointer(sinkT& sink, const spec& sp, const arg& a) {
+	if (a.t == arg::type::FLOAT) {
+		throw std::invalid_argument("str::format(): pointer specifier used with a non-pointer argument.");
+	}
+	wchar_t buf[str_num::MAX_INT_CHARS];
+	wchar_t* pEnd = buf + str_num::MAX_INT_CHARS;
+	unsigned long long addr = (a.t == arg::type::POINTER) ? reinterpret_cast<std::uintptr_t>(a.p)
+		: (a.t == arg::type::STRING) ? reinterpret_cast<std::uintptr_t>(a.s.ptr) // address of the text
+		: a.u;
+	wchar_t* pFirst = str_num::write_hex_backwards(addr, pEnd, true);
+	size_t numDigits = pEnd - pFirst;
+	size_t numZeros = sizeof(void*) * 2 > numDigits ? sizeof(void*) * 2 - numDigits : 0; // like Visual C++
+	put_padded(sink, spec{sp.left, false, false, false, false, sp.width}, nullptr, 0, numZeros, pFirst, numDigits);
+}
+
+inline int int_arg(const arg* args, size_t numArgs, size_t& argIdx) {
+	if (argIdx >= numArgs) {
+		throw std::invalid_argument("str::format(): too few arguments for the format string.");
+	}
+	const arg& a = args[argIdx++];
+	if (a.t != arg::type::SIGNED && a.t != arg::type::UNSIGNED) {
+		throw std::invalid_argument("str::format(): '*' width or precision requires an integer argument.");
+	}
+	return static_cast<int>(a.i);
+}
+
+// Parses the format string once, writing literal runs and arguments straight into the sink.
+template<typename sinkT>
+inline void format_to_sink(sinkT& sink, const wchar_t* fmt, size_t fmtLen, const arg* args, size_t numArgs) {
+	const wchar_t* pRun = fmt;
+	const wchar_t* pEnd = fmt + fmtLen;
+	size_t argIdx = 0;
+
+	while (pRun < pEnd) {
+		const wchar_t* pPct = std::char_traits<wchar_t>::find(pRun, pEnd - pRun, L'%');
+		if (!pPct) {
+			sink.append(pRun, pEnd - pRun);
+			break;
+		}
+		sink.append(pRun, pPct - pRun); // literal text before the specifier
+		pRun = pPct + 1;
+		if (pRun < pEnd && *pRun == L'%') {
+			sink.append(L"%", 1);
+			++pRun;
+			continue;
+		}
+
+		spec sp;
+		for (; pRun < pEnd; ++pRun) { // flags
+			if (*pRun == L'-') sp.left = true;
+			else if (*pRun == L'+') sp.plus = true;
+			else if (*pRun == L' ') sp.space = true;
+			else if (*pRun == L'#') sp.alt = true;
+			else if (*pRun == L'0') sp.zero = true;
+			else break;
+		}
+		if (pRun < pEnd && *pRun == L'*') {
+			sp.width = int_arg(args, numArgs, argIdx);
+			if (sp.width < 0) { sp.left = true; sp.width = -sp.width; }
+			++pRun;
+		} else {
+			while (pRun < pEnd && *pRun >= L'0' && *pRun <= L'9') sp.width = sp.width * 10 + (*pRun++ - L'0');
+		}
+		if (pRun < pEnd && *pRun == L'.') {
+			++pRun;
+			sp.precision = 0;
+			if (pRun < pEnd && *pRun == L'*') {
+				sp.precision = int_arg(args, numArgs, argIdx);
+				if (sp.precision < 0) sp.precision = -1; // as if omitted
+				++pRun;
+			} else {
+				while (pRun < pEnd && *pRun >= L'0' && *pRun <= L'9') sp.precision = sp.precision * 10 + (*pRun++ - L'0');
+			}
+		}
+		while (pRun < pEnd && (*pRun == L'h' || *pRun == L'l' || *pRun == L'L' || *pRun == L'j' || *pRun == L'z'
+			|| *pRun == L't' || *pRun == L'w' || *pRun == L'I' || *pRun == L'3' || *pRun == L'2'
+			|| *pRun == L'6' || *pRun == L'4')) ++pRun; // length modifiers: argument types are already known
+		if (pRun == pEnd) {
+			throw std::invalid_argument("str::format(): incomplete format specifier.");
+		}
+
+		sp.conv = *pRun++;
+		if (sp.left) sp.zero = false;
+		if (argIdx >= numArgs) {
+			throw std::invalid_argument("str::format(): too few arguments for the format string.");
+		}
+		const arg& a = args[argIdx++];
+
+		switch (sp.conv) {
+		case L'd': case L'i': case L'u': case L'x': case L'X': case L'o':
+			put_integer(sink, sp, a); break;
+		case L'f': case L'F': case L'e': case L'E': case L'g': case L'G': case L'a': case L'A':
+			put_float(sink, sp, a); break;
+		case L'c': case L'C': case L's': case L'S':
+			put_string(sink, sp, a); break;
+		case L'p':
+			put_pointer(sink, sp, a); break;
+		default:
+			throw std::invalid_argument("str::format(): unsupported format specifier.");
+		}
+	}
+}
+
+template<typename sinkT, typename ...argsT>
+inline void format(sinkT& sink, const wchar_t* fmt, size_t fmtLen, const argsT&... args) {
+	arg packed[sizeof...(args) ? sizeof...(args) : 1] = {make_arg(args)...}; // no heap involved
+	format_to_sink(sink, fmt, fmtLen, packed, sizeof...(args));
+}
+
+}//namespace str_format
+}//namespace _wli
+}//namespace wl
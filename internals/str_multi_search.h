@@ -0,0 +1,204 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <map>
+#include <string_view>
+#include <vector>
+#include "str_case.h"
+#include "str_search.h"
+
+namespace wl {
+namespace _wli {
+
+// Aho-Corasick automaton which finds many needles in a single pass over the haystack.
+// Matches are leftmost-longest and non-overlapping: among matches starting at the same
+// position the longest one wins, and scanning resumes right after it.
+class str_multi_search final {
+private:
+	struct edge final {
+		wchar_t  ch;
+		unsigned next;
+	};
+	struct node final {
+		unsigned firstEdge = 0, numEdges = 0; // sorted by char, in _edges
+		unsigned fail = 0;    // longest proper suffix which is also a trie node
+		unsigned depth = 0;
+		int      output = -1; // longest needle which ends here, directly or through suffixes
+	};
+
+	std::vector<node>         _nodes; // breadth-first order, root is 0
+	std::vector<edge>         _edges;
+	std::vector<size_t>       _needleLens;
+	std::array<unsigned, 128> _rootAscii{}; // root transitions for ASCII chars, 0 if none
+	std::array<wchar_t, 2>    _firstChars{}; // raw chars which can start a match, for the prefilter
+	bool                      _ignoreCase = false, _canPrefilter = false;
+
+public:
+	static const unsigned NONE = static_cast<unsigned>(-1);
+
+	str_multi_search() = default;
+
+	// Needles are indexed in the given order; empty needles never match, and among
+	// repeated needles the last one wins.
+	str_multi_search(const std::vector<std::wstring_view>& needles, bool ignoreCase) :
+		_ignoreCase{ignoreCase}
+	{
+		std::vector<std::map<wchar_t, unsigned>> trie(1);
+		std::vector<int> terminal(1, -1);
+		for (size_t i = 0; i < needles.size(); ++i) {
+			this->_needleLens.emplace_back(needles[i].length());
+			if (needles[i].empty()) continue;
+			unsigned cur = 0;
+			for (wchar_t ch : needles[i]) {
+				if (ignoreCase) ch = str_case::fold(ch);
+				auto found = trie[cur].find(ch);
+				if (found == trie[cur].end()) {
+					trie[cur][ch] = static_cast<unsigned>(trie.size());
+					cur = static_cast<unsigned>(trie.size());
+					trie.emplace_back();
+					terminal.emplace_back(-1);
+				} else {
+					cur = found->second;
+				}
+			}
+			terminal[cur] = static_cast<int>(i);
+		}
+		this->_build(trie, terminal);
+	}
+
+	bool empty() const noexcept { return this->_nodes.size() <= 1; }
+
+	// Calls onMatch(pos, len, needleIndex) for each match, in order.
+	template<typename funcT>
+	void for_each_match(const wchar_t* hay, size_t hayLen, funcT&& onMatch) const {
+		if (this->empty()) return;
+		size_t pendingStart = std::wstring_view::npos, pendingEnd = 0;
+		int pendingNeedle = -1;
+		unsigned state = 0;
+
+		for (size_t i = 0; ; ++i) {
+			if (i == hayLen) {
+				if (pendingNeedle < 0) break;
+				onMatch(pendingStart, pendingEnd - pendingStart, static_cast<unsigned>(pendingNeedle));
+				i = pendingEnd - 1; // the chars after the match must be scanned again
+				state = 0;
+				pendingNeedle = -1;
+				continue;
+			}
+			if (!state && this->_canPrefilter) { // at root no match is pending
+				i = str_find_either(hay, i, hayLen, this->_firstChars[0], this->_firstChars[1]);
+				if (i == std::wstring_view::npos) break;
+			}
+			state = this->_next(state, this->_ignoreCase ? str_case::fold(hay[i]) : hay[i]);
+
+			int out = this->_nodes[state].output;
+			if (out >= 0) { // longest needle ending here, so the earliest start
+				size_t start = i + 1 - this->_needleLens[out];
+				if (pendingNeedle < 0 || start < pendingStart || (start == pendingStart && i + 1 > pendingEnd)) {
+					pendingStart = start;
+					pendingEnd = i + 1;
+					pendingNeedle = out;
+				}
+			}
+			if (pendingNeedle >= 0 && i + 1 - this->_nodes[state].depth > pendingStart) { // no match can start earlier anymore
+				onMatch(pendingStart, pendingEnd - pendingStart, static_cast<unsigned>(pendingNeedle));
+				i = pendingEnd - 1; // resume right after the match, which may mean scanning a few chars again
+				state = 0;
+				pendingNeedle = -1;
+			}
+		}
+	}
+
+private:
+	void _build(const std::vector<std::map<wchar_t, unsigned>>& trie, const std::vector<int>& terminal) {
+		// Renumber in breadth-first order, so each node's edges are contiguous and fail links point backwards.
+		std::vector<unsigned> order{0}, newId(trie.size(), 0);
+		for (size_t i = 0; i < order.size(); ++i) {
+			for (const auto& kv : trie[order[i]]) {
+				newId[kv.second] = static_cast<unsigned>(order.size());
+				order.emplace_back(kv.second);
+			}
+		}
+		this->_nodes.resize(order.size());
+		for (size_t i = 0; i < order.size(); ++i) {
+			node& n = this->_nodes[i];
+			n.firstEdge = static_cast<unsigned>(this->_edges.size());
+			n.numEdges = static_cast<unsigned>(trie[order[i]].size());
+			n.output = terminal[order[i]];
+			for (const auto& kv : trie[order[i]]) { // std::map keeps them sorted
+				this->_edges.push_back({kv.first, newId[kv.second]});
+				this->_nodes[newId[kv.second]].depth = n.depth + 1;
+			}
+		}
+
+		for (unsigned e = 0; e < this->_nodes[0].numEdges; ++e) { // needed by _child() below
+			wchar_t ch = this->_edges[e].ch;
+			if (ch >= 0 && ch < 0x80) this->_rootAscii[ch] = this->_edges[e].next;
+		}
+
+		for (size_t i = 0; i < this->_nodes.size(); ++i) { // parents are processed before children
+			const node& parent = this->_nodes[i];
+			for (unsigned e = parent.firstEdge; e < parent.firstEdge + parent.numEdges; ++e) {
+				node& child = this->_nodes[this->_edges[e].next];
+				if (i) {
+					unsigned f = parent.fail;
+					unsigned next;
+					while ((next = this->_child(f, this->_edges[e].ch)) == NONE && f) f = this->_nodes[f].fail;
+					child.fail = (next == NONE) ? 0 : next;
+				}
+				if (child.output < 0) child.output = this->_nodes[child.fail].output;
+			}
+		}
+
+		std::vector<wchar_t> firsts; // raw forms of the first chars
+		for (unsigned e = 0; e < this->_nodes[0].numEdges; ++e) {
+			wchar_t ch = this->_edges[e].ch;
+			if (this->_ignoreCase && ch >= 0x80) return; // unknown raw forms, no prefilter
+			firsts.emplace_back(ch);
+			if (this->_ignoreCase && ch >= L'a' && ch <= L'z') firsts.emplace_back(ch - 0x20);
+		}
+		if (!firsts.empty() && firsts.size() <= 2) {
+			this->_firstChars = {firsts.front(), firsts.back()};
+			this->_canPrefilter = true;
+		}
+	}
+
+	unsigned _child(unsigned state, wchar_t ch) const noexcept {
+		if (!state && ch >= 0 && ch < 0x80) {
+			unsigned next = this->_rootAscii[ch];
+			return next ? next : NONE;
+		}
+		const node& n = this->_nodes[state];
+		if (!n.numEdges) return NONE;
+		const edge* pFirst = &this->_edges[0] + n.firstEdge;
+		const edge* pEnd = pFirst + n.numEdges;
+		if (n.numEdges <= 8) {
+			for (const edge* p = pFirst; p != pEnd; ++p) {
+				if (p->ch == ch) return p->next;
+			}
+			return NONE;
+		}
+		const edge* p = std::lower_bound(pFirst, pEnd, ch,
+			[](const edge& e, wchar_t c) noexcept { return e.ch < c; });
+		return (p != pEnd && p->ch == ch) ? p->next : NONE;
+	}
+
+	unsigned _next(unsigned state, wchar_t ch) const noexcept {
+		for (;;) {
+			unsigned next = this->_child(state, ch);
+			if (next != NONE) return next;
+			if (!state) return 0;
+			state = this->_nodes[state].fail;
+		}
+	}
+};
+
+}//namespace _wli
+}//namespace wl
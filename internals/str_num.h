@@ -0,0 +1,511 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstring>
+#include <type_traits>
+#include "str_num_pow5.h"
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace wl {
+namespace _wli {
+
+// Win32-free and CRT-free number to text conversions, into caller buffers or sinks.
+namespace str_num {
+
+// Enough room for any 64-bit integer, in any base, plus sign.
+const size_t MAX_INT_CHARS = 66;
+
+inline const char* digit_pairs() noexcept {
+	static const char pairs[] =
+		"00010203040506070809" "10111213141516171819" "20212223242526272829"
+		"30313233343536373839" "40414243444546474849" "50515253545556575859"
+		"60616263646566676869" "70717273747576777879" "80818283848586878889"
+		"90919293949596979899";
+	return pairs;
+}
+
+// Writes the decimal digits of value ending right before pEnd; returns pointer to the first digit.
+inline wchar_t* write_dec_backwards(unsigned long long value, wchar_t* pEnd) noexcept {
+	const char* pairs = digit_pairs();
+	while (value >= 100) { // two digits per division
+		unsigned idx = static_cast<unsigned>(value % 100) * 2;
+		value /= 100;
+		*--pEnd = pairs[idx + 1];
+		*--pEnd = pairs[idx];
+	}
+	if (value >= 10) {
+		unsigned idx = static_cast<unsigned>(value) * 2;
+		*--pEnd = pairs[idx + 1];
+		*--pEnd = pairs[idx];
+	} else {
+		*--pEnd = static_cast<wchar_t>(L'0' + value);
+	}
+	return pEnd;
+}
+
+// Writes the hexadecimal digits of value ending right before pEnd; returns pointer to the first digit.
+inline wchar_t* write_hex_backwards(unsigned long long value, wchar_t* pEnd, bool upperCase) noexcept {
+	const char* digits = upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+	do {
+		*--pEnd = digits[value & 0xF];
+		value >>= 4;
+	} while (value);
+	return pEnd;
+}
+
+// Writes the octal digits of value ending right before pEnd; returns pointer to the first digit.
+inline wchar_t* write_oct_backwards(unsigned long long value, wchar_t* pEnd) noexcept {
+	do {
+		*--pEnd = static_cast<wchar_t>(L'0' + (value & 7));
+		value >>= 3;
+	} while (value);
+	return pEnd;
+}
+
+// Digit grouping, like 1,234,567 or the Indian 12,34,567.
+struct grouping final {
+	wchar_t       separator = L'\0'; // no grouping if null
+	unsigned char first = 3;         // digits in the rightmost group
+	unsigned char next = 3;          // digits in each further group; zero groups only the rightmost
+};
+
+// Appends the digits, inserting a separator at each group boundary.
+template<typename sinkT>
+inline void put_grouped(sinkT& sink, const wchar_t* digits, size_t numDigits, const grouping& grp) {
+	if (!grp.separator || !grp.first || numDigits <= grp.first) {
+		sink.append(digits, numDigits);
+		return;
+	}
+	size_t lead = numDigits - grp.first; // digits left of the rightmost group
+	size_t headLen = lead; // leftmost run, before the first separator
+	if (grp.next) {
+		headLen = lead % grp.next;
+		if (!headLen) headLen = grp.next;
+	}
+	sink.append(digits, headLen);
+	for (size_t pos = headLen; pos < numDigits; ) {
+		size_t runLen = (pos < lead) ? grp.next : grp.first;
+		sink.append(&grp.separator, 1);
+		sink.append(digits + pos, runLen);
+		pos += runLen;
+	}
+}
+
+// Appends the decimal digits of an integer, with optional sign and grouping.
+template<typename sinkT>
+inline void put_integer(sinkT& sink, unsigned long long mag, bool negative, const grouping& grp) {
+	wchar_t buf[MAX_INT_CHARS];
+	wchar_t* pEnd = buf + MAX_INT_CHARS;
+	wchar_t* pFirst = write_dec_backwards(mag, pEnd);
+	if (negative) sink.append(L"-", 1);
+	put_grouped(sink, pFirst, pEnd - pFirst, grp);
+}
+
+// Unsigned 64x64 to 128-bit multiplication; returns the low half.
+inline unsigned long long umul128(unsigned long long a, unsigned long long b, unsigned long long* pHigh) noexcept {
+#if defined(_MSC_VER) && defined(_M_X64)
+	return _umul128(a, b, pHigh);
+#elif defined(__SIZEOF_INT128__)
+	unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+	*pHigh = static_cast<unsigned long long>(r >> 64);
+	return static_cast<unsigned long long>(r);
+#else
+	unsigned long long aLo = a & 0xFFFFFFFF, aHi = a >> 32, bLo = b & 0xFFFFFFFF, bHi = b >> 32;
+	unsigned long long lolo = aLo * bLo, lohi = aLo * bHi, hilo = aHi * bLo, hihi = aHi * bHi;
+	unsigned long long mid = (lolo >> 32) + (lohi & 0xFFFFFFFF) + (hilo & 0xFFFFFFFF);
+	*pHigh = hihi + (lohi >> 32) + (hilo >> 32) + (mid >> 32);
+	return (mid << 32) | (lolo & 0xFFFFFFFF);
+#endif
+}
+
+// Decimal significand and exponent of a double: value = digits * 10^exponent.
+struct decimal_fp final {
+	unsigned long long digits;
+	int                exponent;
+};
+
+// Ryu: shortest decimal which reads back to the same positive, finite, non-zero double.
+// Ulf Adams, "Ryu: fast float-to-string conversion", PLDI 2018.
+class shortest final {
+private:
+	static const int MANTISSA_BITS = 52;
+	static const int EXPONENT_BIAS = 1023;
+
+	static int pow5bits(int e) noexcept   { return static_cast<int>((static_cast<unsigned>(e) * 1217359) >> 19) + 1; }
+	static int log10_pow2(int e) noexcept { return static_cast<int>((static_cast<unsigned>(e) * 78913) >> 18); }
+	static int log10_pow5(int e) noexcept { return static_cast<int>((static_cast<unsigned>(e) * 732923) >> 20); }
+
+	static unsigned pow5_factor(unsigned long long value) noexcept {
+		unsigned count = 0;
+		for (; value % 5 == 0; value /= 5) ++count;
+		return count;
+	}
+	static bool multiple_of_pow5(unsigned long long value, int p) noexcept { return pow5_factor(value) >= static_cast<unsigned>(p); }
+	static bool multiple_of_pow2(unsigned long long value, int p) noexcept { return (value & ((1ull << p) - 1)) == 0; }
+
+	static unsigned long long mul_shift(unsigned long long m, const unsigned long long* mul, int j) noexcept {
+		unsigned long long high0, high1;
+		umul128(m, mul[0], &high0);
+		unsigned long long low1 = umul128(m, mul[1], &high1);
+		unsigned long long sum = high0 + low1;
+		if (sum < high0) ++high1; // carry
+		int dist = j - 64; // always in (0, 64)
+		return (high1 << (64 - dist)) | (sum >> dist);
+	}
+
+public:
+	static decimal_fp convert(unsigned long long ieeeMantissa, unsigned ieeeExponent) noexcept {
+		int e2;
+		unsigned long long m2;
+		if (ieeeExponent == 0) { // subnormal
+			e2 = 1 - EXPONENT_BIAS - MANTISSA_BITS - 2;
+			m2 = ieeeMantissa;
+		} else {
+			e2 = static_cast<int>(ieeeExponent) - EXPONENT_BIAS - MANTISSA_BITS - 2;
+			m2 = (1ull << MANTISSA_BITS) | ieeeMantissa;
+		}
+		bool acceptBounds = (m2 & 1) == 0; // round-half-even readers accept the interval bounds
+
+		// Step 2: the halfway points to the neighbors, scaled by 4.
+		unsigned long long mv = 4 * m2;
+		unsigned mmShift = (ieeeMantissa != 0 || ieeeExponent <= 1) ? 1 : 0; // lower gap is halved at powers of 2
+
+		// Step 3: convert the interval to a decimal power base.
+		unsigned long long vr, vp, vm;
+		int e10;
+		bool vmIsTrailingZeros = false, vrIsTrailingZeros = false;
+		if (e2 >= 0) {
+			int q = log10_pow2(e2) - (e2 > 3 ? 1 : 0);
+			e10 = q;
+			int k = POW5_INV_BITCOUNT + pow5bits(q) - 1;
+			int i = -e2 + q + k;
+			const unsigned long long* mul = pow5_inv_split()[q];
+			vr = mul_shift(4 * m2, mul, i);
+			vp = mul_shift(4 * m2 + 2, mul, i);
+			vm = mul_shift(4 * m2 - 1 - mmShift, mul, i);
+			if (q <= 21) { // only then can mv be a multiple of 5^q
+				if (mv % 5 == 0) {
+					vrIsTrailingZeros = multiple_of_pow5(mv, q);
+				} else if (acceptBounds) {
+					vmIsTrailingZeros = multiple_of_pow5(mv - 1 - mmShift, q);
+				} else {
+					vp -= multiple_of_pow5(mv + 2, q) ? 1 : 0;
+				}
+			}
+		} else {
+			int q = log10_pow5(-e2) - (-e2 > 1 ? 1 : 0);
+			e10 = q + e2;
+			int i = -e2 - q;
+			int k = pow5bits(i) - POW5_BITCOUNT;
+			int j = q - k;
+			const unsigned long long* mul = pow5_split()[i];
+			vr = mul_shift(4 * m2, mul, j);
+			vp = mul_shift(4 * m2 + 2, mul, j);
+			vm = mul_shift(4 * m2 - 1 - mmShift, mul, j);
+			if (q <= 1) { // mv has at least q trailing zero bits
+				vrIsTrailingZeros = true;
+				if (acceptBounds) {
+					vmIsTrailingZeros = mmShift == 1;
+				} else {
+					--vp;
+				}
+			} else if (q < 63) {
+				vrIsTrailingZeros = multiple_of_pow2(mv, q);
+			}
+		}
+
+		// Step 4: remove digits while the interval still holds more than one candidate.
+		int removed = 0;
+		unsigned lastRemovedDigit = 0;
+		unsigned long long output;
+		if (vmIsTrailingZeros || vrIsTrailingZeros) { // rare, exact bounds must be tracked
+			while (vp / 10 > vm / 10) {
+				vmIsTrailingZeros &= vm % 10 == 0;
+				vrIsTrailingZeros &= lastRemovedDigit == 0;
+				lastRemovedDigit = static_cast<unsigned>(vr % 10);
+				vr /= 10; vp /= 10; vm /= 10;
+				++removed;
+			}
+			if (vmIsTrailingZeros) {
+				while (vm % 10 == 0) {
+					vrIsTrailingZeros &= lastRemovedDigit == 0;
+					lastRemovedDigit = static_cast<unsigned>(vr % 10);
+					vr /= 10; vp /= 10; vm /= 10;
+					++removed;
+				}
+			}
+			if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+				lastRemovedDigit = 4; // exactly halfway, round to even
+			}
+			output = vr + (((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5) ? 1 : 0);
+		} else { // common case
+			bool roundUp = false;
+			if (vp / 100 > vm / 100) { // two digits at once
+				roundUp = vr % 100 >= 50;
+				vr /= 100; vp /= 100; vm /= 100;
+				removed += 2;
+			}
+			while (vp / 10 > vm / 10) {
+				roundUp = vr % 10 >= 5;
+				vr /= 10; vp /= 10; vm /= 10;
+				++removed;
+			}
+			output = vr + ((vr == vm || roundUp) ? 1 : 0);
+		}
+		return {output, e10 + removed};
+	}
+};
+
+// Arbitrary precision unsigned integer, just enough for the exact expansion of a double.
+class big_uint final {
+private:
+	static const size_t MAX_LIMBS = 36; // 1152 bits: 2^1024, or 2^1074 times 10
+	unsigned _limbs[MAX_LIMBS]; // little-endian
+	size_t   _size = 0;
+
+public:
+	// Constructs value << shift.
+	big_uint(unsigned long long value, size_t shift) noexcept {
+		memset(this->_limbs, 0, sizeof(this->_limbs));
+		size_t limb = shift / 32, bit = shift % 32;
+		this->_limbs[limb] = static_cast<unsigned>(value << bit);
+		this->_limbs[limb + 1] = static_cast<unsigned>(value >> (32 - bit));
+		this->_limbs[limb + 2] = bit ? static_cast<unsigned>(value >> (64 - bit)) : 0;
+		this->_size = limb + 3;
+		this->_trim();
+	}
+
+	bool is_zero() const noexcept { return !this->_size; }
+
+	// Divides by 10^9 in place; returns the remainder.
+	unsigned divmod_1e9() noexcept {
+		unsigned long long rem = 0;
+		for (size_t i = this->_size; i-- > 0; ) {
+			unsigned long long cur = (rem << 32) | this->_limbs[i];
+			this->_limbs[i] = static_cast<unsigned>(cur / 1000000000);
+			rem = cur % 1000000000;
+		}
+		this->_trim();
+		return static_cast<unsigned>(rem);
+	}
+
+	// For a fraction value / 2^bits: multiplies by 10, then removes and returns the integer part.
+	unsigned next_fraction_digit(size_t bits) noexcept {
+		unsigned long long carry = 0;
+		for (size_t i = 0; i < this->_size; ++i) {
+			unsigned long long cur = static_cast<unsigned long long>(this->_limbs[i]) * 10 + carry;
+			this->_limbs[i] = static_cast<unsigned>(cur);
+			carry = cur >> 32;
+		}
+		if (carry) this->_limbs[this->_size++] = static_cast<unsigned>(carry);
+
+		size_t limb = bits / 32, bit = bits % 32;
+		unsigned long long window = this->_limb_at(limb) | (static_cast<unsigned long long>(this->_limb_at(limb + 1)) << 32);
+		unsigned digit = static_cast<unsigned>(window >> bit); // less than 10, may span two limbs
+		if (limb < this->_size) {
+			this->_limbs[limb] &= (1u << bit) - 1;
+			this->_size = limb + 1;
+		}
+		this->_trim();
+		return digit;
+	}
+
+	// For a fraction value / 2^bits: compares it to 1/2, returning -1, 0 or 1.
+	int compare_half(size_t bits) const noexcept {
+		size_t limb = (bits - 1) / 32, bit = (bits - 1) % 32;
+		unsigned top = this->_limb_at(limb);
+		if (top >> bit) return (top & ((1u << bit) - 1)) || this->_any_below(limb) ? 1 : 0; // equal when nothing below the half bit
+		return -1;
+	}
+
+private:
+	unsigned _limb_at(size_t i) const noexcept { return i < this->_size ? this->_limbs[i] : 0; }
+	bool _any_below(size_t limb) const noexcept {
+		for (size_t i = 0; i < limb && i < this->_size; ++i) {
+			if (this->_limbs[i]) return true;
+		}
+		return false;
+	}
+	void _trim() noexcept { while (this->_size && !this->_limbs[this->_size - 1]) --this->_size; }
+};
+
+// Longest fraction a double can have, which is the exact expansion of 2^-1074.
+const size_t MAX_FRACTION_DIGITS = 1074;
+
+// Appends a positive, finite double with exactly precision digits after the decimal point,
+// correctly rounded, half to even; large or tiny values are expanded exactly.
+template<typename sinkT>
+inline void put_fixed(sinkT& sink, double value, int precision, const grouping& grp, wchar_t decimalPoint) {
+	unsigned long long bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+	unsigned ieeeExp = static_cast<unsigned>(bits >> 52) & 0x7FF;
+	unsigned long long m = bits & ((1ull << 52) - 1);
+	int e2 = -1074; // value = m * 2^e2
+	if (ieeeExp) {
+		m |= 1ull << 52;
+		e2 = static_cast<int>(ieeeExp) - 1075;
+	}
+	size_t numZeros = precision > 0 ? static_cast<size_t>(precision) : 0; // digits after the point, still to write
+
+	if (e2 >= 0 || !m) { // no fraction at all
+		wchar_t digits[320]; // 2^1024 has 309 digits
+		wchar_t* pEnd = digits + 320;
+		wchar_t* pFirst = pEnd;
+		if (e2 <= 11) { // fits in 64 bits
+			pFirst = write_dec_backwards(m << (e2 > 0 ? e2 : 0), pEnd);
+		} else {
+			big_uint big{m, static_cast<size_t>(e2)};
+			while (!big.is_zero()) { // 9 digits per division
+				wchar_t* pChunkEnd = pFirst;
+				pFirst = write_dec_backwards(big.divmod_1e9(), pChunkEnd);
+				if (!big.is_zero()) {
+					while (pFirst > pChunkEnd - 9) *--pFirst = L'0'; // inner chunks keep their leading zeros
+				}
+			}
+		}
+		put_grouped(sink, pFirst, pEnd - pFirst, grp);
+		if (numZeros) {
+			sink.append(&decimalPoint, 1);
+			sink.fill(L'0', numZeros);
+		}
+		return;
+	}
+
+	size_t k = static_cast<size_t>(-e2); // fraction bits
+	unsigned long long intPart = k < 64 ? m >> k : 0;
+	wchar_t frac[MAX_FRACTION_DIGITS];
+	size_t numFrac = numZeros < k ? numZeros : k; // the expansion ends after k digits
+	numZeros -= numFrac;
+	int cmpHalf = -1;
+
+	if (k <= 60) { // fraction fits in 64 bits even when multiplied by 10
+		unsigned long long mask = (1ull << k) - 1;
+		unsigned long long f = m & mask;
+		for (size_t i = 0; i < numFrac; ++i) {
+			f *= 10;
+			frac[i] = static_cast<wchar_t>(L'0' + (f >> k));
+			f &= mask;
+		}
+		unsigned long long half = 1ull << (k - 1);
+		cmpHalf = (f > half) ? 1 : (f == half) ? 0 : -1;
+	} else {
+		big_uint f{m, 0}; // intPart is zero
+		for (size_t i = 0; i < numFrac; ++i) {
+			frac[i] = static_cast<wchar_t>(L'0' + f.next_fraction_digit(k));
+		}
+		cmpHalf = f.is_zero() ? -1 : f.compare_half(k);
+	}
+
+	bool lastIsOdd = numFrac ? (frac[numFrac - 1] - L'0') % 2 != 0 : (intPart % 2) != 0;
+	if (cmpHalf > 0 || (cmpHalf == 0 && lastIsOdd)) {
+		size_t i = numFrac;
+		for (; i > 0 && frac[i - 1] == L'9'; --i) frac[i - 1] = L'0';
+		if (i) ++frac[i - 1];
+		else ++intPart; // carry out of the fraction
+	}
+
+	put_integer(sink, intPart, false, grp);
+	if (numFrac || numZeros) {
+		sink.append(&decimalPoint, 1);
+		sink.append(frac, numFrac);
+		sink.fill(L'0', numZeros);
+	}
+}
+
+// Appends a positive, finite, non-zero double as the shortest text which reads back to the same
+// value; fixed notation is used for 1e-6 <= value < 1e21, scientific otherwise, like JavaScript.
+template<typename sinkT>
+inline void put_shortest(sinkT& sink, double value, const grouping& grp, wchar_t decimalPoint) {
+	unsigned long long bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+	decimal_fp dec = shortest::convert(bits & ((1ull << 52) - 1), static_cast<unsigned>(bits >> 52) & 0x7FF);
+
+	wchar_t buf[48]; // 17 digits, then room for up to 21 integer digits
+	wchar_t* pDigits = write_dec_backwards(dec.digits, buf + 17);
+	int numDigits = static_cast<int>(buf + 17 - pDigits);
+	int pointPos = dec.exponent + numDigits; // digits before the decimal point
+
+	if (pointPos >= numDigits && pointPos <= 21) { // integer
+		for (int i = numDigits; i < pointPos; ++i) buf[17 + i - numDigits] = L'0';
+		put_grouped(sink, pDigits, pointPos, grp);
+	} else if (pointPos > 0 && pointPos <= 21) {
+		put_grouped(sink, pDigits, pointPos, grp);
+		sink.append(&decimalPoint, 1);
+		sink.append(pDigits + pointPos, numDigits - pointPos);
+	} else if (pointPos > -6 && pointPos <= 0) {
+		sink.append(L"0", 1);
+		sink.append(&decimalPoint, 1);
+		sink.fill(L'0', -pointPos);
+		sink.append(pDigits, numDigits);
+	} else {
+		sink.append(pDigits, 1);
+		if (numDigits > 1) {
+			sink.append(&decimalPoint, 1);
+			sink.append(pDigits + 1, numDigits - 1);
+		}
+		int sciExp = pointPos - 1;
+		sink.append(sciExp < 0 ? L"e-" : L"e+", 2);
+		wchar_t expBuf[4];
+		wchar_t* pExp = write_dec_backwards(sciExp < 0 ? -sciExp : sciExp, expBuf + 4);
+		sink.append(pExp, expBuf + 4 - pExp);
+	}
+}
+
+// Appends any double: with fixed precision, or the shortest round-trip text if precision is negative.
+template<typename sinkT>
+inline void put_double(sinkT& sink, double value, int precision, const grouping& grp, wchar_t decimalPoint) {
+	unsigned long long bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+	if ((bits & 0x7FF0000000000000ull) == 0x7FF0000000000000ull) { // not finite
+		if (bits & ((1ull << 52) - 1)) {
+			sink.append(L"nan", 3);
+		} else if (bits >> 63) {
+			sink.append(L"-inf", 4);
+		} else {
+			sink.append(L"inf", 3);
+		}
+		return;
+	}
+	if (bits >> 63) {
+		sink.append(L"-", 1);
+		bits &= ~(1ull << 63);
+		memcpy(&value, &bits, sizeof(bits));
+	}
+	if (precision >= 0) {
+		put_fixed(sink, value, precision, grp, decimalPoint);
+	} else if (!bits) {
+		sink.append(L"0", 1);
+	} else {
+		put_shortest(sink, value, grp, decimalPoint);
+	}
+}
+
+// Appends any arithmetic value; integers get precision zeros after the decimal point.
+template<typename sinkT, typename numT>
+inline void put_number(sinkT& sink, numT number, int precision, const grouping& grp, wchar_t decimalPoint) {
+	if constexpr (std::is_floating_point_v<numT>) {
+		put_double(sink, static_cast<double>(number), precision, grp, decimalPoint);
+	} else {
+		if constexpr (std::is_signed_v<numT>) {
+			put_integer(sink, number < 0 ? 0ull - static_cast<unsigned long long>(number)
+				: static_cast<unsigned long long>(number), number < 0, grp);
+		} else {
+			put_integer(sink, static_cast<unsigned long long>(number), false, grp);
+		}
+		if (precision > 0) {
+			sink.append(&decimalPoint, 1);
+			sink.fill(L'0', precision);
+		}
+	}
+}
+
+}//namespace str_num
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,259 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define WL_STR_PARSE_SSE2
+#endif
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+namespace wl {
+namespace _wli {
+
+// Win32-free text to number conversions, which validate and convert in a single pass.
+namespace str_parse {
+
+// Like std::from_chars_result, but with an index instead of a pointer.
+struct result final {
+	size_t    stop = 0;    // index of the first char which is not part of the number
+	std::errc ec = std::errc{}; // invalid_argument if there's no number at all, result_out_of_range if it doesn't fit
+};
+
+// Converts 8 UTF-16 decimal digits at once; returns false if any of them is not a digit.
+inline bool eight_digits(const wchar_t* s, unsigned& value) noexcept {
+#ifdef WL_STR_PARSE_SSE2
+	if (sizeof(wchar_t) == 2) {
+		__m128i digits = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s)), _mm_set1_epi16(L'0'));
+		__m128i above9 = _mm_subs_epu16(digits, _mm_set1_epi16(9)); // non-zero for anything not in 0-9
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(above9, _mm_setzero_si128())) != 0xFFFF) return false;
+
+		__m128i pairs = _mm_madd_epi16(digits, _mm_set_epi16(1, 10, 1, 10, 1, 10, 1, 10)); // 4 values of 2 digits
+		__m128i quads = _mm_madd_epi16(_mm_packs_epi32(pairs, pairs), _mm_set_epi16(1, 100, 1, 100, 1, 100, 1, 100));
+		value = static_cast<unsigned>(_mm_cvtsi128_si32(quads)) * 10000
+			+ static_cast<unsigned>(_mm_cvtsi128_si32(_mm_srli_si128(quads, 4)));
+		return true;
+	}
+#endif
+	unsigned v = 0;
+	for (size_t i = 0; i < 8; ++i) {
+		unsigned d = static_cast<unsigned>(s[i]) - L'0';
+		if (d > 9) return false;
+		v = v * 10 + d;
+	}
+	value = v;
+	return true;
+}
+
+// Accumulates decimal digits into value, flagging overflow past 64 bits; returns how many digits were consumed.
+inline size_t accumulate_dec(const wchar_t* s, size_t len, unsigned long long& value, bool& overflow) noexcept {
+	unsigned long long v = 0;
+	size_t i = 0;
+	unsigned block = 0;
+	while (i + 8 <= len && v < 100000000000ull && eight_digits(s + i, block)) { // 11 + 8 digits can't overflow
+		v = v * 100000000 + block;
+		i += 8;
+	}
+	for (; i < len; ++i) {
+		unsigned d = static_cast<unsigned>(s[i]) - L'0';
+		if (d > 9) break;
+		if (v < 1844674407370955161ull || (v == 1844674407370955161ull && d <= 5)) { // ULLONG_MAX / 10
+			v = v * 10 + d;
+		} else {
+			overflow = true; // keep consuming, so the stop index is right
+		}
+	}
+	value = v;
+	return i;
+}
+
+// Value of a digit in bases up to 36, or 99 if it's not a digit.
+inline unsigned digit_value(wchar_t ch) noexcept {
+	if (ch >= L'0' && ch <= L'9') return ch - L'0';
+	if (ch >= L'a' && ch <= L'z') return ch - L'a' + 10;
+	if (ch >= L'A' && ch <= L'Z') return ch - L'A' + 10;
+	return 99;
+}
+
+// Accumulates digits of any base from 2 to 36; returns how many digits were consumed.
+inline size_t accumulate_base(const wchar_t* s, size_t len, unsigned base, unsigned long long& value, bool& overflow) noexcept {
+	unsigned long long cutoff = std::numeric_limits<unsigned long long>::max() / base;
+	unsigned cutlim = static_cast<unsigned>(std::numeric_limits<unsigned long long>::max() % base);
+	unsigned long long v = 0;
+	size_t i = 0;
+	for (; i < len; ++i) {
+		unsigned d = digit_value(s[i]);
+		if (d >= base) break;
+		if (v < cutoff || (v == cutoff && d <= cutlim)) {
+			v = v * base + d;
+		} else {
+			overflow = true;
+		}
+	}
+	value = v;
+	return i;
+}
+
+// Parses an integer: optional minus sign for signed types, then digits; no spaces, no plus sign, no 0x prefix.
+template<typename intT>
+inline result parse_integer(std::wstring_view s, intT& value, int base) noexcept {
+	static_assert(std::is_integral_v<intT> && !std::is_same_v<intT, bool>, "Integer type expected.");
+	size_t i = 0;
+	bool neg = false;
+	if constexpr (std::is_signed_v<intT>) {
+		if (!s.empty() && s[0] == L'-') {
+			neg = true;
+			++i;
+		}
+	}
+
+	unsigned long long mag = 0;
+	bool overflow = false;
+	size_t numDigits = (base == 10)
+		? accumulate_dec(s.data() + i, s.length() - i, mag, overflow)
+		: (base >= 2 && base <= 36) ? accumulate_base(s.data() + i, s.length() - i, base, mag, overflow)
+		: 0;
+	if (!numDigits) return {0, std::errc::invalid_argument};
+	i += numDigits;
+
+	unsigned long long limit = static_cast<unsigned long long>(std::numeric_limits<intT>::max()) + (neg ? 1 : 0);
+	if (overflow || mag > limit) return {i, std::errc::result_out_of_range};
+	value = static_cast<intT>(neg ? 0ull - mag : mag); // two's complement wraps the negative magnitude
+	return {i, std::errc{}};
+}
+
+inline bool match_word_i(std::wstring_view s, size_t pos, const wchar_t* lowerWord, size_t wordLen) noexcept {
+	if (s.length() - pos < wordLen) return false;
+	for (size_t i = 0; i < wordLen; ++i) {
+		wchar_t ch = s[pos + i];
+		if (ch >= L'A' && ch <= L'Z') ch += 0x20;
+		if (ch != lowerWord[i]) return false;
+	}
+	return true;
+}
+
+// Correctly rounded conversion of an already validated decimal number, for the cases the
+// fast path can't handle exactly; the C locale is used, so the decimal point is always a dot.
+inline double slow_parse_double(std::wstring_view num) {
+	char stackBuf[128];
+	std::string heapBuf;
+	char* buf = stackBuf;
+	if (num.length() >= sizeof(stackBuf)) {
+		heapBuf.resize(num.length() + 1);
+		buf = &heapBuf[0];
+	}
+	for (size_t i = 0; i < num.length(); ++i) buf[i] = static_cast<char>(num[i]); // validated as ASCII
+	buf[num.length()] = '\0';
+#ifdef _WIN32
+	static _locale_t cLocale = _create_locale(LC_NUMERIC, "C");
+	return _strtod_l(buf, nullptr, cLocale);
+#else
+	static locale_t cLocale = newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0)); // std::strtod would follow setlocale()
+	return strtod_l(buf, nullptr, cLocale);
+#endif
+}
+
+// Parses a double: optional minus sign, digits with an optional point, optional exponent;
+// also inf, infinity and nan, case-insensitive. No spaces, no plus sign, no hex floats.
+inline result parse_double(std::wstring_view s, double& value) {
+	static const double exactPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	size_t i = 0;
+	bool neg = !s.empty() && s[0] == L'-';
+	if (neg) ++i;
+
+	if (match_word_i(s, i, L"infinity", 8) || match_word_i(s, i, L"inf", 3)) {
+		value = neg ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+		return {i + (match_word_i(s, i, L"infinity", 8) ? 8 : 3), std::errc{}};
+	} else if (match_word_i(s, i, L"nan", 3)) {
+		value = neg ? -std::numeric_limits<double>::quiet_NaN() : std::numeric_limits<double>::quiet_NaN();
+		return {i + 3, std::errc{}};
+	}
+
+	unsigned long long mant = 0; // up to 19 significant digits
+	int numSig = 0, exp10 = 0;
+	bool truncated = false, anyDigit = false;
+	for (; i < s.length(); ++i) { // integer part
+		unsigned d = static_cast<unsigned>(s[i]) - L'0';
+		if (d > 9) break;
+		anyDigit = true;
+		if (numSig < 19) {
+			if (mant || d) {
+				mant = mant * 10 + d;
+				++numSig;
+			}
+		} else {
+			++exp10;
+			truncated |= d != 0;
+		}
+	}
+	if (i < s.length() && s[i] == L'.') {
+		for (++i; i < s.length(); ++i) { // fraction
+			unsigned d = static_cast<unsigned>(s[i]) - L'0';
+			if (d > 9) break;
+			anyDigit = true;
+			if (numSig < 19) {
+				if (mant || d) {
+					mant = mant * 10 + d;
+					++numSig;
+				}
+				--exp10;
+			} else {
+				truncated |= d != 0;
+			}
+		}
+	}
+	if (!anyDigit) return {0, std::errc::invalid_argument};
+
+	if (i < s.length() && (s[i] == L'e' || s[i] == L'E')) { // exponent is consumed only if it has digits
+		size_t j = i + 1;
+		bool expNeg = false;
+		if (j < s.length() && (s[j] == L'-' || s[j] == L'+')) expNeg = s[j++] == L'-';
+		if (j < s.length() && s[j] >= L'0' && s[j] <= L'9') {
+			int expVal = 0;
+			for (; j < s.length() && s[j] >= L'0' && s[j] <= L'9'; ++j) {
+				if (expVal < 100000) expVal = expVal * 10 + (s[j] - L'0'); // saturates, way past any double
+			}
+			exp10 += expNeg ? -expVal : expVal;
+			i = j;
+		}
+	}
+
+	double v = 0;
+	const unsigned long long MAX_EXACT = 1ull << 53;
+	if (!mant) {
+		v = 0;
+	} else if (!truncated && mant <= MAX_EXACT && exp10 >= -22 && exp10 <= 22) { // Clinger's fast path, exact
+		v = exp10 < 0 ? static_cast<double>(mant) / exactPow10[-exp10] : static_cast<double>(mant) * exactPow10[exp10];
+	} else if (!truncated && mant <= MAX_EXACT && exp10 > 22 && exp10 <= 22 + 15
+		&& mant <= MAX_EXACT / static_cast<unsigned long long>(exactPow10[exp10 - 22])) // like 123e25, still exact
+	{
+		v = static_cast<double>(mant * static_cast<unsigned long long>(exactPow10[exp10 - 22])) * 1e22;
+	} else {
+		v = slow_parse_double(s.substr(neg ? 1 : 0, i - (neg ? 1 : 0)));
+	}
+
+	if (v == std::numeric_limits<double>::infinity() || (v == 0 && mant)) { // overflow or underflow
+		return {i, std::errc::result_out_of_range};
+	}
+	value = neg ? -v : v;
+	return {i, std::errc{}};
+}
+
+}//namespace str_parse
+}//namespace _wli
+}//namespace wl
@@ -9,35 +9,12 @@
 #include <cwctype>
 #include <string>
 #include <Windows.h>
+#include "str_utf.h"
 
 namespace wl {
 namespace _wli {
 namespace str_priv {
 
-template<typename T>
-inline T format_raw_arg(T val) noexcept {
-	static_assert(!std::is_same<T, const char*>::value,
-		"Non-wide char* being used on str::format(), str::to_wstring() can fix it.");
-	static_assert(!std::is_same<T, std::string>::value,
-		"Non-wide std::string being used on str::format(), str::to_wstring() can fix it.");
-	return val;
-}
-
-inline const wchar_t* format_raw_arg(const std::wstring& val) noexcept {
-	return val.c_str(); // so format() will also accept wstring in formatting list
-}
-
-template<typename ...argsT>
-inline std::wstring format_raw(size_t strFormatLen, const wchar_t* strFormat, const argsT&... args) {
-	// https://msdn.microsoft.com/en-us/magazine/dn913181.aspx
-	// https://stackoverflow.com/a/514921/6923555
-	size_t len = swprintf(nullptr, 0, strFormat, format_raw_arg(args)...);
-	std::wstring ret(len + 1, L'\0'); // room for terminating null
-	swprintf(&ret[0], len + 1, strFormat, format_raw_arg(args)...);
-	ret.resize(len); // remove terminating null
-	return ret;
-}
-
 inline bool ends_begins_first_check(const std::wstring& s, const wchar_t* what, size_t& whatLen) noexcept {
 	if (s.empty()) return false;
 
@@ -63,6 +40,43 @@ inline std::wstring parse_ascii(const BYTE* data, size_t sz) {
 	return ret; // data didn't have a terminating null
 }
 
+inline void trim_at_null(std::wstring& s) {
+	size_t nullIdx = s.find(L'\0');
+	if (nullIdx != std::wstring::npos) {
+		s.resize(nullIdx); // trim_nulls()
+	}
+}
+
+inline std::wstring parse_utf8(const BYTE* data, size_t sz) {
+	std::wstring ret;
+	if (data && sz) {
+		ret.resize(str_utf::utf16_max_len(sz)); // single pass, shrunk afterwards
+		ret.resize(str_utf::utf8_to_utf16(data, sz, &ret[0]).written);
+		trim_at_null(ret);
+	}
+	return ret;
+}
+
+inline std::wstring parse_utf16(const BYTE* data, size_t sz, bool bigEndian) {
+	std::wstring ret;
+	if (data && sz) {
+		ret.resize(str_utf::utf16_max_len_from_utf16(sz));
+		ret.resize(str_utf::utf16_to_utf16(data, sz, bigEndian, &ret[0]).written);
+		trim_at_null(ret);
+	}
+	return ret;
+}
+
+inline std::wstring parse_utf32(const BYTE* data, size_t sz, bool bigEndian) {
+	std::wstring ret;
+	if (data && sz) {
+		ret.resize(str_utf::utf16_max_len_from_utf32(sz)); // surrogate pairs may be needed
+		ret.resize(str_utf::utf32_to_utf16(data, sz, bigEndian, &ret[0]).written);
+		trim_at_null(ret);
+	}
+	return ret;
+}
+
 inline std::wstring parse_encoded(const BYTE* data, size_t sz, UINT codePage) {
 	std::wstring ret;
 	if (data && sz) {
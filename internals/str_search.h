@@ -0,0 +1,141 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <array>
+#include <string>
+#include "str_case.h"
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define WL_STR_SEARCH_SSE2
+#endif
+
+namespace wl {
+namespace _wli {
+
+// Finds the first position in [pos, end) holding either char a or char b, or -1.
+inline size_t str_find_either(const wchar_t* s, size_t pos, size_t end, wchar_t a, wchar_t b) noexcept {
+#ifdef WL_STR_SEARCH_SSE2
+	if (sizeof(wchar_t) == 2) { // UTF-16 lanes, 8 chars per compare
+		__m128i va = _mm_set1_epi16(static_cast<short>(a));
+		__m128i vb = _mm_set1_epi16(static_cast<short>(b));
+		for (; pos + 8 <= end; pos += 8) {
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + pos));
+			int mask = _mm_movemask_epi8(_mm_or_si128(
+				_mm_cmpeq_epi16(block, va), _mm_cmpeq_epi16(block, vb)));
+			if (mask) {
+				unsigned long bit = 0;
+				while (!(mask & (1 << bit))) ++bit;
+				return pos + bit / 2;
+			}
+		}
+	}
+#endif
+	for (; pos < end; ++pos) {
+		if (s[pos] == a || s[pos] == b) return pos;
+	}
+	return static_cast<size_t>(-1);
+}
+
+// Case-insensitive Boyer-Moore-Horspool searcher over folded UTF-16 code units.
+// The needle is folded once at construction; the haystack is never copied.
+class str_search final {
+private:
+	std::wstring              _needle; // folded
+	std::array<size_t, 256>   _fwdShift{}, _revShift{}; // indexed by low byte of folded char
+	std::array<wchar_t, 2>    _firstVariants{}; // raw chars which fold to _needle[0], for the prefilter
+	bool                      _canPrefilter = false;
+
+public:
+	static const size_t npos = static_cast<size_t>(-1);
+
+	str_search() = default;
+
+	explicit str_search(const wchar_t* needle, size_t needleLen) {
+		this->_needle.assign(needle, needleLen);
+		for (wchar_t& ch : this->_needle) {
+			ch = str_case::fold(ch);
+		}
+
+		size_t m = this->_needle.length();
+		this->_fwdShift.fill(m ? m : 1);
+		this->_revShift.fill(m ? m : 1);
+		for (size_t i = 0; i + 1 < m; ++i) { // several chars share a slot, the smallest shift is kept
+			this->_fwdShift[this->_needle[i] & 0xFF] = m - 1 - i;
+			this->_revShift[this->_needle[m - 1 - i] & 0xFF] = m - 1 - i;
+		}
+
+		if (m && this->_needle[0] < 0x80) { // only ASCII chars have exactly two known raw forms
+			wchar_t first = this->_needle[0];
+			this->_firstVariants = {first,
+				(first >= L'a' && first <= L'z') ? static_cast<wchar_t>(first - 0x20) : first};
+			this->_canPrefilter = true;
+		}
+	}
+
+	size_t         length() const noexcept { return this->_needle.length(); }
+	const wchar_t* folded() const noexcept { return this->_needle.c_str(); }
+
+	// Returns the index of the first match at or after offset, or npos.
+	size_t find(const wchar_t* hay, size_t hayLen, size_t offset = 0) const noexcept {
+		size_t m = this->_needle.length();
+		if (offset > hayLen) return npos;
+		if (!m) return offset;
+		if (m > hayLen - offset) return npos;
+
+		if (this->_canPrefilter && m <= 4) { // short needles: skip loop on first char is faster than shifts
+			size_t pos = offset;
+			size_t lastStart = hayLen - m;
+			while ((pos = this->_prefilter(hay, pos, lastStart + 1)) != npos) {
+				if (this->_matches_at(hay + pos)) return pos;
+				++pos;
+			}
+			return npos;
+		}
+
+		wchar_t nLast = this->_needle[m - 1];
+		for (size_t pos = offset; pos <= hayLen - m; ) {
+			wchar_t hLast = str_case::fold(hay[pos + m - 1]);
+			if (hLast == nLast && this->_matches_at(hay + pos)) return pos;
+			pos += this->_fwdShift[hLast & 0xFF];
+		}
+		return npos;
+	}
+
+	// Returns the index of the last match which starts at or before offset, or npos.
+	size_t rfind(const wchar_t* hay, size_t hayLen, size_t offset = npos) const noexcept {
+		size_t m = this->_needle.length();
+		if (m > hayLen) return npos;
+		size_t pos = (offset > hayLen - m) ? hayLen - m : offset;
+		if (!m) return pos;
+
+		wchar_t nFirst = this->_needle[0];
+		for (;;) {
+			wchar_t hFirst = str_case::fold(hay[pos]);
+			if (hFirst == nFirst && this->_matches_at(hay + pos)) return pos;
+			size_t shift = this->_revShift[hFirst & 0xFF];
+			if (shift > pos) return npos;
+			pos -= shift;
+		}
+	}
+
+private:
+	bool _matches_at(const wchar_t* hay) const noexcept {
+		for (size_t i = this->_needle.length(); i-- > 0; ) { // last char is the most discriminating for Horspool
+			if (str_case::fold(hay[i]) != this->_needle[i]) return false;
+		}
+		return true;
+	}
+
+	// Finds the first position in [pos, end) whose raw char is one of the first-char variants.
+	size_t _prefilter(const wchar_t* hay, size_t pos, size_t end) const noexcept {
+		return str_find_either(hay, pos, end, this->_firstVariants[0], this->_firstVariants[1]);
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,126 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "str_case.h"
+
+namespace wl {
+namespace _wli {
+
+// Sort keys, whose plain ordinal comparison gives case-insensitive and natural ordering,
+// so each string is normalized once, instead of at every comparison.
+namespace str_sort {
+
+enum : unsigned { IGNORE_CASE = 0x01, IGNORE_DIACRITICS = 0x02, NATURAL = 0x04 };
+
+// Appends the key of s; a run of digits becomes a marker, its length without leading zeros,
+// then the digits, so "x9" comes before "x10". The marker is '0', so numbers sort where digits would.
+inline void append_key(std::wstring_view s, unsigned flags, std::wstring& key) {
+	for (size_t i = 0; i < s.length(); ) {
+		wchar_t ch = s[i];
+		if ((flags & NATURAL) && ch >= L'0' && ch <= L'9') {
+			size_t start = i;
+			while (start < s.length() && s[start] == L'0') ++start;
+			size_t end = start;
+			while (end < s.length() && s[end] >= L'0' && s[end] <= L'9') ++end;
+			size_t numLen = end - start; // zero if it's only zeros
+			key.push_back(L'0');
+			key.push_back(static_cast<wchar_t>(numLen < 0xFFFF ? numLen : 0xFFFF));
+			key.append(s.data() + start, numLen);
+			i = end;
+			continue;
+		}
+		if (flags & IGNORE_DIACRITICS) ch = str_case::strip_diacritic(ch);
+		if (flags & IGNORE_CASE) ch = str_case::fold(ch);
+		key.push_back(ch);
+		++i;
+	}
+}
+
+struct key_entry final {
+	const wchar_t* key;
+	size_t         len;
+	size_t         index; // position in the original list, the final tie breaker
+};
+
+inline bool key_less(const key_entry& a, const key_entry& b) noexcept {
+	int cmp = std::wstring_view{a.key, a.len}.compare(std::wstring_view{b.key, b.len});
+	return cmp ? cmp < 0 : a.index < b.index;
+}
+
+// Runs func(chunkIndex, begin, end) over numChunks slices of [0, count), one thread per slice.
+template<typename funcT>
+inline void run_chunks(size_t count, size_t numChunks, funcT&& func) {
+	if (numChunks <= 1) {
+		func(0, 0, count);
+		return;
+	}
+	std::vector<std::thread> threads;
+	threads.reserve(numChunks - 1);
+	for (size_t c = 1; c < numChunks; ++c) {
+		threads.emplace_back([&func, c, count, numChunks]() {
+			func(c, count * c / numChunks, count * (c + 1) / numChunks);
+		});
+	}
+	func(0, 0, count / numChunks); // calling thread does its share too
+	for (std::thread& t : threads) t.join();
+}
+
+// Returns the indexes of the strings in sorted order. Keys are built and sorted in
+// parallel slices, which are then merged pairwise, also in parallel.
+template<typename strT>
+inline std::vector<size_t> sorted_order(const std::vector<strT>& strs, unsigned flags, size_t numThreads) {
+	const size_t MIN_PER_THREAD = 8 * 1024; // below that, threads cost more than they save
+	if (!numThreads) numThreads = std::thread::hardware_concurrency();
+	size_t numChunks = std::min(std::max<size_t>(numThreads, 1), strs.size() / MIN_PER_THREAD);
+	if (!numChunks) numChunks = 1;
+
+	std::vector<std::wstring> keyBufs(numChunks); // one per slice, so threads don't share allocations
+	std::vector<key_entry> entries(strs.size());
+	std::vector<size_t> bounds(numChunks + 1);
+	for (size_t c = 0; c <= numChunks; ++c) bounds[c] = strs.size() * c / numChunks;
+
+	run_chunks(strs.size(), numChunks, [&](size_t c, size_t begin, size_t end) {
+		std::wstring& buf = keyBufs[c];
+		std::vector<size_t> offsets;
+		offsets.reserve(end - begin + 1);
+		for (size_t i = begin; i < end; ++i) {
+			offsets.emplace_back(buf.length());
+			append_key(std::wstring_view{strs[i]}, flags, buf);
+		}
+		offsets.emplace_back(buf.length());
+		for (size_t i = begin; i < end; ++i) { // buffer won't grow anymore, so pointers are stable
+			entries[i] = {buf.data() + offsets[i - begin], offsets[i - begin + 1] - offsets[i - begin], i};
+		}
+		std::sort(entries.begin() + begin, entries.begin() + end, key_less);
+	});
+
+	for (size_t width = 1; width < numChunks; width *= 2) { // merge sorted slices pairwise
+		std::vector<std::thread> threads;
+		for (size_t c = 0; c + width < numChunks; c += width * 2) {
+			size_t first = bounds[c], mid = bounds[c + width], last = bounds[std::min(c + width * 2, numChunks)];
+			threads.emplace_back([&entries, first, mid, last]() {
+				std::inplace_merge(entries.begin() + first, entries.begin() + mid, entries.begin() + last, key_less);
+			});
+		}
+		for (std::thread& t : threads) t.join();
+	}
+
+	std::vector<size_t> order;
+	order.reserve(entries.size());
+	for (const key_entry& e : entries) order.emplace_back(e.index);
+	return order;
+}
+
+}//namespace str_sort
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,138 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cwctype>
+#include <iterator>
+#include <string_view>
+#include "str_search.h"
+
+namespace wl {
+namespace _wli {
+
+// Splits at each occurrence of a delimiter string.
+struct str_delim_splitter final {
+	std::wstring_view delimiter;
+
+	bool next(std::wstring_view text, size_t& pos, std::wstring_view& token) const noexcept {
+		if (pos == std::wstring_view::npos) return false; // last token already yielded
+
+		size_t found = std::wstring_view::npos;
+		if (!this->delimiter.empty()) {
+			for (size_t cand = pos; ; ++cand) { // SIMD scan for the first char, then confirm
+				cand = str_find_either(text.data(), cand, text.length(), this->delimiter[0], this->delimiter[0]);
+				if (cand == std::wstring_view::npos || cand + this->delimiter.length() > text.length()) break;
+				if (text.compare(cand, this->delimiter.length(), this->delimiter) == 0) {
+					found = cand;
+					break;
+				}
+			}
+		}
+
+		if (found == std::wstring_view::npos) {
+			token = text.substr(pos);
+			pos = std::wstring_view::npos;
+		} else {
+			token = text.substr(pos, found - pos);
+			pos = found + this->delimiter.length();
+		}
+		return true;
+	}
+};
+
+// Splits at \r\n, \n and \r, which can be mixed in the same text.
+struct str_line_splitter final {
+	bool next(std::wstring_view text, size_t& pos, std::wstring_view& token) const noexcept {
+		if (pos == std::wstring_view::npos) return false;
+
+		size_t found = str_find_either(text.data(), pos, text.length(), L'\r', L'\n');
+		if (found == std::wstring_view::npos) {
+			token = text.substr(pos);
+			pos = std::wstring_view::npos;
+		} else {
+			token = text.substr(pos, found - pos);
+			pos = found + ((text[found] == L'\r' && found + 1 < text.length() && text[found + 1] == L'\n') ? 2 : 1);
+		}
+		return true;
+	}
+};
+
+// Splits at white spaces, tokens may be enclosed in double quotes.
+struct str_quoted_splitter final {
+	bool next(std::wstring_view text, size_t& pos, std::wstring_view& token) const noexcept {
+		while (pos < text.length()) {
+			if (text[pos] == L'\"') { // begin of quoted string
+				size_t base = ++pos; // point to 1st char of string
+				size_t closing = text.find(L'\"', base);
+				if (closing == std::wstring_view::npos) { // won't compute open-quoted
+					pos = text.length();
+					return false;
+				}
+				token = text.substr(base, closing - base);
+				pos = closing + 1; // point to 1st char after closing quote
+				return true;
+			} else if (!std::iswspace(text[pos])) { // 1st char of non-quoted string
+				size_t base = pos++;
+				while (pos < text.length() && !std::iswspace(text[pos]) && text[pos] != L'\"') ++pos;
+				token = text.substr(base, pos - base);
+				return true;
+			}
+			++pos; // some white space
+		}
+		return false;
+	}
+};
+
+// Lazy range of std::wstring_view tokens, which point into the original text.
+template<typename splitterT>
+class str_tokens final {
+private:
+	std::wstring_view _text;
+	splitterT         _splitter;
+
+public:
+	class iterator final {
+	private:
+		const str_tokens* _owner = nullptr; // null when past the end
+		size_t            _pos = 0;
+		std::wstring_view _token;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type        = std::wstring_view;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = const std::wstring_view*;
+		using reference         = const std::wstring_view&;
+
+		iterator() = default;
+		explicit iterator(const str_tokens& owner) noexcept : _owner{&owner} { this->operator++(); }
+
+		const std::wstring_view& operator*() const noexcept  { return this->_token; }
+		const std::wstring_view* operator->() const noexcept { return &this->_token; }
+		bool operator==(const iterator& other) const noexcept {
+			return this->_owner == other._owner && (!this->_owner || this->_pos == other._pos);
+		}
+		bool operator!=(const iterator& other) const noexcept { return !this->operator==(other); }
+
+		iterator& operator++() noexcept {
+			if (!this->_owner->_splitter.next(this->_owner->_text, this->_pos, this->_token)) {
+				this->_owner = nullptr;
+			}
+			return *this;
+		}
+		iterator operator++(int) noexcept { iterator tmp = *this; this->operator++(); return tmp; }
+	};
+
+	str_tokens(std::wstring_view text, splitterT splitter) noexcept :
+		_text{text}, _splitter{splitter} { }
+
+	iterator begin() const noexcept { return this->_text.empty() ? iterator{} : iterator{*this}; }
+	iterator end() const noexcept   { return {}; }
+};
+
+}//namespace _wli
+}//namespace wl
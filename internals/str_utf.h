@@ -0,0 +1,366 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstring>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define WL_STR_UTF_SSE2
+#endif
+
+namespace wl {
+namespace _wli {
+
+// Win32-free UTF-8/UTF-16/UTF-32 to UTF-16 transcoding, writing straight into caller-supplied buffers.
+// Ill-formed input is replaced with U+FFFD, one per maximal invalid subpart, like Win32 does.
+namespace str_utf {
+
+const wchar_t REPLACEMENT_CHAR = 0xFFFD;
+
+// Result of a conversion.
+struct result final {
+	size_t read = 0;       // elements consumed from the input buffer
+	size_t written = 0;    // code units written to the output buffer
+	size_t numInvalid = 0; // ill-formed sequences replaced with U+FFFD
+};
+
+// Maximum number of UTF-16 code units produced from srcLen UTF-8 bytes.
+inline size_t utf16_max_len(size_t utf8Len) noexcept  { return utf8Len; }
+// Maximum number of UTF-8 bytes produced from srcLen UTF-16 code units.
+inline size_t utf8_max_len(size_t utf16Len) noexcept  { return utf16Len * 3; }
+// Maximum number of UTF-16 code units produced from srcLen UTF-16 or UTF-32 bytes.
+inline size_t utf16_max_len_from_utf16(size_t numBytes) noexcept { return (numBytes + 1) / 2; }
+inline size_t utf16_max_len_from_utf32(size_t numBytes) noexcept { return (numBytes / 4) * 2 + (numBytes % 4 ? 1 : 0); }
+
+// Number of leading ASCII bytes in the buffer.
+inline size_t ascii_prefix_len(const unsigned char* src, size_t srcLen) noexcept {
+	size_t i = 0;
+#ifdef WL_STR_UTF_SSE2
+	for (; i + 16 <= srcLen; i += 16) {
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		if (_mm_movemask_epi8(block)) break; // some byte has the high bit set
+	}
+#endif
+	while (i < srcLen && src[i] < 0x80) ++i;
+	return i;
+}
+
+// Decodes one UTF-8 sequence, which must start at a non-ASCII byte.
+// Returns the number of bytes consumed; codePoint is -1 if the sequence is ill-formed.
+// If the buffer ends in the middle of a valid sequence, incomplete is set to true.
+inline size_t decode_utf8_seq(const unsigned char* src, size_t srcLen,
+	long& codePoint, bool& incomplete) noexcept
+{
+	// https://www.unicode.org/versions/Unicode11.0.0/ch03.pdf, table 3-7
+	unsigned char lead = src[0];
+	size_t needed = 0;
+	unsigned char lo = 0x80, hi = 0xBF; // valid range of the 2nd byte
+	incomplete = false;
+
+	if (lead >= 0xC2 && lead <= 0xDF)      { needed = 1; codePoint = lead & 0x1F; }
+	else if (lead >= 0xE0 && lead <= 0xEF) { needed = 2; codePoint = lead & 0x0F;
+		if (lead == 0xE0) lo = 0xA0;  // overlong
+		if (lead == 0xED) hi = 0x9F; } // surrogates
+	else if (lead >= 0xF0 && lead <= 0xF4) { needed = 3; codePoint = lead & 0x07;
+		if (lead == 0xF0) lo = 0x90;  // overlong
+		if (lead == 0xF4) hi = 0x8F; } // above U+10FFFF
+	else {
+		codePoint = -1; // stray continuation byte, C0, C1 or F5..FF
+		return 1;
+	}
+
+	for (size_t i = 1; i <= needed; ++i) {
+		if (i >= srcLen) {
+			incomplete = true; // valid so far, but truncated
+			codePoint = -1;
+			return i;
+		}
+		unsigned char b = src[i];
+		if (b < (i == 1 ? lo : 0x80) || b > (i == 1 ? hi : 0xBF)) {
+			codePoint = -1; // maximal subpart ends here, b is not consumed
+			return i;
+		}
+		codePoint = (codePoint << 6) | (b & 0x3F);
+	}
+	return needed + 1;
+}
+
+// Summary of a UTF-8 validation pass.
+struct utf8_scan final {
+	size_t scanned = 0;      // bytes actually examined
+	size_t numNonAscii = 0;  // well-formed non-ASCII sequences
+	bool   invalid = false;  // an ill-formed sequence was found, scanning stopped there
+	bool   truncated = false; // buffer ends in the middle of a sequence which is well-formed so far
+};
+
+// Validates UTF-8 with a table-driven state machine, skipping ASCII runs 16 bytes at a time.
+// Stops at the first ill-formed sequence, since the verdict can't change afterwards.
+inline utf8_scan validate_utf8(const unsigned char* src, size_t srcLen) noexcept {
+	// Byte classes, following https://www.unicode.org/versions/Unicode11.0.0/ch03.pdf, table 3-7.
+	static const unsigned char classes[256] = {
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,   // 80..8F continuation
+		2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,   // 90..9F continuation
+		3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,   // A0..BF continuation
+		3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+		4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,   // C0..C1 never valid, C2..DF 2-byte lead
+		5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+		6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 7,   // E0, E1..EC, ED, EE..EF
+		9, 10, 10, 10, 11, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4 // F0, F1..F3, F4, F5..FF never valid
+	};
+
+	// States: 0 accept, 1 reject, 2 need 1 more, 3 need 2 more, 4 need 3 more,
+	// 5 after E0, 6 after ED, 7 after F0, 8 after F4.
+	static const unsigned char transitions[9][12] = {
+		// 00  80  90  A0  inv C2  E0  E1  ED  F0  F1  F4
+		{  0,  1,  1,  1,  1,  2,  5,  3,  6,  7,  4,  8 }, // accept
+		{  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1 }, // reject
+		{  1,  0,  0,  0,  1,  1,  1,  1,  1,  1,  1,  1 }, // need 1
+		{  1,  2,  2,  2,  1,  1,  1,  1,  1,  1,  1,  1 }, // need 2
+		{  1,  3,  3,  3,  1,  1,  1,  1,  1,  1,  1,  1 }, // need 3
+		{  1,  1,  1,  2,  1,  1,  1,  1,  1,  1,  1,  1 }, // E0: A0..BF, no overlongs
+		{  1,  2,  2,  1,  1,  1,  1,  1,  1,  1,  1,  1 }, // ED: 80..9F, no surrogates
+		{  1,  1,  3,  3,  1,  1,  1,  1,  1,  1,  1,  1 }, // F0: 90..BF, no overlongs
+		{  1,  3,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1 }  // F4: 80..8F, not above U+10FFFF
+	};
+
+	utf8_scan scan;
+	unsigned char state = 0;
+	size_t i = 0;
+
+	while (i < srcLen) {
+		if (state == 0) {
+			i += ascii_prefix_len(src + i, srcLen - i);
+			if (i == srcLen) break;
+		}
+		unsigned char next = transitions[state][classes[src[i]]];
+		if (next == 1) {
+			scan.invalid = true;
+			break;
+		} else if (next == 0) {
+			++scan.numNonAscii; // sequence completed
+		}
+		state = next;
+		++i;
+	}
+
+	scan.scanned = i;
+	scan.truncated = !scan.invalid && state != 0;
+	return scan;
+}
+
+// Writes a code point as UTF-16, returns the number of code units written.
+inline size_t put_utf16(long codePoint, wchar_t* dest) noexcept {
+	if (codePoint < 0x10000) {
+		dest[0] = static_cast<wchar_t>(codePoint);
+		return 1;
+	}
+	codePoint -= 0x10000;
+	dest[0] = static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+	dest[1] = static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+	return 2;
+}
+
+// Widens ASCII bytes into UTF-16 code units.
+inline void widen_ascii(const unsigned char* src, size_t count, wchar_t* dest) noexcept {
+	size_t i = 0;
+#ifdef WL_STR_UTF_SSE2
+	if (sizeof(wchar_t) == 2) {
+		__m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= count; i += 16) {
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_unpacklo_epi8(block, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 8), _mm_unpackhi_epi8(block, zero));
+		}
+	}
+#endif
+	for (; i < count; ++i) dest[i] = src[i];
+}
+
+// Converts UTF-8 to UTF-16; dest must have room for utf16_max_len(srcLen) code units.
+// If not the last chunk, a truncated sequence at the end is left unread, to be completed by the next chunk.
+inline result utf8_to_utf16(const unsigned char* src, size_t srcLen, wchar_t* dest,
+	bool isLastChunk = true) noexcept
+{
+	result res;
+	size_t i = 0;
+
+	while (i < srcLen) {
+		size_t asciiLen = ascii_prefix_len(src + i, srcLen - i);
+		widen_ascii(src + i, asciiLen, dest + res.written);
+		i += asciiLen;
+		res.written += asciiLen;
+
+		while (i < srcLen && src[i] >= 0x80) { // run of non-ASCII chars
+			long codePoint = 0;
+			bool incomplete = false;
+			size_t seqLen = decode_utf8_seq(src + i, srcLen - i, codePoint, incomplete);
+			if (incomplete && !isLastChunk) {
+				res.read = i;
+				return res;
+			}
+			i += seqLen;
+			if (codePoint < 0) {
+				dest[res.written++] = REPLACEMENT_CHAR;
+				++res.numInvalid;
+			} else {
+				res.written += put_utf16(codePoint, dest + res.written);
+			}
+		}
+	}
+	res.read = i;
+	return res;
+}
+
+// Converts UTF-16 to UTF-8; dest must have room for utf8_max_len(srcLen) bytes.
+inline result utf16_to_utf8(const wchar_t* src, size_t srcLen, unsigned char* dest) noexcept {
+	result res;
+	size_t i = 0;
+
+	while (i < srcLen) {
+#ifdef WL_STR_UTF_SSE2
+		if (sizeof(wchar_t) == 2) { // narrow 16 ASCII code units at once
+			__m128i highMask = _mm_set1_epi16(static_cast<short>(0xFF80));
+			__m128i zero = _mm_setzero_si128();
+			while (i + 16 <= srcLen) {
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+				__m128i nonAscii = _mm_and_si128(_mm_or_si128(a, b), highMask);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, zero)) != 0xFFFF) break;
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + res.written), _mm_packus_epi16(a, b));
+				i += 16;
+				res.written += 16;
+			}
+			if (i == srcLen) break;
+		}
+#endif
+		unsigned long ch = static_cast<unsigned long>(src[i++]) & 0xFFFF;
+		if (ch < 0x80) {
+			dest[res.written++] = static_cast<unsigned char>(ch);
+			continue;
+		} else if (ch < 0x800) {
+			dest[res.written++] = static_cast<unsigned char>(0xC0 | (ch >> 6));
+			dest[res.written++] = static_cast<unsigned char>(0x80 | (ch & 0x3F));
+			continue;
+		} else if (ch >= 0xD800 && ch <= 0xDFFF) {
+			if (ch <= 0xDBFF && i < srcLen && src[i] >= 0xDC00 && src[i] <= 0xDFFF) { // valid surrogate pair
+				unsigned long cp = 0x10000 + ((ch - 0xD800) << 10) + (src[i++] - 0xDC00);
+				dest[res.written++] = static_cast<unsigned char>(0xF0 | (cp >> 18));
+				dest[res.written++] = static_cast<unsigned char>(0x80 | ((cp >> 12) & 0x3F));
+				dest[res.written++] = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+				dest[res.written++] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+				continue;
+			}
+			ch = REPLACEMENT_CHAR; // unpaired surrogate
+			++res.numInvalid;
+		}
+		dest[res.written++] = static_cast<unsigned char>(0xE0 | (ch >> 12));
+		dest[res.written++] = static_cast<unsigned char>(0x80 | ((ch >> 6) & 0x3F));
+		dest[res.written++] = static_cast<unsigned char>(0x80 | (ch & 0x3F));
+	}
+	res.read = srcLen;
+	return res;
+}
+
+// Converts UTF-16 bytes to UTF-16 code units; dest must have room for utf16_max_len_from_utf16(srcLen).
+// Surrogates are copied verbatim; a trailing odd byte becomes U+FFFD.
+inline result utf16_to_utf16(const unsigned char* src, size_t srcLen, bool bigEndian, wchar_t* dest) noexcept {
+	result res;
+	size_t numUnits = srcLen / 2;
+	size_t i = 0;
+
+	if (!bigEndian && sizeof(wchar_t) == 2) {
+		memcpy(dest, src, numUnits * 2); // native byte order, straight copy
+		i = numUnits;
+	}
+#ifdef WL_STR_UTF_SSE2
+	if (bigEndian && sizeof(wchar_t) == 2) {
+		for (; i + 8 <= numUnits; i += 8) { // swap bytes of 8 code units at once
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+				_mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8)));
+		}
+	}
+#endif
+	for (; i < numUnits; ++i) {
+		const unsigned char* pUnit = src + i * 2;
+		dest[i] = static_cast<wchar_t>(bigEndian ?
+			(pUnit[0] << 8) | pUnit[1] :
+			pUnit[0] | (pUnit[1] << 8));
+	}
+
+	res.read = srcLen;
+	res.written = numUnits;
+	if (srcLen % 2) {
+		dest[res.written++] = REPLACEMENT_CHAR;
+		++res.numInvalid;
+	}
+	return res;
+}
+
+// Converts UTF-32 bytes to UTF-16 code units; dest must have room for utf16_max_len_from_utf32(srcLen).
+// Surrogate code points and values above U+10FFFF become U+FFFD, as does a trailing incomplete unit.
+inline result utf32_to_utf16(const unsigned char* src, size_t srcLen, bool bigEndian, wchar_t* dest) noexcept {
+	result res;
+	size_t numUnits = srcLen / 4;
+	size_t i = 0;
+
+	while (i < numUnits) {
+#ifdef WL_STR_UTF_SSE2
+		if (sizeof(wchar_t) == 2) { // 4 code points at once, while all are below the surrogate range
+			__m128i limit = _mm_set1_epi32(0xD800);
+			__m128i minusOne = _mm_set1_epi32(-1);
+			__m128i bias32 = _mm_set1_epi32(0x8000);
+			__m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+			for (; i + 4 <= numUnits; i += 4) {
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+				if (bigEndian) {
+					block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8)); // swap bytes within halves
+					block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, _MM_SHUFFLE(2, 3, 0, 1)),
+						_MM_SHUFFLE(2, 3, 0, 1)); // swap halves
+				}
+				__m128i inRange = _mm_and_si128(_mm_cmpgt_epi32(limit, block), _mm_cmpgt_epi32(block, minusOne));
+				if (_mm_movemask_epi8(inRange) != 0xFFFF) break;
+				__m128i packed = _mm_add_epi16( // packs_epi32 saturates signed, so bias around it
+					_mm_packs_epi32(_mm_sub_epi32(block, bias32), _mm_sub_epi32(block, bias32)), bias16);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(dest + res.written), packed);
+				res.written += 4;
+			}
+			if (i == numUnits) break;
+		}
+#endif
+		const unsigned char* pUnit = src + i++ * 4;
+		unsigned long cp = bigEndian ?
+			(static_cast<unsigned long>(pUnit[0]) << 24) | (pUnit[1] << 16) | (pUnit[2] << 8) | pUnit[3] :
+			(static_cast<unsigned long>(pUnit[3]) << 24) | (pUnit[2] << 16) | (pUnit[1] << 8) | pUnit[0];
+		if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+			dest[res.written++] = REPLACEMENT_CHAR;
+			++res.numInvalid;
+		} else {
+			res.written += put_utf16(static_cast<long>(cp), dest + res.written);
+		}
+	}
+
+	res.read = srcLen;
+	if (srcLen % 4) {
+		dest[res.written++] = REPLACEMENT_CHAR;
+		++res.numInvalid;
+	}
+	return res;
+}
+
+}//namespace str_utf
+}//namespace _wli
+}//namespace wl
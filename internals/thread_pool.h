@@ -0,0 +1,224 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "delegate.h"
+
+namespace wl {
+
+// Priority of a task run by run_thread_detached(); higher ones are started first.
+enum class task_priority { HIGH, NORMAL, LOW };
+
+namespace _wli {
+
+// Work-stealing thread pool, on plain std::thread. Each worker has its own bounded queues, one per
+// priority; idle workers take tasks from the others, and sleep when there's nothing left. Tasks are
+// taken oldest first, so they start in about the order they were submitted. It's meant for short
+// tasks: there's one worker per core, so a task which blocks for long holds a worker all the while.
+class thread_pool final {
+public:
+	using task = delegate<void(), WL_DELEGATE_BUFFER + 4 * sizeof(void*)>; // wraps a default delegate without allocating
+
+private:
+	static const size_t NUM_PRIORITIES = 3;
+
+	struct alignas(64) _worker final { // own cache line, since its mutex is hammered
+		std::mutex          mutex;
+		std::deque<task>    queues[NUM_PRIORITIES];
+		std::atomic<size_t> size{0}; // all priorities; written under the mutex, read without it to skip empty workers
+	};
+
+	struct _current_worker final {
+		const thread_pool* pool = nullptr;
+		size_t             index = 0;
+	};
+
+	std::unique_ptr<_worker[]> _workers;
+	std::vector<std::thread>   _threads;
+	size_t                     _numWorkers = 0, _capacity = 0; // capacity is per worker
+	std::atomic<size_t>        _pending{0};    // tasks submitted and not yet taken, never less than the queued ones
+	std::atomic<size_t>        _nextWorker{0}; // round-robin, for tasks submitted from outside the pool
+	std::atomic<size_t>        _sleeping{0};
+	std::atomic<size_t>        _waiting{0}; // submitters waiting for room in the queues
+	std::atomic<bool>          _stopping{false};
+	std::mutex                 _wakeMutex, _roomMutex;
+	std::condition_variable    _wakeCv, _roomCv;
+
+public:
+	// Waits for all queued tasks to finish.
+	~thread_pool() {
+		this->_stop();
+	}
+
+	// Zero threads means one per core; the queue capacity is per thread.
+	explicit thread_pool(size_t numThreads = 0, size_t queueCapacity = 256) {
+		if (!numThreads) numThreads = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+		this->_numWorkers = numThreads;
+		this->_capacity = std::max<size_t>(queueCapacity, 1);
+		this->_workers.reset(new _worker[numThreads]);
+		this->_threads.reserve(numThreads);
+		for (size_t i = 0; i < numThreads; ++i) {
+			try {
+				this->_threads.emplace_back([this, i]() { this->_run(i); });
+			} catch (const std::system_error&) {
+				if (this->_threads.empty()) throw;
+				break; // out of threads; the queues of the missing ones are emptied by the others
+			}
+		}
+	}
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	// The pool shared by all windows. It's never destroyed: like detached threads, workers
+	// live until the process ends, so a task never waits for a window which is gone.
+	static thread_pool& instance() {
+		static thread_pool* pPool = new thread_pool();
+		return *pPool;
+	}
+
+	size_t num_threads() const noexcept { return this->_threads.size(); }
+	size_t pending() const noexcept { return this->_pending.load(std::memory_order_relaxed); }
+
+	// Queues the task, unless all queues are full, in which case it returns false and the task is untouched.
+	bool try_submit(task& func, task_priority prio = task_priority::NORMAL) {
+		_current_worker& cur = _current();
+		size_t first = (cur.pool == this) ? cur.index // a worker queues on its own, then on the others
+			: this->_nextWorker.fetch_add(1, std::memory_order_relaxed) % this->_numWorkers;
+		for (size_t i = 0; i < this->_numWorkers; ++i) {
+			if (this->_push((first + i) % this->_numWorkers, func, static_cast<size_t>(prio))) return true;
+		}
+		return false;
+	}
+
+	// Queues the task; while all queues are full, waits up to the timeout for a worker to take a task.
+	// Returns false if they stay full, and the task is untouched. Callers which must not block, like
+	// the UI thread, whose tasks may be waiting on it with run_thread_ui(), pass a zero timeout. A
+	// worker of this pool never waits, since the others may be waiting on it: it runs the task itself.
+	bool submit(task&& func, task_priority prio = task_priority::NORMAL,
+		std::chrono::milliseconds timeout = std::chrono::seconds(1))
+	{
+		if (this->try_submit(func, prio)) return true;
+		if (_current().pool == this) {
+			try {
+				func();
+			} catch (...) { } // same as in the workers
+			func = nullptr;
+			return true;
+		}
+		if (timeout <= std::chrono::milliseconds::zero()) return false;
+
+		std::unique_lock<std::mutex> lock{this->_roomMutex};
+		this->_waiting.fetch_add(1); // seq_cst, paired with _pop(), which checks it after making room
+		try {
+			bool queued = this->_roomCv.wait_for(lock, timeout, [&]() { return this->try_submit(func, prio); });
+			this->_waiting.fetch_sub(1);
+			return queued;
+		} catch (...) {
+			this->_waiting.fetch_sub(1);
+			throw;
+		}
+	}
+
+private:
+	static _current_worker& _current() noexcept {
+		thread_local _current_worker cur;
+		return cur;
+	}
+
+	bool _push(size_t w, task& func, size_t prio) {
+		_worker& worker = this->_workers[w];
+		this->_pending.fetch_add(1); // before the task is visible, so it never goes below the queued ones
+		{
+			std::lock_guard<std::mutex> lock{worker.mutex};
+			if (worker.size.load(std::memory_order_relaxed) >= this->_capacity) {
+				this->_pending.fetch_sub(1);
+				return false;
+			}
+			try {
+				worker.queues[prio].emplace_back(std::move(func));
+			} catch (...) {
+				this->_pending.fetch_sub(1);
+				throw;
+			}
+			worker.size.fetch_add(1, std::memory_order_relaxed);
+		}
+		if (this->_sleeping.load()) { // seq_cst, paired with the sleeper, which checks _pending after counting itself
+			{ std::lock_guard<std::mutex> lock{this->_wakeMutex}; } // sleeper is either before its check or waiting
+			this->_wakeCv.notify_one();
+		}
+		return true;
+	}
+
+	bool _pop(size_t self, task& func) {
+		for (size_t prio = 0; prio < NUM_PRIORITIES; ++prio) {
+			for (size_t i = 0; i < this->_numWorkers; ++i) { // own queue first, then steal
+				_worker& worker = this->_workers[(self + i) % this->_numWorkers];
+				if (!worker.size.load(std::memory_order_relaxed)) continue;
+				{
+					std::lock_guard<std::mutex> lock{worker.mutex};
+					std::deque<task>& queue = worker.queues[prio];
+					if (queue.empty()) continue;
+					func = std::move(queue.front());
+					queue.pop_front();
+					worker.size.fetch_sub(1, std::memory_order_relaxed);
+					this->_pending.fetch_sub(1);
+				}
+				if (this->_waiting.load()) { // a submitter checks the queues after counting itself, holding the mutex
+					{ std::lock_guard<std::mutex> lock{this->_roomMutex}; } // so it's either before its check or waiting
+					this->_roomCv.notify_one();
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void _run(size_t self) {
+		_current() = {this, self};
+		task func;
+		for (;;) {
+			if (this->_pop(self, func)) {
+				try {
+					func();
+				} catch (...) { } // tasks must handle their exceptions, like those of base_thread, which forward them to the window
+				func = nullptr; // release the captures now, not when the next task comes
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock{this->_wakeMutex};
+			this->_sleeping.fetch_add(1);
+			this->_wakeCv.wait(lock, [this]() {
+				return this->_pending.load() || this->_stopping.load();
+			});
+			this->_sleeping.fetch_sub(1);
+			if (this->_stopping.load() && !this->_pending.load()) return; // queues drained
+		}
+	}
+
+	void _stop() noexcept {
+		{
+			std::lock_guard<std::mutex> lock{this->_wakeMutex};
+			this->_stopping.store(true);
+		}
+		this->_wakeCv.notify_all();
+		for (std::thread& t : this->_threads) t.join();
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,174 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "thread_pool.h"
+
+namespace wl {
+namespace _wli {
+
+// Work-stealing backend of the parallel vector algorithms, whose helpers run on the shared thread pool.
+namespace vec_parallel {
+
+// How a range is split: the defaults are resolved here.
+struct plan final {
+	size_t count;      // elements
+	size_t numThreads; // never more than the chunks
+	size_t grainSize;  // elements per chunk
+	size_t numChunks;
+
+	plan(size_t count, size_t numThreads, size_t grainSize) noexcept : count{count} {
+		const size_t CHUNKS_PER_THREAD = 8, MIN_GRAIN = 1024; // enough chunks to balance, not so small they cost more than they do
+		if (!numThreads) numThreads = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+		if (!grainSize) grainSize = std::max(count / (numThreads * CHUNKS_PER_THREAD), MIN_GRAIN);
+		this->grainSize = std::max<size_t>(grainSize, count / 0xFFFFFFFFull + 1); // chunk indexes must fit 32 bits
+		this->numChunks = (count + this->grainSize - 1) / this->grainSize;
+		this->numThreads = std::min(numThreads, this->numChunks);
+	}
+};
+
+// Each thread owns a range of chunk indexes, packed in a single atomic, begin in the high half.
+// The owner takes chunks from the front; an idle thread steals the back half of another range.
+struct alignas(64) chunk_queue final { // own cache line, since it's hammered by its owner
+	std::atomic<unsigned long long> range{0};
+
+	static unsigned long long pack(size_t begin, size_t end) noexcept {
+		return (static_cast<unsigned long long>(begin) << 32) | end;
+	}
+
+	bool pop_front(size_t& chunk) noexcept {
+		unsigned long long r = this->range.load(std::memory_order_relaxed);
+		for (;;) {
+			size_t b = static_cast<size_t>(r >> 32), e = static_cast<size_t>(r & 0xFFFFFFFF);
+			if (b >= e) return false;
+			if (this->range.compare_exchange_weak(r, pack(b + 1, e), std::memory_order_acquire, std::memory_order_relaxed)) {
+				chunk = b;
+				return true;
+			}
+		}
+	}
+
+	bool steal_back_half(size_t& begin, size_t& end) noexcept {
+		unsigned long long r = this->range.load(std::memory_order_relaxed);
+		for (;;) {
+			size_t b = static_cast<size_t>(r >> 32), e = static_cast<size_t>(r & 0xFFFFFFFF);
+			if (b >= e) return false;
+			size_t mid = e - (e - b + 1) / 2;
+			if (this->range.compare_exchange_weak(r, pack(b, mid), std::memory_order_acquire, std::memory_order_relaxed)) {
+				begin = mid;
+				end = e;
+				return true;
+			}
+		}
+	}
+};
+
+// Lets the helper tasks into a run only while it's open. The caller closes it when there's nothing
+// left to take, then waits only for the helpers already inside; those not started yet, because the
+// pool is busy, just return later. It's shared with the tasks, so it outlives the run.
+struct helper_gate final {
+	std::mutex              mutex;
+	std::condition_variable cv;
+	size_t                  nextThread = 1, numThreads = 0, active = 0;
+	bool                    closed = false;
+	void                    (*work)(void*, size_t) = nullptr; // runs the worker of the given thread index
+	void*                   ctx = nullptr;
+
+	void enter_and_work() {
+		size_t t = 0;
+		{
+			std::lock_guard<std::mutex> lock{this->mutex};
+			if (this->closed || this->nextThread >= this->numThreads) return;
+			t = this->nextThread++;
+			++this->active;
+		}
+		this->work(this->ctx, t);
+		{
+			std::lock_guard<std::mutex> lock{this->mutex};
+			--this->active;
+		}
+		this->cv.notify_all();
+	}
+
+	void close_and_wait() {
+		std::unique_lock<std::mutex> lock{this->mutex};
+		this->closed = true;
+		this->cv.wait(lock, [this]() { return !this->active; });
+	}
+};
+
+// Runs func(chunkIndex, begin, end) on all chunks of the plan; the calling thread works too.
+// The first exception thrown by func cancels the chunks not yet started, and is rethrown here.
+template<typename funcT>
+inline void run(const plan& p, funcT&& func) {
+	if (p.numThreads <= 1) {
+		for (size_t c = 0; c < p.numChunks; ++c) {
+			func(c, c * p.grainSize, std::min(p.count, (c + 1) * p.grainSize));
+		}
+		return;
+	}
+
+	std::unique_ptr<chunk_queue[]> queues{new chunk_queue[p.numThreads]};
+	for (size_t t = 0; t < p.numThreads; ++t) {
+		queues[t].range.store(chunk_queue::pack(p.numChunks * t / p.numThreads, p.numChunks * (t + 1) / p.numThreads),
+			std::memory_order_relaxed);
+	}
+	std::atomic<bool> cancelled{false};
+	std::exception_ptr firstError;
+	std::mutex errorMutex;
+
+	auto worker = [&](size_t t) {
+		chunk_queue& own = queues[t];
+		for (;;) {
+			size_t c = 0;
+			if (!own.pop_front(c)) {
+				bool stole = false; // own range is empty, so only this thread can refill it
+				for (size_t i = 1; i < p.numThreads && !stole; ++i) {
+					size_t b = 0, e = 0;
+					if (queues[(t + i) % p.numThreads].steal_back_half(b, e)) {
+						own.range.store(chunk_queue::pack(b, e), std::memory_order_release);
+						stole = true;
+					}
+				}
+				if (!stole) return; // chunks still running elsewhere can't be split anymore
+				continue;
+			}
+			if (cancelled.load(std::memory_order_relaxed)) return;
+			try {
+				func(c, c * p.grainSize, std::min(p.count, (c + 1) * p.grainSize));
+			} catch (...) {
+				std::lock_guard<std::mutex> lock{errorMutex};
+				if (!firstError) firstError = std::current_exception();
+				cancelled.store(true, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	std::shared_ptr<helper_gate> gate = std::make_shared<helper_gate>();
+	gate->numThreads = p.numThreads;
+	gate->work = [](void* ctx, size_t t) { (*static_cast<decltype(worker)*>(ctx))(t); };
+	gate->ctx = &worker;
+	thread_pool& pool = thread_pool::instance();
+	for (size_t t = 1; t < p.numThreads; ++t) {
+		thread_pool::task helper = [gate]() { gate->enter_and_work(); };
+		if (!pool.try_submit(helper, task_priority::HIGH)) break; // pool is full; the chunks of the missing ones will be stolen
+	}
+	worker(0); // never waits for a helper to start, so it can't deadlock when called from a pool task
+	gate->close_and_wait();
+	if (firstError) std::rethrow_exception(firstError);
+}
+
+}//namespace vec_parallel
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,325 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "internals/str_case.h"
+
+namespace wl {
+
+// Case-insensitive search index over many strings, for "type to filter" lists.
+// Strings are case-folded once, and indexed by their 2- and 3-char grams, so prefix and
+// substring queries only verify a few candidates; single-char and fuzzy queries only verify
+// the strings which have all the query chars, from a list of the strings with each char.
+// Strings can be added and removed at any time.
+class search_index final {
+public:
+	enum class match {
+		PREFIX,    // string begins with the query
+		SUBSTRING, // string contains the query
+		FUZZY      // string contains the query chars in order, not necessarily together
+	};
+
+	struct result final {
+		size_t id;
+		int    score; // higher is better
+	};
+
+private:
+	struct _item final {
+		size_t start, len; // folded string in _folded
+		size_t id;
+		bool   alive;
+	};
+
+	static const unsigned long long START_GRAM = 1ull << 63; // flags the grams of the beginning of a string
+
+	std::vector<_item> _items; // removed items are dead until the next compaction, so slots only grow
+	std::vector<unsigned long long> _charMasks; // for each slot, a bit for each char the string has
+	std::wstring       _folded; // all folded strings, in slot order, so scanning candidates reads memory in sequence
+	std::unordered_map<size_t, unsigned> _slotOfId;
+	std::unordered_map<unsigned long long, std::vector<unsigned>> _postings; // gram -> sorted slots
+	std::unordered_map<wchar_t, std::vector<unsigned>> _charPostings; // char anywhere -> sorted slots
+	size_t _numDead = 0;
+
+public:
+	search_index() = default;
+
+	// Indexes the strings, with their positions as ids.
+	explicit search_index(const std::vector<std::wstring>& strs) {
+		this->_items.reserve(strs.size());
+		for (size_t i = 0; i < strs.size(); ++i) this->add(i, strs[i]);
+	}
+
+	size_t size() const noexcept { return this->_slotOfId.size(); }
+	bool   empty() const noexcept { return this->_slotOfId.empty(); }
+	bool   has(size_t id) const   { return this->_slotOfId.find(id) != this->_slotOfId.end(); }
+
+	search_index& clear() noexcept {
+		this->_items.clear();
+		this->_charMasks.clear();
+		this->_folded.clear();
+		this->_slotOfId.clear();
+		this->_postings.clear();
+		this->_charPostings.clear();
+		this->_numDead = 0;
+		return *this;
+	}
+
+	// Adds a string with the given id; if the id already exists, its string is replaced.
+	search_index& add(size_t id, std::wstring_view s) {
+		this->remove(id);
+		_item item{this->_folded.length(), s.length(), id, true};
+		this->_folded.resize(item.start + item.len);
+		_wli::str_case::map_chars<_wli::str_case::mapping::FOLD>(s.data(), s.length(), &this->_folded[item.start]);
+		unsigned slot = static_cast<unsigned>(this->_items.size());
+		this->_index_item(this->_folded_of(item), slot);
+		this->_items.emplace_back(item);
+		this->_slotOfId.emplace(id, slot);
+		return *this;
+	}
+
+	// Removes the string with the given id, if any.
+	search_index& remove(size_t id) {
+		auto found = this->_slotOfId.find(id);
+		if (found == this->_slotOfId.end()) return *this;
+		this->_items[found->second].alive = false;
+		this->_slotOfId.erase(found);
+		if (++this->_numDead > 1024 && this->_numDead > this->_items.size() / 2) this->_compact();
+		return *this;
+	}
+
+	// Returns the matches ranked by score, best first; equal scores go by id.
+	std::vector<result> find(std::wstring_view query, match how, size_t maxResults = static_cast<size_t>(-1)) const {
+		std::wstring q = _fold(query);
+		std::vector<result> results;
+		if (q.empty()) {
+			for (const _item& item : this->_items) {
+				if (item.alive) results.push_back({item.id, 0});
+			}
+		} else {
+			this->_for_each_candidate(q, how, [&](const _item& item) {
+				int score = _score(this->_folded_of(item), q, how);
+				if (score > 0) results.push_back({item.id, score});
+			});
+		}
+		return _rank(std::move(results), maxResults);
+	}
+
+	// Like find(), but only checks the previous results, which is much faster while the user types.
+	// The query must extend the one which gave the previous results, and these must not be truncated.
+	std::vector<result> refine(const std::vector<result>& previous, std::wstring_view query,
+		match how, size_t maxResults = static_cast<size_t>(-1)) const
+	{
+		std::wstring q = _fold(query);
+		std::vector<result> results;
+		for (const result& prev : previous) {
+			auto found = this->_slotOfId.find(prev.id);
+			if (found == this->_slotOfId.end()) continue; // removed meanwhile
+			int score = q.empty() ? 0 : _score(this->_folded_of(this->_items[found->second]), q, how);
+			if (q.empty() || score > 0) results.push_back({prev.id, score});
+		}
+		return _rank(std::move(results), maxResults);
+	}
+
+	// Returns only the ids of the matches, best first.
+	std::vector<size_t> find_ids(std::wstring_view query, match how, size_t maxResults = static_cast<size_t>(-1)) const {
+		std::vector<size_t> ids;
+		for (const result& r : this->find(query, how, maxResults)) ids.emplace_back(r.id);
+		return ids;
+	}
+
+private:
+	static std::wstring _fold(std::wstring_view s) {
+		std::wstring folded(s.length(), L'\0');
+		_wli::str_case::map_chars<_wli::str_case::mapping::FOLD>(s.data(), s.length(), &folded[0]);
+		return folded;
+	}
+
+	static unsigned long long _gram(const wchar_t* p, size_t len) noexcept {
+		unsigned long long g = 0;
+		for (size_t i = 0; i < 3; ++i) { // 21 bits per char, enough for any code point
+			g = (g << 21) | (i < len ? (static_cast<unsigned long long>(p[i]) & 0x1FFFFF) : 0);
+		}
+		return g;
+	}
+
+	static std::vector<unsigned long long> _grams_of(std::wstring_view s) {
+		std::vector<unsigned long long> grams;
+		for (size_t len = 1; len <= 3 && len <= s.length(); ++len) {
+			grams.emplace_back(_gram(s.data(), len) | START_GRAM);
+		}
+		for (size_t i = 0; i + 2 <= s.length(); ++i) {
+			grams.emplace_back(_gram(s.data() + i, 2));
+			if (i + 3 <= s.length()) grams.emplace_back(_gram(s.data() + i, 3));
+		}
+		std::sort(grams.begin(), grams.end());
+		grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+		return grams;
+	}
+
+	template<typename funcT>
+	void _for_each_candidate(const std::wstring& q, match how, funcT&& func) const {
+		std::vector<const std::vector<unsigned>*> lists;
+		if (how == match::PREFIX) {
+			lists.emplace_back(this->_postings_of(_gram(q.data(), std::min<size_t>(q.length(), 3)) | START_GRAM));
+		} else if (how == match::SUBSTRING && q.length() == 2) {
+			lists.emplace_back(this->_postings_of(_gram(q.data(), 2)));
+		} else if (how == match::SUBSTRING && q.length() >= 3) {
+			for (size_t i = 0; i + 3 <= q.length(); ++i) {
+				lists.emplace_back(this->_postings_of(_gram(q.data() + i, 3)));
+			}
+		}
+
+		if (lists.empty()) { // single char or fuzzy: strings with the rarest query char, whose masks have all the others
+			const std::vector<unsigned>* rarest = nullptr;
+			unsigned long long qMask = 0;
+			for (wchar_t ch : q) {
+				auto found = this->_charPostings.find(ch);
+				if (found == this->_charPostings.end()) return; // some char is nowhere
+				if (!rarest || found->second.size() < rarest->size()) rarest = &found->second;
+				qMask |= _char_bit(ch);
+			}
+			for (unsigned slot : *rarest) {
+				if ((this->_charMasks[slot] & qMask) == qMask && this->_items[slot].alive) func(this->_items[slot]);
+			}
+			return;
+		}
+
+		for (const std::vector<unsigned>* list : lists) {
+			if (!list) return; // some gram is nowhere
+		}
+		std::sort(lists.begin(), lists.end(),
+			[](const std::vector<unsigned>* a, const std::vector<unsigned>* b) noexcept { return a->size() < b->size(); });
+		if (lists.size() == 1) { // no intersection, no copy
+			for (unsigned slot : *lists[0]) {
+				if (this->_items[slot].alive) func(this->_items[slot]);
+			}
+			return;
+		}
+		std::vector<unsigned> cands = *lists[0], tmp;
+		for (size_t i = 1; i < lists.size() && i < 4 && cands.size() > 16; ++i) { // a few intersections are enough
+			tmp.clear();
+			std::set_intersection(cands.begin(), cands.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(tmp));
+			cands.swap(tmp);
+		}
+		for (unsigned slot : cands) {
+			if (this->_items[slot].alive) func(this->_items[slot]);
+		}
+	}
+
+	std::wstring_view _folded_of(const _item& item) const noexcept {
+		return {this->_folded.data() + item.start, item.len};
+	}
+
+	// Distinct for ASCII letters and digits, shared by other chars.
+	static unsigned long long _char_bit(wchar_t ch) noexcept {
+		unsigned c = static_cast<unsigned>(ch);
+		return 1ull << ((c - L'a' < 26) ? c - L'a' : (c - L'0' < 10) ? 26 + c - L'0' : 36 + c % 28);
+	}
+
+	void _index_item(std::wstring_view folded, unsigned slot) {
+		for (unsigned long long gram : _grams_of(folded)) this->_postings[gram].emplace_back(slot); // slots only grow, so lists stay sorted
+		std::wstring chars{folded};
+		std::sort(chars.begin(), chars.end());
+		chars.erase(std::unique(chars.begin(), chars.end()), chars.end());
+		unsigned long long mask = 0;
+		for (wchar_t ch : chars) {
+			this->_charPostings[ch].emplace_back(slot);
+			mask |= _char_bit(ch);
+		}
+		this->_charMasks.emplace_back(mask);
+	}
+
+	const std::vector<unsigned>* _postings_of(unsigned long long gram) const {
+		auto found = this->_postings.find(gram);
+		return (found == this->_postings.end()) ? nullptr : &found->second;
+	}
+
+	static bool _is_word_start(std::wstring_view s, size_t pos) noexcept {
+		if (!pos) return true;
+		wchar_t prev = s[pos - 1];
+		return prev == L' ' || prev == L'_' || prev == L'-' || prev == L'.'
+			|| prev == L'/' || prev == L'\\' || prev == L'(' || prev == L'[';
+	}
+
+	// Zero if it doesn't match. Contiguous matches always rank above scattered ones;
+	// then earlier, at a word start, and in shorter strings is better.
+	static int _score(std::wstring_view s, std::wstring_view q, match how) noexcept {
+		int extraLen = static_cast<int>(std::min<size_t>(s.length() - std::min(s.length(), q.length()), 100));
+		if (how == match::FUZZY && q.length() > 1) { // for a single char, it's the same as a substring
+			int fuzzyScore = _fuzzy_score(s, q); // contiguous matches are also subsequences, so most strings end here
+			if (!fuzzyScore) return 0;
+			size_t pos = s.find(q);
+			return (pos == std::wstring_view::npos) ? std::max(fuzzyScore - extraLen, 1) : _contiguous_score(s, pos, extraLen);
+		}
+		size_t pos = (how == match::PREFIX)
+			? (s.compare(0, q.length(), q) ? std::wstring_view::npos : 0)
+			: s.find(q);
+		return (pos == std::wstring_view::npos) ? 0 : _contiguous_score(s, pos, extraLen);
+	}
+
+	static int _contiguous_score(std::wstring_view s, size_t pos, int extraLen) noexcept {
+		return 2000 - static_cast<int>(std::min<size_t>(pos, 50)) * 10
+			+ (_is_word_start(s, pos) ? 200 : 0) - extraLen;
+	}
+
+	// Zero if the query chars aren't in the string in order.
+	static int _fuzzy_score(std::wstring_view s, std::wstring_view q) noexcept {
+		int score = 1000;
+		size_t prevMatch = std::wstring_view::npos, qi = 0;
+		for (size_t si = 0; si < s.length() && qi < q.length(); ++si) {
+			if (s[si] != q[qi]) continue;
+			if (_is_word_start(s, si)) score += 16;
+			if (prevMatch != std::wstring_view::npos) {
+				score += (si == prevMatch + 1) ? 8 : -static_cast<int>(std::min<size_t>(si - prevMatch - 1, 8));
+			} else {
+				score -= static_cast<int>(std::min<size_t>(si, 20));
+			}
+			prevMatch = si;
+			++qi;
+		}
+		return (qi < q.length()) ? 0 : std::max(score, 1);
+	}
+
+	static std::vector<result> _rank(std::vector<result>&& results, size_t maxResults) {
+		auto better = [](const result& a, const result& b) noexcept {
+			return a.score > b.score || (a.score == b.score && a.id < b.id);
+		};
+		if (maxResults < results.size()) {
+			std::partial_sort(results.begin(), results.begin() + maxResults, results.end(), better);
+			results.resize(maxResults);
+		} else {
+			std::sort(results.begin(), results.end(), better);
+		}
+		return std::move(results);
+	}
+
+	void _compact() {
+		std::vector<_item> items;
+		std::wstring folded;
+		items.swap(this->_items);
+		folded.swap(this->_folded);
+		this->clear();
+		for (_item& item : items) {
+			if (!item.alive) continue;
+			unsigned slot = static_cast<unsigned>(this->_items.size());
+			size_t start = this->_folded.length();
+			this->_folded.append(folded, item.start, item.len);
+			item.start = start;
+			this->_index_item(this->_folded_of(item), slot);
+			this->_slotOfId.emplace(item.id, slot);
+			this->_items.emplace_back(item);
+		}
+	}
+};
+
+}//namespace wl
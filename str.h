@@ -6,9 +6,19 @@
  */
 
 #pragma once
+#include <initializer_list>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
 #include <vector>
+#include "internals/enable_bitmask_operators.h"
+#include "internals/str_format.h"
+#include "internals/str_multi_search.h"
+#include "internals/str_parse.h"
 #include "internals/str_priv.h"
+#include "internals/str_search.h"
+#include "internals/str_sort.h"
+#include "internals/str_tokens.h"
 
 namespace wl {
 
@@ -63,15 +73,50 @@ inline std::wstring& trim(std::wstring& s) {
 // Type-safe sprintf.
 template<typename ...argsT>
 inline std::wstring format(const wchar_t* strFormat, const argsT&... args) {
-	return _wli::str_priv::format_raw(lstrlenW(strFormat), strFormat, 
-		std::forward<const argsT&>(args)...);
+	size_t fmtLen = lstrlenW(strFormat);
+	std::wstring ret;
+	ret.reserve(fmtLen + sizeof...(args) * 8); // arbitrary guess, output is written in a single pass
+	_wli::str_format::wstring_sink sink{ret};
+	_wli::str_format::format(sink, strFormat, fmtLen, args...);
+	return ret;
 }
 
 // Type-safe sprintf.
 template<typename ...argsT>
 inline std::wstring format(const std::wstring& strFormat, const argsT&... args) {
-	return _wli::str_priv::format_raw(strFormat.length(), strFormat.c_str(),
-		std::forward<const argsT&>(args)...);
+	std::wstring ret;
+	ret.reserve(strFormat.length() + sizeof...(args) * 8);
+	_wli::str_format::wstring_sink sink{ret};
+	_wli::str_format::format(sink, strFormat.c_str(), strFormat.length(), args...);
+	return ret;
+}
+
+// Type-safe sprintf, appending to an existing string, which keeps its allocated buffer.
+template<typename ...argsT>
+inline std::wstring& format_append(std::wstring& s, const wchar_t* strFormat, const argsT&... args) {
+	_wli::str_format::wstring_sink sink{s};
+	_wli::str_format::format(sink, strFormat, lstrlenW(strFormat), args...);
+	return s;
+}
+
+// Type-safe sprintf into a fixed buffer, without allocations; output is truncated if needed, and always null-terminated.
+// Returns the length of the whole formatted text; if it's not less than bufLen, output was truncated.
+// With a null buf or zero bufLen nothing is written, and the required length is returned, like snprintf.
+template<typename ...argsT>
+inline size_t format_to(wchar_t* buf, size_t bufLen, const wchar_t* strFormat, const argsT&... args) {
+	// wchar_t buf[64];
+	// str::format_to(buf, ARRAYSIZE(buf), L"%d items", count);
+	if (!buf) bufLen = 0;
+	_wli::str_format::buffer_sink sink{buf, bufLen}; // zero capacity never writes, just counts
+	_wli::str_format::format(sink, strFormat, lstrlenW(strFormat), args...);
+	if (bufLen) sink.terminate();
+	return sink.length();
+}
+
+// Number of arguments consumed by a format string, can be checked at compile time.
+constexpr size_t format_arg_count(const wchar_t* strFormat) noexcept {
+	// static_assert(str::format_arg_count(L"%s has %d items") == 2, "Wrong format string.");
+	return _wli::str_format::count_args(strFormat);
 }
 
 // Compares two strings, case insensitive.
@@ -120,20 +165,60 @@ inline bool begins_withi(const std::wstring& s, const wchar_t* what) noexcept {
 	return !_wcsnicmp(s.c_str(), what, whatLen);
 }
 
-// Returns a new string converted to uppercase.
-inline std::wstring upper(const std::wstring& s) {
-	std::wstring ret = s;
-	CharUpperBuffW(&ret[0], static_cast<DWORD>(ret.length()));
+// Returns a new string converted to uppercase, with simple Unicode mappings; no Win32 calls.
+inline std::wstring upper(std::wstring_view s) {
+	std::wstring ret(s.length(), L'\0');
+	_wli::str_case::map_chars<_wli::str_case::mapping::UPPER>(s.data(), s.length(), &ret[0]);
 	return ret;
 }
 
-// Returns a new string converted to lowercase.
-inline std::wstring lower(const std::wstring& s) {
-	std::wstring ret = s;
-	CharLowerBuffW(&ret[0], static_cast<DWORD>(ret.length()));
+// Converts to uppercase, in-place.
+inline std::wstring& upper_in_place(std::wstring& s) noexcept {
+	_wli::str_case::map_chars<_wli::str_case::mapping::UPPER>(s.data(), s.length(), &s[0]);
+	return s;
+}
+
+// Writes the uppercase string into dest, which must have room for s.length() chars, and may be s itself.
+inline void upper_to(std::wstring_view s, wchar_t* dest) noexcept {
+	_wli::str_case::map_chars<_wli::str_case::mapping::UPPER>(s.data(), s.length(), dest);
+}
+
+// Returns a new string converted to lowercase, with simple Unicode mappings; no Win32 calls.
+inline std::wstring lower(std::wstring_view s) {
+	std::wstring ret(s.length(), L'\0');
+	_wli::str_case::map_chars<_wli::str_case::mapping::LOWER>(s.data(), s.length(), &ret[0]);
+	return ret;
+}
+
+// Converts to lowercase, in-place.
+inline std::wstring& lower_in_place(std::wstring& s) noexcept {
+	_wli::str_case::map_chars<_wli::str_case::mapping::LOWER>(s.data(), s.length(), &s[0]);
+	return s;
+}
+
+// Writes the lowercase string into dest, which must have room for s.length() chars, and may be s itself.
+inline void lower_to(std::wstring_view s, wchar_t* dest) noexcept {
+	_wli::str_case::map_chars<_wli::str_case::mapping::LOWER>(s.data(), s.length(), dest);
+}
+
+// Returns a new string with Unicode simple case folding, suited for case-insensitive keys and comparisons.
+inline std::wstring casefold(std::wstring_view s) {
+	std::wstring ret(s.length(), L'\0');
+	_wli::str_case::map_chars<_wli::str_case::mapping::FOLD>(s.data(), s.length(), &ret[0]);
 	return ret;
 }
 
+// Applies Unicode simple case folding, in-place.
+inline std::wstring& casefold_in_place(std::wstring& s) noexcept {
+	_wli::str_case::map_chars<_wli::str_case::mapping::FOLD>(s.data(), s.length(), &s[0]);
+	return s;
+}
+
+// Writes the case folded string into dest, which must have room for s.length() chars, and may be s itself.
+inline void casefold_to(std::wstring_view s, wchar_t* dest) noexcept {
+	_wli::str_case::map_chars<_wli::str_case::mapping::FOLD>(s.data(), s.length(), dest);
+}
+
 // Reverses the string, in-place.
 inline std::wstring& reverse(std::wstring& s) noexcept {
 	size_t lim = (s.length() - (s.length() % 2)) / 2;
@@ -146,49 +231,118 @@ inline std::wstring& reverse(std::wstring& s) noexcept {
 // Reverses the string, in-place.
 inline std::wstring reverse(const wchar_t* s) {
 	std::wstring ret = s;
-	return reverse(s);
+	return reverse(ret);
 }
 
-// Simple diacritics removal, in-place.
+// Removes diacritics from letters of any script, keeping the base letter, in-place.
 inline std::wstring& remove_diacritics(std::wstring& s) noexcept {
-	const wchar_t* diacritics   = L"ÁáÀàÃãÂâÄäÉéÈèÊêËëÍíÌìÎîÏïÓóÒòÕõÔôÖöÚúÙùÛûÜüÇçÅåÐðÑñØøÝý";
-	const wchar_t* replacements = L"AaAaAaAaAaEeEeEeEeIiIiIiIiOoOoOoOoOoUuUuUuUuCcAaDdNnOoYy";
-	for (wchar_t& ch : s) {
-		const wchar_t* pDiac = diacritics;
-		const wchar_t* pRepl = replacements;
-		while (*pDiac) {
-			if (ch == *pDiac) ch = *pRepl; // in-place replacement
-			++pDiac;
-			++pRepl;
-		}
-	}
+	// L"Crème brûlée, Øresund, ǖ" -> L"Creme brulee, Oresund, u"
+	_wli::str_case::map_chars<_wli::str_case::mapping::STRIP>(s.data(), s.length(), &s[0]);
 	return s;
 }
 
+// Writes the string without diacritics into dest, which must have room for s.length() chars, and may be s itself.
+inline void remove_diacritics_to(std::wstring_view s, wchar_t* dest) noexcept {
+	_wli::str_case::map_chars<_wli::str_case::mapping::STRIP>(s.data(), s.length(), dest);
+}
+
+// Precompiled case-insensitive substring searcher, built once and reused for any number of haystacks.
+class finderi final {
+private:
+	_wli::str_search _search;
+
+public:
+	// Forward iterator over the indexes of non-overlapping matches.
+	class match_iterator final {
+	private:
+		const _wli::str_search* _search = nullptr;
+		const wchar_t*          _hay = nullptr;
+		size_t                  _hayLen = 0, _pos = std::wstring::npos;
+
+	public:
+		match_iterator() = default;
+		match_iterator(const _wli::str_search& search, const wchar_t* hay, size_t hayLen) noexcept :
+			_search{&search}, _hay{hay}, _hayLen{hayLen}, _pos{search.find(hay, hayLen)} { }
+
+		size_t          operator*() const noexcept { return this->_pos; }
+		bool            operator==(const match_iterator& other) const noexcept { return this->_pos == other._pos; }
+		bool            operator!=(const match_iterator& other) const noexcept { return !this->operator==(other); }
+		match_iterator& operator++() noexcept {
+			size_t step = this->_search->length() ? this->_search->length() : 1; // empty needle matches everywhere
+			this->_pos = this->_search->find(this->_hay, this->_hayLen, this->_pos + step);
+			return *this;
+		}
+		match_iterator  operator++(int) noexcept { match_iterator tmp = *this; this->operator++(); return tmp; }
+	};
+
+	// Lazy range of match indexes; the search advances only as the range is iterated.
+	class match_range final {
+	private:
+		match_iterator _first;
+	public:
+		explicit match_range(match_iterator first) noexcept : _first{first} { }
+		match_iterator begin() const noexcept { return this->_first; }
+		match_iterator end() const noexcept   { return {}; }
+	};
+
+	finderi() = default;
+	explicit finderi(const wchar_t* needle) : _search{needle, static_cast<size_t>(lstrlenW(needle))} { }
+	explicit finderi(const std::wstring& needle) : _search{needle.c_str(), needle.length()} { }
+
+	// Length of the needle.
+	size_t length() const noexcept { return this->_search.length(); }
+
+	// Finds index of the needle within the buffer, or npos.
+	size_t find(const wchar_t* haystack, size_t haystackLen, size_t offset = 0) const noexcept {
+		return this->_search.find(haystack, haystackLen, offset);
+	}
+
+	// Finds index of the needle within the string, or npos.
+	size_t find(const std::wstring& haystack, size_t offset = 0) const noexcept {
+		return this->_search.find(haystack.c_str(), haystack.length(), offset);
+	}
+
+	// Finds index of the last needle which begins at or before offset, or npos.
+	size_t rfind(const wchar_t* haystack, size_t haystackLen, size_t offset = std::wstring::npos) const noexcept {
+		return this->_search.rfind(haystack, haystackLen, offset);
+	}
+
+	// Finds index of the last needle which begins at or before offset, or npos.
+	size_t rfind(const std::wstring& haystack, size_t offset = std::wstring::npos) const noexcept {
+		return this->_search.rfind(haystack.c_str(), haystack.length(), offset);
+	}
+
+	// Returns a lazy range with the indexes of all non-overlapping matches.
+	match_range find_all(const wchar_t* haystack, size_t haystackLen) const noexcept {
+		return match_range{match_iterator{this->_search, haystack, haystackLen}};
+	}
+
+	// Returns a lazy range with the indexes of all non-overlapping matches.
+	match_range find_all(const std::wstring& haystack) const noexcept {
+		// The string must outlive the range.
+		// for (size_t idx : str::finderi(L"abc").find_all(text)) { ... }
+		return this->find_all(haystack.c_str(), haystack.length());
+	}
+};
+
 // Finds index of substring within string, case insensitive.
 inline size_t findi(const std::wstring& haystack, const wchar_t* needle, size_t offset = 0) {
-	std::wstring haystack2 = upper(haystack);
-	std::wstring needle2 = needle;
-	CharUpperBuffW(&needle2[0], static_cast<DWORD>(needle2.length()));
-	return haystack2.find(needle2, offset);
+	return finderi{needle}.find(haystack, offset);
 }
 
 // Finds index of substring within string, case insensitive.
 inline size_t findi(const std::wstring& haystack, const std::wstring& needle, size_t offset = 0) {
-	return findi(haystack, needle.c_str(), offset);
+	return finderi{needle}.find(haystack, offset);
 }
 
 // Finds index of substring within string, case insensitive, reverse search.
-inline size_t rfindi(const std::wstring& haystack, const wchar_t* needle, size_t offset = 0) {
-	std::wstring haystack2 = upper(haystack);
-	std::wstring needle2 = needle;
-	CharUpperBuffW(&needle2[0], static_cast<DWORD>(needle2.length()));
-	return haystack2.rfind(needle2, offset);
+inline size_t rfindi(const std::wstring& haystack, const wchar_t* needle, size_t offset = std::wstring::npos) {
+	return finderi{needle}.rfind(haystack, offset);
 }
 
 // Finds index of substring within string, case insensitive, reverse search.
-inline size_t rfindi(const std::wstring& haystack, const std::wstring& needle, size_t offset = 0) {
-	return rfindi(haystack, needle, offset);
+inline size_t rfindi(const std::wstring& haystack, const std::wstring& needle, size_t offset = std::wstring::npos) {
+	return finderi{needle}.rfind(haystack, offset);
 }
 
 // Finds all occurrences of a substring, case sensitive, and replaces them all, in-place.
@@ -218,29 +372,141 @@ inline std::wstring& replace(std::wstring& haystack, const std::wstring& needle,
 inline std::wstring& replacei(std::wstring& haystack, const std::wstring& needle, const std::wstring& replacement) {
 	if (haystack.empty() || needle.empty()) return haystack;
 
-	std::wstring haystackU = upper(haystack);
-	std::wstring needleU = upper(needle);
-
+	finderi finder{needle};
 	std::wstring output;
 	size_t base = 0;
-	size_t found = 0;
-
-	for (;;) {
-		found = haystackU.find(needleU, found);
-		output.insert(output.length(), haystack, base, found - base);
-		if (found != std::wstring::npos) {
-			output.append(replacement);
-			base = found = found + needle.length();
-		} else {
-			break;
-		}
+	for (size_t found : finder.find_all(haystack)) { // no uppercase copies of the haystack
+		if (output.empty()) output.reserve(haystack.length());
+		output.append(haystack, base, found - base)
+			.append(replacement);
+		base = found + needle.length();
 	}
+	if (!base) return haystack; // nothing found
 
+	output.append(haystack, base, std::wstring::npos);
 	haystack.swap(output); // behaves like an in-place operation
 	return haystack;
 }
 
-// Does the string represent a signed int?
+// Whether letter case is ignored when matching.
+enum class ignore_case { NO, YES };
+
+// Precompiled multi-needle replacer, built once and reused for any number of haystacks.
+// All needles are searched in a single pass; at each position the longest needle wins.
+class replacer final {
+private:
+	_wli::str_multi_search    _search;
+	std::vector<std::wstring> _replacements;
+
+public:
+	replacer() = default;
+
+	replacer(std::initializer_list<std::pair<std::wstring_view, std::wstring_view>> needlesAndReplacements,
+		ignore_case ignoreCase = ignore_case::NO)
+	{
+		// str::replacer r{{L"{{name}}", L"John"}, {L"{{city}}", L"Rome"}};
+		// std::wstring text = r.replace(templateText);
+		std::vector<std::wstring_view> needles;
+		for (const auto& pair : needlesAndReplacements) {
+			needles.emplace_back(pair.first);
+			this->_replacements.emplace_back(pair.second);
+		}
+		this->_search = _wli::str_multi_search{needles, ignoreCase == ignore_case::YES};
+	}
+
+	replacer(const std::vector<std::pair<std::wstring, std::wstring>>& needlesAndReplacements,
+		ignore_case ignoreCase = ignore_case::NO)
+	{
+		std::vector<std::wstring_view> needles;
+		for (const auto& pair : needlesAndReplacements) {
+			needles.emplace_back(pair.first);
+			this->_replacements.emplace_back(pair.second);
+		}
+		this->_search = _wli::str_multi_search{needles, ignoreCase == ignore_case::YES};
+	}
+
+	// Returns a new string with all the replacements; the output is allocated once, with its exact size.
+	std::wstring replace(std::wstring_view haystack) const {
+		struct match final { size_t pos, len; unsigned idx; };
+		std::vector<match> matches;
+		size_t outLen = haystack.length();
+		this->_search.for_each_match(haystack.data(), haystack.length(),
+			[&](size_t pos, size_t len, unsigned idx) {
+				matches.push_back({pos, len, idx});
+				outLen = outLen - len + this->_replacements[idx].length();
+			});
+
+		std::wstring output;
+		output.reserve(outLen);
+		size_t base = 0;
+		for (const match& m : matches) {
+			output.append(haystack.data() + base, m.pos - base)
+				.append(this->_replacements[m.idx]);
+			base = m.pos + m.len;
+		}
+		output.append(haystack.data() + base, haystack.length() - base);
+		return output;
+	}
+
+	// Replaces all the needles, in-place.
+	std::wstring& replace_in_place(std::wstring& haystack) const {
+		std::wstring output = this->replace(haystack);
+		haystack.swap(output);
+		return haystack;
+	}
+
+	// Streams the output into a sink, which is any object with an append(const wchar_t*, size_t) method;
+	// nothing is allocated, and the output is produced as the haystack is scanned.
+	template<typename sinkT>
+	void replace_to(std::wstring_view haystack, sinkT& sink) const {
+		size_t base = 0;
+		this->_search.for_each_match(haystack.data(), haystack.length(),
+			[&](size_t pos, size_t len, unsigned idx) {
+				sink.append(haystack.data() + base, pos - base);
+				sink.append(this->_replacements[idx].data(), this->_replacements[idx].length());
+				base = pos + len;
+			});
+		sink.append(haystack.data() + base, haystack.length() - base);
+	}
+};
+
+// How strings are compared by sort_key() and sort_order(); values can be combined.
+enum class collate : unsigned {
+	ORDINAL             = 0, // plain char codes
+	IGNORE_CASE         = _wli::str_sort::IGNORE_CASE, // by Unicode simple case folding
+	IGNORE_DIACRITICS   = _wli::str_sort::IGNORE_DIACRITICS, // like sorting u-acute along with u
+	NATURAL             = _wli::str_sort::NATURAL, // runs of digits compared as numbers, like "file9" before "file10"
+	NATURAL_IGNORE_CASE = _wli::str_sort::NATURAL | _wli::str_sort::IGNORE_CASE // like Explorer sorts file names
+};
+
+// Returns a key whose ordinal comparison gives the chosen order, so a string is normalized only once.
+inline std::wstring sort_key(std::wstring_view s, collate how = collate::NATURAL_IGNORE_CASE) {
+	std::wstring key;
+	key.reserve(s.length() + 4);
+	_wli::str_sort::append_key(s, static_cast<unsigned>(how), key);
+	return key;
+}
+
+// Returns the indexes of the strings in sorted order, which is stable. Keys are computed once
+// per string, and big lists are sorted in parallel; numThreads zero means one per core.
+template<typename strT>
+inline std::vector<size_t> sort_order(const std::vector<strT>& strs,
+	collate how = collate::NATURAL_IGNORE_CASE, size_t numThreads = 0)
+{
+	return _wli::str_sort::sorted_order(strs, static_cast<unsigned>(how), numThreads);
+}
+
+// Sorts the strings in place, with keys computed once per string; by default case-insensitive and natural.
+inline std::vector<std::wstring>& sort(std::vector<std::wstring>& strs, collate how = collate::NATURAL_IGNORE_CASE) {
+	std::vector<size_t> order = sort_order(strs, how);
+	std::vector<std::wstring> sorted;
+	sorted.reserve(strs.size());
+	for (size_t idx : order) sorted.emplace_back(std::move(strs[idx]));
+	strs.swap(sorted);
+	return strs;
+}
+
+// Does the string represent a signed int? To also convert it, prefer from_chars().
 inline bool is_int(const std::wstring& s) noexcept {
 	if (s.empty()) return false;
 	if (s[0] != L'-' && !std::iswdigit(s[0]) && !std::iswblank(s[0])) return false;
@@ -250,7 +516,7 @@ inline bool is_int(const std::wstring& s) noexcept {
 	return true;
 }
 
-// Does the string represent an unsigned int?
+// Does the string represent an unsigned int? To also convert it, prefer from_chars().
 inline bool is_uint(const std::wstring& s) noexcept {
 	if (s.empty()) return false;
 	for (wchar_t ch : s) {
@@ -259,7 +525,7 @@ inline bool is_uint(const std::wstring& s) noexcept {
 	return true;
 }
 
-// Does the string represent a hexadecimal int?
+// Does the string represent a hexadecimal int? To also convert it, prefer from_chars().
 inline bool is_hex(const std::wstring& s) noexcept {
 	if (s.empty()) return false;
 	for (wchar_t ch : s) {
@@ -268,7 +534,7 @@ inline bool is_hex(const std::wstring& s) noexcept {
 	return true;
 }
 
-// Does the string represent a float?
+// Does the string represent a float? To also convert it, prefer from_chars().
 inline bool is_float(const std::wstring& s) noexcept {
 	if (s.empty()) return false;
 	if (s[0] != L'-' && s[0] != L'.' && !std::iswdigit(s[0]) && !std::iswblank(s[0])) return false;
@@ -288,6 +554,25 @@ inline bool is_float(const std::wstring& s) noexcept {
 	return true;
 }
 
+// Result of str::from_chars(), like std::from_chars_result, but with an index instead of a pointer.
+using from_chars_result = _wli::str_parse::result;
+
+// Parses an integer at the beginning of the string, validating and converting in a single pass, like std::from_chars.
+// Parsing stops at the first char which is not a digit; on error, the value is left untouched.
+template<typename intT, typename = std::enable_if_t<std::is_integral_v<intT>>>
+inline from_chars_result from_chars(std::wstring_view s, intT& value, int base = 10) noexcept {
+	// UINT n = 0;
+	// str::from_chars_result res = str::from_chars(L"1024 bytes", n); // n is 1024, res.stop is 4
+	// if (res.ec == std::errc{} && res.stop == s.length()) { ... } // whole string is a number
+	return _wli::str_parse::parse_integer(s, value, base);
+}
+
+// Parses a double at the beginning of the string, validating and converting in a single pass, like std::from_chars.
+// The decimal point is always a dot; on error, the value is left untouched.
+inline from_chars_result from_chars(std::wstring_view s, double& value) {
+	return _wli::str_parse::parse_double(s, value);
+}
+
 // Possible string encodings.
 enum class encoding { UNKNOWN, ASCII, WIN1252, UTF8, UTF16BE, UTF16LE, UTF32BE, UTF32LE, SCSU, BOCU1 };
 
@@ -295,10 +580,11 @@ enum class encoding { UNKNOWN, ASCII, WIN1252, UTF8, UTF16BE, UTF16LE, UTF32BE,
 struct encoding_info final {
 	encoding encType = encoding::UNKNOWN;
 	size_t   bomSize = 0;
+	float    confidence = 1.0f; // from 0 to 1, how sure the guess is when there's no BOM
 };
 
-// Returns encoding information about the given string.
-inline encoding_info get_encoding(const BYTE* data, size_t sz) noexcept {
+// Returns encoding information about the given string; if there's no BOM, only the first maxSniffBytes are examined.
+inline encoding_info get_encoding(const BYTE* data, size_t sz, size_t maxSniffBytes = static_cast<size_t>(-1)) noexcept {
 	auto match = [&](const BYTE* pBom, int szBom) noexcept -> bool {
 		return (sz >= static_cast<size_t>(szBom)) &&
 			!memcmp(data, pBom, sizeof(BYTE) * szBom);
@@ -312,40 +598,42 @@ inline encoding_info get_encoding(const BYTE* data, size_t sz) noexcept {
 	BYTE utf16be[] = {0xFE, 0xFF};
 	if (match(utf16be, 2)) return {encoding::UTF16BE, 2};
 
+	BYTE utf32le[] = {0xFF, 0xFE, 0x00, 0x00}; // must be checked before UTF-16 LE, which is a prefix of it
+	if (match(utf32le, 4)) return {encoding::UTF32LE, 4};
+
 	BYTE utf16le[] = {0xFF, 0xFE};
 	if (match(utf16le, 2)) return {encoding::UTF16LE, 2};
 
 	BYTE utf32be[] = {0x00, 0x00, 0xFE, 0xFF};
 	if (match(utf32be, 4)) return {encoding::UTF32BE, 4};
 
-	BYTE utf32le[] = {0xFF, 0xFE, 0x00, 0x00};
-	if (match(utf32le, 4)) return {encoding::UTF32LE, 4};
-
 	BYTE scsu[] = {0x0E, 0xFE, 0xFF};
 	if (match(scsu, 3)) return {encoding::SCSU, 3};
 
 	BYTE bocu1[] = {0xFB, 0xEE, 0x28};
 	if (match(bocu1, 3)) return {encoding::BOCU1, 3};
 
-	// No BOM found, guess UTF-8 without BOM, or Windows-1252 (superset of ISO-8859-1).
-	bool canBeWin1252 = false;
-	for (size_t i = 0; i < sz; ++i) {
-		if (data[i] > 0x7F) { // 127
-			canBeWin1252 = true;
-			if (i <= sz - 2 && (
-				(data[i] == 0xC2 && (data[i+1] >= 0xA1 && data[i+1] <= 0xBF)) || // http://www.utf8-chartable.de
-				(data[i] == 0xC3 && (data[i+1] >= 0x80 && data[i+1] <= 0xBF)) ))
-			{
-				return {encoding::UTF8, 0}; // UTF-8 without BOM
-			}
-		}
+	// No BOM found, validate as UTF-8 without BOM, otherwise it's Windows-1252 (superset of ISO-8859-1).
+	size_t sniffLen = (maxSniffBytes < sz) ? maxSniffBytes : sz;
+	bool sniffedAll = (sniffLen == sz);
+	_wli::str_utf::utf8_scan scan = _wli::str_utf::validate_utf8(data, sniffLen);
+
+	if (scan.invalid || (scan.truncated && sniffedAll && !scan.numNonAscii)) {
+		return {encoding::WIN1252, 0, 1.0f}; // not UTF-8 for sure
+	} else if (!scan.numNonAscii && !scan.truncated) {
+		return {encoding::ASCII, 0, sniffedAll ? 1.0f : 0.5f}; // unseen bytes may not be ASCII
 	}
-	return {(canBeWin1252 ? encoding::WIN1252 : encoding::ASCII), 0};
+
+	// Each valid sequence halves the odds of Windows-1252 text being valid UTF-8 by chance.
+	size_t evidence = (scan.numNonAscii < 23) ? scan.numNonAscii + 1 : 24;
+	float confidence = 1.0f - 1.0f / static_cast<float>(1 << evidence);
+	if (scan.truncated && sniffedAll) confidence /= 2; // truncated last char
+	return {encoding::UTF8, 0, confidence};
 }
 
 // Returns encoding information about the given string.
-inline encoding_info get_encoding(const std::vector<BYTE>& data) noexcept {
-	return get_encoding(&data[0], data.size());
+inline encoding_info get_encoding(const std::vector<BYTE>& data, size_t maxSniffBytes = static_cast<size_t>(-1)) noexcept {
+	return get_encoding(&data[0], data.size(), maxSniffBytes);
 }
 
 // What linebreak is being used on a given string (unknown, N, R, RN or NR). If different linebreaks are used, only the first one is reported.
@@ -370,19 +658,15 @@ inline std::vector<BYTE> to_utf8_blob(const std::wstring& s, write_bom writeBom)
 		BYTE utf8bom[]{0xEF, 0xBB, 0xBF};
 		int szBom = (writeBom == write_bom::YES) ? ARRAYSIZE(utf8bom) : 0;
 
-		int neededLen = WideCharToMultiByte(CP_UTF8, 0,
-			s.c_str(), static_cast<int>(s.length()),
-			nullptr, 0, nullptr, 0);
-		ret.resize(neededLen + szBom);
+		ret.resize(_wli::str_utf::utf8_max_len(s.length()) + szBom); // single pass, shrunk afterwards
 
 		if (writeBom == write_bom::YES) {
 			memcpy(&ret[0], utf8bom, szBom);
 		}
 
-		WideCharToMultiByte(CP_UTF8, 0,
-			s.c_str(), static_cast<int>(s.length()),
-			reinterpret_cast<char*>(&ret[0 + szBom]),
-			neededLen, nullptr, nullptr);
+		_wli::str_utf::result res = _wli::str_utf::utf16_to_utf8(
+			s.c_str(), s.length(), &ret[0 + szBom]);
+		ret.resize(res.written + szBom);
 	}
 	return ret;
 }
@@ -402,16 +686,17 @@ inline std::wstring to_wstring(const BYTE* data, size_t sz) {
 
 	encoding_info fileEnc = get_encoding(data, sz);
 	data += fileEnc.bomSize; // skip BOM, if any
+	sz -= fileEnc.bomSize;
 
 	switch (fileEnc.encType) {
 	case encoding::UNKNOWN:
 	case encoding::ASCII:   return _wli::str_priv::parse_ascii(data, sz);
 	case encoding::WIN1252: return _wli::str_priv::parse_encoded(data, sz, 1252);
-	case encoding::UTF8:    return _wli::str_priv::parse_encoded(data, sz, CP_UTF8);
-	case encoding::UTF16BE: throw std::invalid_argument("UTF-16 big endian: encoding not implemented.");
-	case encoding::UTF16LE: throw std::invalid_argument("UTF-16 little endian: encoding not implemented.");
-	case encoding::UTF32BE: throw std::invalid_argument("UTF-32 big endian: encoding not implemented.");
-	case encoding::UTF32LE: throw std::invalid_argument("UTF-32 little endian: encoding not implemented.");
+	case encoding::UTF8:    return _wli::str_priv::parse_utf8(data, sz);
+	case encoding::UTF16BE: return _wli::str_priv::parse_utf16(data, sz, true);
+	case encoding::UTF16LE: return _wli::str_priv::parse_utf16(data, sz, false);
+	case encoding::UTF32BE: return _wli::str_priv::parse_utf32(data, sz, true);
+	case encoding::UTF32LE: return _wli::str_priv::parse_utf32(data, sz, false);
 	case encoding::SCSU:    throw std::invalid_argument("Standard compression scheme for Unicode: encoding not implemented.");
 	case encoding::BOCU1:   throw std::invalid_argument("Binary ordered compression for Unicode: encoding not implemented.");
 	default:                throw std::invalid_argument("Unknown encoding.");
@@ -423,6 +708,213 @@ inline std::wstring to_wstring(const std::vector<BYTE>& data) {
 	return to_wstring(&data[0], data.size());
 }
 
+// Non-owning view over UTF-16LE data with BOM, such as a memory-mapped file; no conversion is made.
+inline std::wstring_view view_utf16le(const BYTE* data, size_t sz) {
+	// file_mapped fm;
+	// fm.open(L"C:\\export.txt", file::access::READONLY);
+	// std::wstring_view text = str::view_utf16le(fm.p_mem(), fm.size()); // valid while fm is open
+	if (!data || !sz) return {};
+
+	encoding_info fileEnc = get_encoding(data, sz);
+	if (fileEnc.encType != encoding::UTF16LE) {
+		throw std::invalid_argument("View requires UTF-16 little endian data.");
+	}
+	const BYTE* pText = data + fileEnc.bomSize;
+	if (reinterpret_cast<UINT_PTR>(pText) % alignof(wchar_t)) {
+		throw std::invalid_argument("UTF-16 data is not aligned to wchar_t.");
+	}
+	return {reinterpret_cast<const wchar_t*>(pText), (sz - fileEnc.bomSize) / sizeof(wchar_t)};
+}
+
+// Incremental decoder for text which arrives in chunks, like from a download or a huge file.
+// Multi-byte sequences split across chunks are carried over, so memory stays bounded by the chunk size.
+class decoder final {
+private:
+	encoding     _enc = encoding::UNKNOWN;
+	bool         _bomChecked = false;
+	BYTE         _pending[8]{}; // incomplete sequence waiting for the next chunk, at most 3 bytes
+	size_t       _pendingLen = 0;
+	size_t       _numInvalid = 0;
+	std::wstring _output;
+
+public:
+	// If encoding is UNKNOWN, it's detected from the first chunk; text without BOM is
+	// assumed UTF-8 unless the first chunk looks like Windows-1252.
+	explicit decoder(encoding enc = encoding::UNKNOWN) noexcept : _enc{enc} { }
+
+	encoding encoding_type() const noexcept { return this->_enc; }
+	size_t   num_invalid() const noexcept   { return this->_numInvalid; } // sequences replaced with U+FFFD
+
+	// Text decoded so far; call clear_output() after consuming it to reuse the buffer.
+	const std::wstring& output() const noexcept { return this->_output; }
+	std::wstring&       output() noexcept       { return this->_output; }
+
+	// Clears the decoded text, keeping the allocated buffer.
+	decoder& clear_output() noexcept {
+		this->_output.clear();
+		return *this;
+	}
+
+	// Discards all state, so a new stream can be decoded.
+	decoder& reset(encoding enc = encoding::UNKNOWN) noexcept {
+		this->_enc = enc;
+		this->_bomChecked = false;
+		this->_pendingLen = this->_numInvalid = 0;
+		this->_output.clear();
+		return *this;
+	}
+
+	// Decodes a chunk, appending the text to output().
+	decoder& feed(const BYTE* data, size_t sz) {
+		// download dl{session, L"https://..."};
+		// str::decoder dec;
+		// dl.on_progress([&]() {
+		//   dec.feed(&dl.data[0], dl.data.size()); // data is consumed, so it doesn't pile up
+		//   dl.data.clear();
+		//   process(dec.output());
+		//   dec.clear_output();
+		// });
+		if (!data || !sz) return *this;
+
+		if (!this->_bomChecked) {
+			if (this->_pendingLen) { // first chunks were too short for BOM detection
+				std::vector<BYTE> joined(this->_pending, this->_pending + this->_pendingLen);
+				joined.insert(joined.end(), data, data + sz);
+				this->_pendingLen = 0;
+				return this->feed(&joined[0], joined.size());
+			} else if (sz < 4) { // the longest BOM has 4 bytes
+				memcpy(this->_pending, data, sz);
+				this->_pendingLen = sz;
+				return *this;
+			}
+			this->_check_bom(data, sz, false);
+		}
+
+		this->_decode(data, sz, false);
+		return *this;
+	}
+
+	// Decodes a chunk, appending the text to output().
+	decoder& feed(const std::vector<BYTE>& data) {
+		return this->feed(data.empty() ? nullptr : &data[0], data.size());
+	}
+
+	// Flushes any incomplete sequence as U+FFFD; call after the last chunk.
+	decoder& finish() {
+		if (this->_pendingLen) {
+			BYTE tail[16]; // one SSE2 block, so the compiler sees the ASCII scan of get_encoding() in bounds
+			const BYTE* pTail = tail;
+			size_t tailLen = this->_pendingLen;
+			memcpy(tail, this->_pending, tailLen);
+			this->_pendingLen = 0;
+
+			if (!this->_bomChecked) this->_check_bom(pTail, tailLen, true);
+			this->_decode(pTail, tailLen, true);
+		}
+		return *this;
+	}
+
+private:
+	void _check_bom(const BYTE*& data, size_t& sz, bool isLast) {
+		encoding_info info = get_encoding(data, sz);
+		if (this->_enc == encoding::UNKNOWN && info.encType == encoding::WIN1252 && !isLast) {
+			size_t whole = _complete_utf8_len(data, sz); // a sequence cut by the chunk boundary proves nothing
+			if (whole && whole < sz) info = get_encoding(data, whole);
+		}
+		if (this->_enc == encoding::UNKNOWN) {
+			this->_enc = (info.encType == encoding::ASCII || info.encType == encoding::UNKNOWN) ?
+				encoding::UTF8 : info.encType; // pure ASCII so far, UTF-8 is a superset
+		}
+		if (info.encType == this->_enc) { // skip BOM only if it matches the encoding
+			data += info.bomSize;
+			sz -= info.bomSize;
+		}
+		if (this->_enc == encoding::SCSU || this->_enc == encoding::BOCU1) {
+			throw std::invalid_argument("Compressed Unicode encodings are not implemented.");
+		}
+		this->_bomChecked = true;
+	}
+
+	// Length without the last sequence, if it's incomplete; the chunk is entirely returned otherwise.
+	static size_t _complete_utf8_len(const BYTE* data, size_t sz) noexcept {
+		for (size_t back = 1; back <= 3 && back <= sz; ++back) {
+			BYTE c = data[sz - back];
+			if ((c & 0xC0) == 0x80) continue; // continuation byte, keep looking for the lead
+			size_t seqLen = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+			return (seqLen > back) ? sz - back : sz;
+		}
+		return sz;
+	}
+
+	void _decode(const BYTE* data, size_t sz, bool isLast) {
+		if (this->_pendingLen) { // complete the carried sequence with the first bytes of this chunk
+			BYTE joined[sizeof(this->_pending) * 2];
+			size_t take = sz < 4 ? sz : 4; // enough to complete any sequence
+			memcpy(joined, this->_pending, this->_pendingLen);
+			memcpy(joined + this->_pendingLen, data, take);
+			size_t joinedLen = this->_pendingLen + take;
+
+			size_t used = this->_decode_run(joined, joinedLen, isLast && take == sz);
+			if (used < this->_pendingLen) { // chunk was too short, still incomplete
+				memcpy(this->_pending, joined + used, joinedLen - used);
+				this->_pendingLen = joinedLen - used;
+				return;
+			}
+			data += used - this->_pendingLen;
+			sz -= used - this->_pendingLen;
+			this->_pendingLen = 0;
+		}
+
+		size_t used = this->_decode_run(data, sz, isLast);
+		memcpy(this->_pending, data + used, sz - used);
+		this->_pendingLen = sz - used;
+	}
+
+	size_t _decode_run(const BYTE* data, size_t sz, bool isLast) {
+		if (!sz) return 0;
+		size_t prevLen = this->_output.length();
+		_wli::str_utf::result res;
+
+		switch (this->_enc) {
+		case encoding::ASCII:
+			this->_output.resize(prevLen + sz);
+			_wli::str_utf::widen_ascii(data, sz, &this->_output[prevLen]);
+			res.read = res.written = sz;
+			break;
+		case encoding::WIN1252:
+			this->_output.resize(prevLen + sz); // single-byte, never split
+			res.written = MultiByteToWideChar(1252, 0, reinterpret_cast<const char*>(data),
+				static_cast<int>(sz), &this->_output[prevLen], static_cast<int>(sz));
+			res.read = sz;
+			break;
+		case encoding::UTF8:
+			this->_output.resize(prevLen + _wli::str_utf::utf16_max_len(sz));
+			res = _wli::str_utf::utf8_to_utf16(data, sz, &this->_output[prevLen], isLast);
+			break;
+		case encoding::UTF16BE:
+		case encoding::UTF16LE:
+			if (!isLast) sz -= sz % 2; // whole code units only
+			this->_output.resize(prevLen + _wli::str_utf::utf16_max_len_from_utf16(sz));
+			res = _wli::str_utf::utf16_to_utf16(data, sz,
+				this->_enc == encoding::UTF16BE, &this->_output[prevLen]);
+			break;
+		case encoding::UTF32BE:
+		case encoding::UTF32LE:
+			if (!isLast) sz -= sz % 4;
+			this->_output.resize(prevLen + _wli::str_utf::utf16_max_len_from_utf32(sz));
+			res = _wli::str_utf::utf32_to_utf16(data, sz,
+				this->_enc == encoding::UTF32BE, &this->_output[prevLen]);
+			break;
+		default:
+			throw std::invalid_argument("Unknown encoding.");
+		}
+
+		this->_output.resize(prevLen + res.written);
+		this->_numInvalid += res.numInvalid;
+		return res.read;
+	}
+};
+
 // Conversion to wstring.
 inline std::wstring to_wstring(const char* s) {
 	return _wli::str_priv::parse_ascii(reinterpret_cast<const BYTE*>(s), lstrlenA(s));
@@ -433,75 +925,97 @@ inline std::wstring to_wstring(const std::string& s) {
 	return to_wstring(s.c_str());
 }
 
-// Converts number to wstring, adding thousand separator.
-inline std::wstring to_wstring_with_separator(int number, wchar_t separator = L',') {
-	std::wstring ret;
-	ret.reserve(32); // arbitrary
-
-	int abso = abs(number);
-	BYTE blocks = 0;
-	while (abso >= 1000) {
-		abso = (abso - (abso % 1000)) / 1000;
-		++blocks;
+// Options for number conversions with to_wstring() and number_to().
+struct number_format final {
+	int     precision = -1;       // digits after the decimal point; if negative, doubles use the shortest text which reads back the same
+	wchar_t separator = L'\0';    // digit group separator, none if null
+	BYTE    groupSize = 3;        // digits in the rightmost group
+	BYTE    nextGroupSize = 3;    // digits in each further group; zero groups only the rightmost one
+	wchar_t decimalPoint = L'.';
+
+	// Separators and digit grouping of the current user locale, like 1.234.567,89 or 12,34,567.89.
+	static number_format user_locale(int precision = -1) {
+		number_format fmt;
+		fmt.precision = precision;
+		wchar_t buf[16]{};
+		if (GetLocaleInfoW(LOCALE_USER_DEFAULT, LOCALE_STHOUSAND, buf, ARRAYSIZE(buf))) fmt.separator = buf[0];
+		if (GetLocaleInfoW(LOCALE_USER_DEFAULT, LOCALE_SDECIMAL, buf, ARRAYSIZE(buf)) && buf[0]) fmt.decimalPoint = buf[0];
+		if (GetLocaleInfoW(LOCALE_USER_DEFAULT, LOCALE_SGROUPING, buf, ARRAYSIZE(buf)) && buf[0] >= L'0' && buf[0] <= L'9') {
+			// "3;0" repeats groups of 3, "3;2;0" is 3 then groups of 2, "3" is a single group
+			fmt.groupSize = static_cast<BYTE>(buf[0] - L'0');
+			fmt.nextGroupSize = (buf[1] == L';' && buf[2] == L'0') ? fmt.groupSize
+				: (buf[1] == L';' && buf[2] >= L'1' && buf[2] <= L'9' && buf[3] == L';' && buf[4] == L'0') ? static_cast<BYTE>(buf[2] - L'0')
+				: 0;
+		}
+		return fmt;
 	}
+};
 
-	abso = abs(number);
-	bool firstPass = true;
-	do {
-		int num = abso % 1000;
-		wchar_t buf[8]{};
+// Converts number to wstring, with the given precision and digit grouping; never uses the CRT.
+template<typename numT, typename = std::enable_if_t<std::is_arithmetic_v<numT>>>
+inline std::wstring to_wstring(numT number, const number_format& fmt) {
+	// str::to_wstring(fileSize, {0, L','}) -> L"4,294,967,296"
+	// str::to_wstring(3.14159, {2}) -> L"3.14"
+	// str::to_wstring(0.1 + 0.2, {}) -> L"0.30000000000000004"
+	std::wstring ret;
+	ret.reserve(32);
+	_wli::str_format::wstring_sink sink{ret};
+	_wli::str_num::put_number(sink, number, fmt.precision,
+		{fmt.separator, fmt.groupSize, fmt.nextGroupSize}, fmt.decimalPoint);
+	return ret;
+}
 
-		if (blocks) {
-			if (num < 100) lstrcatW(buf, L"0");
-			if (num < 10) lstrcatW(buf, L"0");
-		}
+// Converts number into a fixed buffer, without allocations; output is truncated if needed, and always null-terminated.
+// Returns the length of the whole text; if it's not less than bufLen, output was truncated.
+// With a null buf or zero bufLen nothing is written, and the required length is returned, like format_to().
+template<typename numT, typename = std::enable_if_t<std::is_arithmetic_v<numT>>>
+inline size_t number_to(wchar_t* buf, size_t bufLen, numT number, const number_format& fmt = {}) {
+	if (!buf) bufLen = 0;
+	_wli::str_format::buffer_sink sink{buf, bufLen};
+	_wli::str_num::put_number(sink, number, fmt.precision,
+		{fmt.separator, fmt.groupSize, fmt.nextGroupSize}, fmt.decimalPoint);
+	if (bufLen) sink.terminate();
+	return sink.length();
+}
 
-#pragma warning (disable: 4996)
-		_itow(num, buf + lstrlenW(buf), 10);
-#pragma warning (default: 4996)
+// Converts number to wstring, adding thousand separator.
+template<typename intT, typename = std::enable_if_t<std::is_integral_v<intT>>>
+inline std::wstring to_wstring_with_separator(intT number, wchar_t separator = L',') {
+	return to_wstring(number, {0, separator});
+}
 
-		if (firstPass) {
-			firstPass = false;
-		} else {
-			ret.insert(0, 1, separator);
-		}
+// Lazy range of tokens split at the given characters, without allocations; tokens point into the string.
+inline _wli::str_tokens<_wli::str_delim_splitter> split_view(std::wstring_view s, std::wstring_view delimiter) noexcept {
+	// for (std::wstring_view field : str::split_view(csvLine, L",")) { ... }
+	return {s, {delimiter}};
+}
 
-		ret.insert(0, buf);
-		abso = (abso - (abso % 1000)) / 1000;
-	} while (blocks--);
+// Lazy range of lines, without allocations; \r\n, \n and \r are all recognized, even mixed.
+inline _wli::str_tokens<_wli::str_line_splitter> split_lines_view(std::wstring_view s) noexcept {
+	return {s, {}};
+}
 
-	if (number < 0) ret.insert(0, 1, L'-'); // prepend minus signal
-	return ret;
+// Lazy range of tokens, which may be enclosed in double quotes, without allocations.
+inline _wli::str_tokens<_wli::str_quoted_splitter> split_quoted_view(std::wstring_view s) noexcept {
+	// Example quoted string:
+	// "First one" NoQuoteSecond "Third one"
+	return {s, {}};
 }
 
-// Converts number to wstring, adding thousand separator.
-inline std::wstring to_wstring_with_separator(size_t number, wchar_t separator = L',') {
-	return to_wstring_with_separator(static_cast<int>(number), separator);
+// Returns a view of the string without leading and trailing spaces, using std::iswspace.
+inline std::wstring_view trim_view(std::wstring_view s) noexcept {
+	size_t iFirst = 0, iPastLast = s.length();
+	while (iFirst < iPastLast && std::iswspace(s[iFirst])) ++iFirst;
+	while (iPastLast > iFirst && std::iswspace(s[iPastLast - 1])) --iPastLast;
+	return s.substr(iFirst, iPastLast - iFirst);
 }
 
 // Splits the string at the given characters, the characters themselves will be removed.
 inline std::vector<std::wstring> split(const std::wstring& s, const wchar_t* delimiter) {
 	std::vector<std::wstring> ret;
-	if (s.empty()) return ret;
-
-	if (!delimiter) {
-		ret.emplace_back(s); // one single line
-		return ret;
-	}
-
-	size_t base = 0, head = 0;
-
-	for (;;) {
-		head = s.find(delimiter, head);
-		if (head == std::wstring::npos) break;
-		ret.emplace_back();
-		ret.back().insert(0, s, base, head - base);
-		head += lstrlenW(delimiter);
-		base = head;
+	for (std::wstring_view token : split_view(s, delimiter ? delimiter : L"")) {
+		ret.emplace_back(token);
 	}
-
-	ret.emplace_back();
-	ret.back().insert(0, s, base, s.length() - base);
 	return ret;
 }
 
@@ -510,9 +1024,13 @@ inline std::vector<std::wstring> split(const std::wstring& s, const std::wstring
 	return split(s, delimiter.c_str());
 }
 
-// Splits a string line by line.
+// Splits a string line by line; \r\n, \n and \r are all recognized, even mixed.
 inline std::vector<std::wstring> split_lines(const std::wstring& s) {
-	return split(s, get_linebreak(s));
+	std::vector<std::wstring> ret;
+	for (std::wstring_view line : split_lines_view(s)) {
+		ret.emplace_back(line);
+	}
+	return ret;
 }
 
 // Splits a zero-delimited multi-string.
@@ -544,72 +1062,10 @@ inline std::vector<std::wstring> split_multi_zero(const wchar_t* s) {
 
 // Splits string into tokens, which may be enclosed in double quotes.
 inline std::vector<std::wstring> split_quoted(const wchar_t* s) {
-	// Example quoted string:
-	// "First one" NoQuoteSecond "Third one"
-
-	// Count number of strings.
-	size_t numStrings = 0;
-	const wchar_t* pRun = s;
-	while (*pRun) {
-		if (*pRun == L'\"') { // begin of quoted string
-			++pRun; // point to 1st char of string
-			for (;;) {
-				if (!*pRun) {
-					break; // won't compute open-quoted
-				} else if (*pRun == L'\"') {
-					++pRun; // point to 1st char after closing quote
-					++numStrings;
-					break;
-				}
-				++pRun;
-			}
-		} else if (!std::iswspace(*pRun)) { // 1st char of non-quoted string
-			++pRun; // point to 2nd char of string
-			while (*pRun && !std::iswspace(*pRun) && *pRun != L'\"') ++pRun; // passed string
-			++numStrings;
-		} else {
-			++pRun; // some white space
-		}
-	}
-
-	// Alloc return array of strings.
 	std::vector<std::wstring> ret;
-	ret.reserve(numStrings);
-
-	// Alloc and copy each string.
-	pRun = s;
-	const wchar_t* pBase;
-	int i = 0;
-	while (*pRun) {
-		if (*pRun == L'\"') { // begin of quoted string
-			++pRun; // point to 1st char of string
-			pBase = pRun;
-			for (;;) {
-				if (!*pRun) {
-					break; // won't compute open-quoted
-				} else if (*pRun == L'\"') {
-					ret.emplace_back();
-					ret.back().insert(0, pBase, pRun - pBase); // copy to buffer
-					++i; // next string
-
-					++pRun; // point to 1st char after closing quote
-					break;
-				}
-				++pRun;
-			}
-		} else if (!std::iswspace(*pRun)) { // 1st char of non-quoted string
-			pBase = pRun;
-			++pRun; // point to 2nd char of string
-			while (*pRun && !std::iswspace(*pRun) && *pRun != L'\"') ++pRun; // passed string
-
-			ret.emplace_back();
-			ret.back().insert(0, pBase, pRun - pBase); // copy to buffer
-			++i; // next string
-		} else {
-			++pRun; // some white space
-		}
+	for (std::wstring_view token : split_quoted_view(s)) { // single pass
+		ret.emplace_back(token);
 	}
-
 	return ret;
 }
 
@@ -620,3 +1076,5 @@ inline std::vector<std::wstring> split_quoted(const std::wstring& s) {
 
 }//namespace str
 }//namespace wl
+
+ENABLE_BITMASK_OPERATORS(wl::str::collate);
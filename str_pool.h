@@ -0,0 +1,285 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace wl {
+
+// Bump allocator for strings, which live in big slabs all freed together.
+// Not thread-safe; returned views are valid until clear() or destruction, even after a move.
+class str_arena final {
+private:
+	std::vector<std::unique_ptr<char[]>> _slabs;
+	char*  _cur = nullptr; // free space at the end of the last slab
+	size_t _left = 0;
+	size_t _slabSize = 0;
+	size_t _used = 0, _reserved = 0;
+	size_t _buildLen = 0; // chars of the string under construction, which starts at _cur
+	bool   _building = false;
+
+public:
+	explicit str_arena(size_t slabSize = 16 * 1024) noexcept : _slabSize{slabSize} { }
+	str_arena(str_arena&& other) noexcept { this->operator=(std::move(other)); }
+
+	str_arena& operator=(str_arena&& other) noexcept {
+		this->_slabs = std::move(other._slabs);
+		this->_cur = std::exchange(other._cur, nullptr);
+		this->_left = std::exchange(other._left, 0);
+		this->_slabSize = other._slabSize;
+		this->_used = std::exchange(other._used, 0);
+		this->_reserved = std::exchange(other._reserved, 0);
+		this->_buildLen = std::exchange(other._buildLen, 0);
+		this->_building = std::exchange(other._building, false);
+		return *this;
+	}
+
+	size_t bytes_used() const noexcept     { return this->_used; }
+	size_t bytes_reserved() const noexcept { return this->_reserved; }
+
+	// Frees all slabs at once, invalidating all strings.
+	str_arena& clear() noexcept {
+		this->_slabs.clear();
+		this->_cur = nullptr;
+		this->_left = this->_used = this->_reserved = this->_buildLen = 0;
+		this->_building = false;
+		return *this;
+	}
+
+	// Raw uninitialized memory; can't be called while a string is being built.
+	void* allocate(size_t numBytes, size_t alignment = alignof(std::max_align_t)) {
+		if (this->_building) {
+			throw std::logic_error("Can't allocate while a string is being built.");
+		}
+		void* p = this->_aligned_room(numBytes, alignment);
+		this->_cur += numBytes;
+		this->_left -= numBytes;
+		this->_used += numBytes;
+		return p;
+	}
+
+	// Copies the string into the arena; the returned view is null-terminated.
+	std::wstring_view push(std::wstring_view s) {
+		return this->append(s).finish();
+	}
+
+	// Appends to the string under construction, which is started if needed.
+	str_arena& append(std::wstring_view s) {
+		if (!this->_building) {
+			this->_aligned_room(sizeof(wchar_t), alignof(wchar_t));
+			this->_building = true;
+		}
+		size_t needed = (this->_buildLen + s.length() + 1) * sizeof(wchar_t); // room for the terminating null
+		if (needed > this->_left) { // move the partial string to a new slab
+			const char* partial = this->_cur;
+			this->_new_slab(needed * 2);
+			std::memcpy(this->_cur, partial, this->_buildLen * sizeof(wchar_t));
+		}
+		std::memcpy(this->_cur + this->_buildLen * sizeof(wchar_t), s.data(), s.length() * sizeof(wchar_t));
+		this->_buildLen += s.length();
+		return *this;
+	}
+
+	str_arena& append(wchar_t ch) {
+		return this->append(std::wstring_view{&ch, 1});
+	}
+
+	// Ends the string under construction, returning it null-terminated.
+	std::wstring_view finish() {
+		if (!this->_building) this->append(std::wstring_view{});
+		wchar_t* str = reinterpret_cast<wchar_t*>(this->_cur);
+		str[this->_buildLen] = L'\0';
+		size_t numBytes = (this->_buildLen + 1) * sizeof(wchar_t);
+		this->_cur += numBytes;
+		this->_left -= numBytes;
+		this->_used += numBytes;
+		std::wstring_view ret{str, this->_buildLen};
+		this->_buildLen = 0;
+		this->_building = false;
+		return ret;
+	}
+
+private:
+	void* _aligned_room(size_t numBytes, size_t alignment) {
+		size_t pad = this->_cur ? (alignment - reinterpret_cast<uintptr_t>(this->_cur) % alignment) % alignment : 0;
+		if (!this->_cur || pad + numBytes > this->_left) {
+			this->_new_slab(numBytes); // new slabs are aligned to max_align_t
+		} else {
+			this->_cur += pad;
+			this->_left -= pad;
+		}
+		return this->_cur;
+	}
+
+	void _new_slab(size_t minBytes) {
+		size_t slabBytes = (minBytes > this->_slabSize) ? minBytes : this->_slabSize;
+		this->_slabs.emplace_back(new char[slabBytes]);
+		this->_cur = this->_slabs.back().get();
+		this->_left = slabBytes;
+		this->_reserved += slabBytes;
+	}
+};
+
+// Thread-safe string interning: each distinct string is stored once, in an arena.
+// Equal strings get the same data pointer, so they can be compared by pointer.
+// Strings are only freed with the pool, so to intern untrusted input, like parsed names,
+// use a pool owned by the document or the parser, not atoms.
+class str_pool final {
+public:
+	struct counters final {
+		size_t lookups = 0;       // calls to intern()
+		size_t strings = 0;       // distinct strings stored
+		size_t bytesStored = 0;   // chars of the distinct strings, with their terminating nulls
+		size_t bytesSaved = 0;    // chars of repeated strings, which weren't stored again
+		size_t bytesReserved = 0; // slabs allocated by the arena
+	};
+
+	class atom;
+
+private:
+	struct _entry final {
+		size_t  len; // so an atom can be a single pointer
+		wchar_t str[1];
+	};
+
+	mutable std::mutex _mutex;
+	str_arena _arena;
+	std::unordered_set<std::wstring_view> _set;
+	counters _counters;
+
+public:
+	explicit str_pool(size_t slabSize = 16 * 1024) : _arena{slabSize} { }
+	str_pool(const str_pool&) = delete;
+	str_pool& operator=(const str_pool&) = delete;
+
+	// Counters of the process-wide pool used by atoms.
+	static counters shared_stats() {
+		return shared().stats();
+	}
+
+	// Returns a null-terminated view which lives as long as the pool; its data pointer is the same for equal strings.
+	std::wstring_view intern(std::wstring_view s) {
+		if (s.empty()) return {_empty_entry(), 0};
+		std::lock_guard<std::mutex> lock{this->_mutex};
+		++this->_counters.lookups;
+
+		auto found = this->_set.find(s);
+		if (found != this->_set.end()) {
+			this->_counters.bytesSaved += (s.length() + 1) * sizeof(wchar_t);
+			return *found;
+		}
+
+		size_t strBytes = (s.length() + 1) * sizeof(wchar_t);
+		_entry* e = static_cast<_entry*>(this->_arena.allocate(offsetof(_entry, str) + strBytes, alignof(_entry)));
+		e->len = s.length();
+		std::memcpy(e->str, s.data(), s.length() * sizeof(wchar_t));
+		e->str[s.length()] = L'\0';
+
+		std::wstring_view stored{e->str, s.length()};
+		this->_set.emplace(stored);
+		++this->_counters.strings;
+		this->_counters.bytesStored += strBytes;
+		return stored;
+	}
+
+	// Returns the interned view, or an empty one if the string was never interned.
+	std::wstring_view find(std::wstring_view s) const {
+		if (s.empty()) return {_empty_entry(), 0};
+		std::lock_guard<std::mutex> lock{this->_mutex};
+		auto found = this->_set.find(s);
+		return (found == this->_set.end()) ? std::wstring_view{} : *found;
+	}
+
+	counters stats() const {
+		std::lock_guard<std::mutex> lock{this->_mutex};
+		counters ret = this->_counters;
+		ret.bytesReserved = this->_arena.bytes_reserved();
+		return ret;
+	}
+
+	// Frees all strings at once; any view or atom previously returned becomes invalid.
+	str_pool& clear() {
+		std::lock_guard<std::mutex> lock{this->_mutex};
+		this->_set.clear();
+		this->_arena.clear();
+		this->_counters = {};
+		return *this;
+	}
+
+private:
+	// Process-wide pool used by atoms, never freed; private, so it can't be cleared under live atoms.
+	static str_pool& shared() {
+		static str_pool sharedPool;
+		return sharedPool;
+	}
+
+	static const wchar_t* _empty_entry() noexcept {
+		static const _entry emptyEntry{0, {L'\0'}};
+		return emptyEntry.str;
+	}
+
+	static size_t _length_of(const wchar_t* str) noexcept {
+		return reinterpret_cast<const _entry*>(reinterpret_cast<const char*>(str) - offsetof(_entry, str))->len;
+	}
+
+public:
+	// Handle to a string interned in the shared pool, with the size of a pointer.
+	// Comparing two atoms is a pointer comparison, so they are cheap keys to insert_order_map.
+	// The shared pool only grows, so atoms are meant for a bounded set of names known by the program.
+	class atom final {
+	private:
+		const wchar_t* _str = _empty_entry();
+
+	public:
+		atom() = default;
+		atom(std::wstring_view s)  : _str{shared().intern(s).data()} { }
+		atom(const wchar_t* s)     : atom(std::wstring_view{s}) { }
+		atom(const std::wstring& s) : atom(std::wstring_view{s}) { }
+
+		const wchar_t*    c_str() const noexcept  { return this->_str; }
+		const wchar_t*    data() const noexcept   { return this->_str; }
+		size_t            length() const noexcept { return _length_of(this->_str); }
+		size_t            size() const noexcept   { return _length_of(this->_str); }
+		bool              empty() const noexcept  { return !this->_str[0]; }
+		std::wstring_view view() const noexcept   { return {this->_str, _length_of(this->_str)}; }
+		std::wstring      str() const             { return std::wstring{this->view()}; }
+		operator std::wstring_view() const noexcept { return this->view(); }
+
+		bool operator==(const atom& other) const noexcept        { return this->_str == other._str; }
+		bool operator!=(const atom& other) const noexcept        { return this->_str != other._str; }
+		bool operator==(std::wstring_view other) const noexcept   { return this->view() == other; }
+		bool operator!=(std::wstring_view other) const noexcept   { return this->view() != other; }
+		bool operator==(const wchar_t* other) const noexcept      { return this->view() == other; }
+		bool operator!=(const wchar_t* other) const noexcept      { return this->view() != other; }
+		bool operator==(const std::wstring& other) const noexcept { return this->view() == other; }
+		bool operator!=(const std::wstring& other) const noexcept { return this->view() != other; }
+	};
+};
+
+}//namespace wl
+
+namespace std {
+
+template<>
+struct hash<wl::str_pool::atom> {
+	size_t operator()(const wl::str_pool::atom& a) const noexcept {
+		return hash<const wchar_t*>{}(a.c_str());
+	}
+};
+
+}//namespace std
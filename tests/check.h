@@ -0,0 +1,32 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstdio>
+
+// Minimal assertions for the tests: a failed check is reported and the test keeps going;
+// main() returns CHECK_RESULT(), which is nonzero if any check failed.
+
+inline int& check_failures() noexcept {
+	static int failures = 0;
+	return failures;
+}
+
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			++check_failures(); \
+		} \
+	} while (0)
+
+#define CHECK_THROWS(expr, exceptionT) do { \
+		bool thrown = false; \
+		try { expr; } catch (const exceptionT&) { thrown = true; } \
+		CHECK(thrown && #expr " must throw " #exceptionT); \
+	} while (0)
+
+#define CHECK_RESULT() (check_failures() ? (std::fprintf(stderr, "%d check(s) failed\n", check_failures()), 1) : 0)
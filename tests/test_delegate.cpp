@@ -0,0 +1,181 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "../internals/delegate.h"
+#include "check.h"
+using namespace wl;
+
+// Counts its live copies, so a leak or a double destruction shows up.
+struct counted final {
+	static inline int numLive = 0;
+	int val;
+	explicit counted(int val) noexcept : val{val} { ++numLive; }
+	counted(const counted& other) noexcept : val{other.val} { ++numLive; }
+	counted(counted&& other) noexcept : val{other.val} { ++numLive; }
+	~counted() { --numLive; }
+};
+
+// Returns its own address, which tells whether it's stored in the delegate buffer or on the heap.
+template<size_t SIZE, bool NOTHROW_MOVE = true>
+struct locator final {
+	unsigned char pad[SIZE] = {};
+	locator() = default;
+	locator(const locator&) = default;
+	locator(locator&&) noexcept(NOTHROW_MOVE) { }
+	const void* operator()() const { return this; }
+};
+
+using locator_t = _wli::delegate<const void*()>;
+
+static bool is_inline(const locator_t& func) {
+	auto self = reinterpret_cast<std::uintptr_t>(&func);
+	auto callable = reinterpret_cast<std::uintptr_t>(func());
+	return callable >= self && callable < self + sizeof(func);
+}
+
+struct widget final {
+	int val = 10;
+	int plus(int x) const { return this->val + x; }
+};
+
+static int triple(int x) { return x * 3; }
+
+using func_t = _wli::delegate<int(int)>;
+static_assert(!std::is_copy_constructible_v<func_t> && !std::is_copy_assignable_v<func_t>);
+static_assert(std::is_nothrow_move_constructible_v<func_t> && std::is_nothrow_move_assignable_v<func_t>);
+
+static void empty_delegates() {
+	int (*nullFunc)(int) = nullptr;
+	int (widget::*nullMember)(int) const = nullptr;
+	func_t byDefault, byNull = nullptr, byNullFunc = nullFunc;
+	_wli::delegate<int(const widget&, int)> byNullMember = nullMember;
+	CHECK(!byDefault && !byNull && !byNullFunc && !byNullMember);
+	CHECK_THROWS(byDefault(1), std::bad_function_call);
+	CHECK_THROWS(byNull(1), std::bad_function_call);
+	CHECK_THROWS(byNullFunc(1), std::bad_function_call);
+	CHECK_THROWS(byNullMember(widget{}, 1), std::bad_function_call);
+
+	func_t reset = triple;
+	CHECK(reset && reset(2) == 6);
+	reset = nullptr;
+	CHECK(!reset);
+	CHECK_THROWS(reset(2), std::bad_function_call);
+
+	_wli::delegate<void()> noResult;
+	CHECK_THROWS(noResult(), std::bad_function_call);
+}
+
+static void inline_and_heap() {
+	locator_t pointer = locator<sizeof(void*)>{};
+	locator_t full = locator<WL_DELEGATE_BUFFER>{};
+	locator_t big = locator<WL_DELEGATE_BUFFER + 1>{};
+	locator_t throwing = locator<sizeof(void*), false>{}; // fits, but its move may throw
+	CHECK(is_inline(pointer) && is_inline(full));
+	CHECK(!is_inline(big) && !is_inline(throwing));
+
+	const void* bigAt = big();
+	locator_t movedFull = std::move(full);
+	locator_t movedBig = std::move(big);
+	CHECK(is_inline(movedFull) && !full);
+	CHECK(movedBig() == bigAt && !big); // the pointer goes along
+
+	int base = 5;
+	func_t byRefCapture = [&base](int x) { return base + x; };
+	func_t byFuncPointer = triple;
+	CHECK(byRefCapture(1) == 6 && byFuncPointer(2) == 6);
+
+	_wli::delegate<int(const widget&, int)> byMember = &widget::plus; // through std::invoke
+	widget w;
+	w.val = 20;
+	CHECK(byMember(w, 2) == 22);
+
+	_wli::delegate<void(int&)> byRef = [](int& x) { x *= 2; };
+	int val = 4;
+	byRef(val);
+	CHECK(val == 8);
+
+	int numCalls = 0;
+	_wli::delegate<void()> discards = [&numCalls]() { return ++numCalls; }; // the result is dropped
+	discards();
+	discards();
+	CHECK(numCalls == 2);
+}
+
+// Inline and heap callables with non-trivial captures, moved around, replaced and destroyed.
+static void moves_and_lifetimes() {
+	{
+		func_t inl = [c = counted{1}](int x) { return c.val + x; };
+		func_t heap = [c = counted{2}, pad = std::string(100, 'x')](int x) { return c.val + x + static_cast<int>(pad.size()); };
+		CHECK(counted::numLive == 2);
+
+		func_t inl2 = std::move(inl);
+		func_t heap2{std::move(heap)};
+		CHECK(counted::numLive == 2 && !inl && !heap);
+		CHECK(inl2(0) == 1 && heap2(0) == 102);
+		CHECK_THROWS(inl(0), std::bad_function_call);
+
+		inl = std::move(heap2); // assigned to a moved-from one
+		heap = std::move(inl2);
+		CHECK(counted::numLive == 2 && inl(0) == 102 && heap(0) == 1);
+
+		inl = std::move(heap); // the former callable is destroyed
+		CHECK(counted::numLive == 1 && inl(0) == 1 && !heap);
+
+		func_t& self = inl;
+		inl = std::move(self);
+		CHECK(counted::numLive == 1 && inl(0) == 1);
+
+		inl = nullptr;
+		CHECK(counted::numLive == 0);
+		inl = [c = counted{3}](int x) { return c.val * x; };
+		CHECK(counted::numLive == 1 && inl(2) == 6);
+	}
+	CHECK(counted::numLive == 0);
+
+	int base = 1;
+	func_t trivial = [&base](int x) { return base + x; }; // moved by copying the buffer
+	func_t trivial2 = std::move(trivial);
+	base = 2;
+	CHECK(!trivial && trivial2(1) == 3);
+
+	auto owner = std::make_unique<int>(9);
+	func_t moveOnly = [p = std::move(owner)](int x) { return *p + x; };
+	func_t moveOnly2 = std::move(moveOnly);
+	CHECK(moveOnly2(1) == 10);
+}
+
+// The delegate can't be copied, but a callable can be copied into it, and stays usable.
+static void copied_callables() {
+	{
+		auto inl = [c = counted{4}](int x) { return c.val + x; };
+		auto heap = [c = counted{5}, pad = std::string(100, 'y')](int x) { return c.val + x; };
+		func_t fromInl = inl;
+		func_t fromHeap = heap;
+		CHECK(counted::numLive == 4);
+		CHECK(fromInl(1) == 5 && inl(1) == 5 && fromHeap(1) == 6 && heap(1) == 6);
+
+		std::function<int(int)> stdFunc = inl;
+		func_t fromStd = stdFunc; // holds a copy of the std::function
+		CHECK(counted::numLive == 6 && fromStd(2) == 6 && stdFunc(2) == 6);
+	}
+	CHECK(counted::numLive == 0);
+}
+
+int main() {
+	empty_delegates();
+	inline_and_heap();
+	moves_and_lifetimes();
+	copied_callables();
+	return CHECK_RESULT();
+}
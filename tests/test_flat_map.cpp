@@ -0,0 +1,260 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../flat_map.h"
+#include "check.h"
+using namespace wl;
+
+// Trivially copyable but larger than a pointer, so it's searched in place, without branches.
+struct wide_key final {
+	long long hi, lo;
+};
+struct wide_less final {
+	bool operator()(const wide_key& a, const wide_key& b) const noexcept {
+		return (a.hi != b.hi) ? a.hi < b.hi : a.lo < b.lo;
+	}
+};
+
+// One key type for each search strategy.
+static_assert(_wli::flat_search<int, std::less<>>::EYTZINGER);
+static_assert(!_wli::flat_search<wide_key, wide_less>::EYTZINGER && _wli::flat_search<wide_key, wide_less>::BRANCHLESS);
+static_assert(!_wli::flat_search<std::wstring, std::less<>>::BRANCHLESS);
+
+// Keys built from ints, in the same order as the ints.
+template<typename keyT> keyT make_key(int i);
+template<> int make_key<int>(int i) { return i; }
+template<> wide_key make_key<wide_key>(int i) { return {i >> 3, i & 7}; }
+template<> std::wstring make_key<std::wstring>(int i) {
+	std::wstring num = std::to_wstring(i + 100000); // no negatives, same number of digits
+	return L"key_" + num;
+}
+
+template<typename keyT, typename compareT>
+static void lower_bound_all_sizes(const char* name) {
+	std::vector<size_t> sizes;
+	for (size_t n = 0; n <= 70; ++n) sizes.emplace_back(n);
+	for (size_t n : {100, 127, 128, 129, 255, 256, 257, 1000, 1023, 1025}) sizes.emplace_back(n);
+
+	compareT comp;
+	int failures = check_failures();
+	auto keyOf = [](const keyT& k) -> const keyT& { return k; };
+	for (size_t n : sizes) {
+		std::vector<keyT> keys;
+		for (size_t i = 0; i < n; ++i) keys.emplace_back(make_key<keyT>(static_cast<int>(i * 2))); // odd keys are gaps
+		std::sort(keys.begin(), keys.end(), comp);
+		_wli::flat_search<keyT, compareT> search;
+		search.rebuild(keys, keyOf);
+
+		for (int p = -1; p <= static_cast<int>(n * 2); ++p) { // before the first, between each, after the last
+			keyT probe = make_key<keyT>(p);
+			size_t expected = static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), probe, comp) - keys.begin());
+			CHECK(search.lower_bound(keys, keyOf, comp, probe) == expected);
+		}
+		if (check_failures() != failures) {
+			std::fprintf(stderr, "  %s, %zu keys\n", name, n);
+			return;
+		}
+	}
+}
+
+template<typename keyT, typename compareT>
+static void empty_and_single() {
+	using map_t = flat_map<keyT, int, compareT>;
+	map_t m;
+	const map_t& cm = m;
+	CHECK(m.empty() && m.begin() == m.end());
+	CHECK(!m.has(make_key<keyT>(0)) && !m.get_if_exists(make_key<keyT>(0)));
+	CHECK_THROWS(cm[make_key<keyT>(0)], std::out_of_range);
+	m.remove(make_key<keyT>(0)); // no-op
+
+	m[make_key<keyT>(5)] = 50;
+	CHECK(m.size() == 1 && m.has(make_key<keyT>(5)) && cm[make_key<keyT>(5)] == 50);
+	CHECK(!m.has(make_key<keyT>(4)) && !m.has(make_key<keyT>(6)));
+	CHECK_THROWS(cm[make_key<keyT>(6)], std::out_of_range);
+	m.remove(make_key<keyT>(4));
+	CHECK(m.size() == 1);
+	m.remove(make_key<keyT>(5));
+	CHECK(m.empty() && !m.has(make_key<keyT>(5)));
+
+	flat_set<keyT, compareT> s;
+	CHECK(!s.has(make_key<keyT>(0)));
+	s.insert(make_key<keyT>(1));
+	CHECK(s.size() == 1 && s.has(make_key<keyT>(1)) && !s.has(make_key<keyT>(0)) && !s.has(make_key<keyT>(2)));
+	s.remove(make_key<keyT>(1));
+	CHECK(s.empty() && !s.has(make_key<keyT>(1)));
+}
+
+static void repeated_keys() {
+	flat_map<int, int> m{{3, 1}, {1, 1}, {3, 2}, {2, 1}, {3, 3}};
+	CHECK(m.size() == 3 && m[3] == 3 && m[1] == 1);
+
+	std::vector<flat_map<int, int>::entry> entries{{7, 1}, {7, 2}, {0, 1}, {7, 3}, {0, 2}};
+	m.assign(std::move(entries)); // the last of each key wins
+	CHECK(m.size() == 2 && m[7] == 3 && m[0] == 2 && !m.has(3));
+
+	m.insert_range({{5, 1}, {7, 10}, {5, 2}, {-1, 1}, {7, 20}}); // repeated among themselves and with existing keys
+	CHECK(m.size() == 4 && m[-1] == 1 && m[0] == 2 && m[5] == 2 && m[7] == 20);
+	std::vector<int> keys;
+	for (const auto& e : m) keys.emplace_back(e.key);
+	CHECK(keys == std::vector<int>({-1, 0, 5, 7}));
+
+	std::vector<std::pair<std::wstring, int>> pairs{{L"b", 1}, {L"a", 1}, {L"b", 2}};
+	flat_map<std::wstring, int> w{{L"b", 0}, {L"c", 0}};
+	w.insert_range(pairs.begin(), pairs.end());
+	CHECK(w.size() == 3 && w[L"a"] == 1 && w[L"b"] == 2 && w[L"c"] == 0);
+
+	flat_set<int> s{4, 2, 4, 4, 1, 2};
+	CHECK(s.size() == 3 && s.has(1) && s.has(2) && s.has(4));
+	s.insert_range({4, 0, 0, 9});
+	std::vector<int> setKeys(s.begin(), s.end());
+	CHECK(setKeys == std::vector<int>({0, 1, 2, 4, 9}));
+}
+
+static void transparent_lookups() {
+	flat_map<std::wstring, int> m{{L"beta", 2}, {L"alpha", 1}};
+	const flat_map<std::wstring, int>& cm = m;
+	CHECK(m.has(L"alpha") && m.has(std::wstring_view{L"beta"}) && !m.has(L"gamma"));
+	CHECK(cm[L"beta"] == 2 && !m.get_if_exists(std::wstring_view{L"alph"}));
+	CHECK_THROWS(cm[L"gamma"], std::out_of_range);
+	m[L"delta"] = 4; // added from the literal
+	CHECK(m.size() == 3 && m.begin()->key == L"alpha" && std::next(m.begin())->key == L"beta");
+	m.remove(std::wstring_view{L"alpha"});
+	CHECK(m.size() == 2 && !m.has(L"alpha") && m.has(L"delta"));
+
+	flat_map<int, int> ints{{1, 10}, {3, 30}};
+	CHECK(ints.has(3LL) && !ints.has(2LL) && *ints.get_if_exists(1LL) == 10); // the Eytzinger copy, compared to another type
+
+	flat_set<std::wstring> s{L"x", L"y"};
+	CHECK(s.has(L"x") && s.has(std::wstring_view{L"y"}) && !s.has(L"z"));
+	s.remove(L"x");
+	CHECK(s.size() == 1 && !s.has(L"x"));
+}
+
+// Every lookup, existing or not, agrees with the reference, and so does the iteration order.
+template<typename mapT, typename refT>
+static void check_same(const mapT& m, const refT& ref, int maxKey) {
+	using keyT = typename refT::key_type;
+	CHECK(m.size() == ref.size());
+	for (int i = -1; i <= maxKey + 1; ++i) {
+		keyT key = make_key<keyT>(i);
+		auto it = ref.find(key);
+		const int* val = m.get_if_exists(key);
+		CHECK(it == ref.end() ? (!val && !m.has(key)) : (val && *val == it->second && m.has(key)));
+	}
+	auto it = ref.begin();
+	for (const auto& e : m) {
+		CHECK(it != ref.end() && !ref.key_comp()(e.key, it->first) && !ref.key_comp()(it->first, e.key));
+		if (it != ref.end()) ++it;
+	}
+}
+
+template<typename setT, typename refT>
+static void check_same_set(const setT& s, const refT& ref, int maxKey) {
+	using keyT = typename refT::key_type;
+	CHECK(s.size() == ref.size());
+	for (int i = -1; i <= maxKey + 1; ++i) {
+		keyT key = make_key<keyT>(i);
+		CHECK(s.has(key) == (ref.find(key) != ref.end()));
+	}
+}
+
+// The search copy is rebuilt on every change: each kind of change is checked against std::map.
+template<typename keyT, typename compareT>
+static void random_against_reference(const char* name) {
+	const int MAX_KEY = 200;
+	unsigned seed = 5;
+	auto next = [&seed](int limit) {
+		seed = seed * 1103515245u + 12345u;
+		return static_cast<int>((seed >> 8) % static_cast<unsigned>(limit));
+	};
+	using map_t = flat_map<keyT, int, compareT>;
+	map_t m;
+	std::map<keyT, int, compareT> ref;
+	flat_set<keyT, compareT> s;
+	std::set<keyT, compareT> refSet;
+	int failures = check_failures();
+
+	for (int step = 0; step < 1500; ++step) {
+		int op = next(100);
+		if (op < 40) {
+			int k = next(MAX_KEY);
+			m[make_key<keyT>(k)] = step;
+			ref[make_key<keyT>(k)] = step;
+			s.insert(make_key<keyT>(k));
+			refSet.insert(make_key<keyT>(k));
+		} else if (op < 70) {
+			int k = next(MAX_KEY);
+			m.remove(make_key<keyT>(k));
+			ref.erase(make_key<keyT>(k));
+			s.remove(make_key<keyT>(k));
+			refSet.erase(make_key<keyT>(k));
+		} else if (op < 90) {
+			std::vector<std::pair<keyT, int>> added;
+			for (int i = next(12); i > 0; --i) added.emplace_back(make_key<keyT>(next(MAX_KEY)), step * 100 + i);
+			m.insert_range(added.begin(), added.end());
+			for (const auto& p : added) ref[p.first] = p.second; // the last one wins
+			std::vector<keyT> addedKeys;
+			for (const auto& p : added) addedKeys.emplace_back(p.first);
+			s.insert_range(addedKeys.begin(), addedKeys.end());
+			refSet.insert(addedKeys.begin(), addedKeys.end());
+		} else if (op < 97) {
+			std::vector<typename map_t::entry> entries;
+			std::vector<keyT> keys;
+			ref.clear();
+			refSet.clear();
+			for (int i = next(60); i > 0; --i) {
+				int k = next(MAX_KEY);
+				entries.emplace_back(make_key<keyT>(k), i);
+				keys.emplace_back(make_key<keyT>(k));
+				ref[make_key<keyT>(k)] = i;
+				refSet.insert(make_key<keyT>(k));
+			}
+			m.assign(std::move(entries));
+			s.assign(std::move(keys));
+		} else {
+			map_t copy = m; // has its own search copy
+			m.clear();
+			s.clear();
+			check_same(copy, ref, MAX_KEY);
+			ref.clear();
+			refSet.clear();
+		}
+		check_same(m, ref, MAX_KEY);
+		check_same_set(s, refSet, MAX_KEY);
+		if (check_failures() != failures) {
+			std::fprintf(stderr, "  %s, at step %d\n", name, step);
+			break;
+		}
+	}
+}
+
+int main() {
+	lower_bound_all_sizes<int, std::less<>>("int");
+	lower_bound_all_sizes<int, std::greater<>>("int, descending");
+	lower_bound_all_sizes<wide_key, wide_less>("wide_key");
+	lower_bound_all_sizes<std::wstring, std::less<>>("std::wstring");
+	empty_and_single<int, std::less<>>();
+	empty_and_single<wide_key, wide_less>();
+	empty_and_single<std::wstring, std::less<>>();
+	repeated_keys();
+	transparent_lookups();
+	random_against_reference<int, std::less<>>("int");
+	random_against_reference<int, std::greater<>>("int, descending");
+	random_against_reference<wide_key, wide_less>("wide_key");
+	random_against_reference<std::wstring, std::less<>>("std::wstring");
+	return CHECK_RESULT();
+}
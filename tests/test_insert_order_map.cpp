@@ -0,0 +1,309 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../insert_order_map.h"
+#include "check.h"
+using namespace wl;
+
+// Counts the hashes, which tells whether lookups go through the index; hash values can be
+// made to collide, to exercise the probing.
+struct counting_key final {
+	static inline size_t numHashes = 0;
+	static inline bool collide = false;
+	static constexpr bool HASHABLE = true;
+	template<typename T>
+	static constexpr bool LOOKUP_BY = false;
+
+	static size_t hash(int key) noexcept {
+		++numHashes;
+		return collide ? 42 : std::hash<int>{}(key);
+	}
+	static bool equal(int a, int b) noexcept { return a == b; }
+};
+
+// Has operator== but no std::hash, so lookups always scan.
+struct point final {
+	int x, y;
+	bool operator==(const point& other) const noexcept { return this->x == other.x && this->y == other.y; }
+};
+
+template<typename mapT>
+static std::vector<int> values_in_order(const mapT& m) {
+	std::vector<int> values;
+	for (const auto& e : m) values.emplace_back(e.value);
+	return values;
+}
+
+static void index_built_past_threshold() {
+	insert_order_map<int, int, counting_key> m;
+	for (int i = 0; i < 15; ++i) m[i * 7] = i;
+	CHECK(m.has(14) && !m.has(15));
+	CHECK(counting_key::numHashes == 0); // small maps only scan
+
+	m[15 * 7] = 15; // 16th entry, the index is built
+	CHECK(counting_key::numHashes == 16);
+	CHECK(m.has(15 * 7));
+	CHECK(counting_key::numHashes == 17);
+
+	for (int i = 16; i < 1000; ++i) m[i * 7] = i; // grows a few times
+	for (int i = 0; i < 1000; ++i) {
+		CHECK(m.get_if_exists(i * 7) && *m.get_if_exists(i * 7) == i);
+		CHECK(!m.has(i * 7 + 1));
+	}
+	CHECK(m.size() == 1000);
+	std::vector<int> values = values_in_order(m);
+	for (int i = 0; i < 1000; ++i) CHECK(values[i] == i); // insertion order kept across rebuilds
+
+	for (int i = 0; i < 993; ++i) m.remove(i * 7); // below half the threshold, back to scans
+	size_t numHashes = counting_key::numHashes;
+	CHECK(m.size() == 7 && m.has(999 * 7) && !m.has(0));
+	CHECK(counting_key::numHashes == numHashes);
+	for (int i = 0; i < 20; ++i) m[-i - 1] = i; // past the threshold again
+	CHECK(counting_key::numHashes > numHashes);
+	CHECK(m.size() == 27 && m[-20] == 19 && m[999 * 7] == 999);
+}
+
+static void colliding_and_unhashable_keys() {
+	counting_key::collide = true;
+	insert_order_map<int, int, counting_key> m;
+	for (int i = 0; i < 200; ++i) m[i] = -i;
+	for (int i = 0; i < 200; i += 3) m.remove(i); // tombstones in the middle of the probe chain
+	for (int i = 0; i < 200; ++i) CHECK(m.has(i) == (i % 3 != 0));
+	m[0] = 100;
+	CHECK(m.size() == 134 && m[0] == 100 && m[199] == -199);
+	counting_key::collide = false;
+
+	insert_order_map<point, int> pts; // no index, ever
+	for (int i = 0; i < 100; ++i) pts[point{i, -i}] = i;
+	point found{42, -42}, notFound{42, 42};
+	CHECK(pts.size() == 100 && pts[found] == 42 && !pts.has(notFound));
+	pts.remove(point{0, 0});
+	CHECK(pts.size() == 99 && pts.begin()->value == 1);
+}
+
+static void lookups_and_insertions() {
+	for (size_t numEntries : {0, 1, 15, 16, 17, 100}) {
+		insert_order_map<std::wstring, int> m;
+		for (size_t i = 0; i < numEntries; ++i) m[L"key" + std::to_wstring(i)] = static_cast<int>(i);
+		const auto& cm = m;
+		for (size_t i = 0; i < numEntries; ++i) CHECK(cm[L"key" + std::to_wstring(i)] == static_cast<int>(i));
+		CHECK_THROWS(cm[L"none"], std::out_of_range);
+		CHECK(!m.get_if_exists(L"none") && m.size() == numEntries);
+		m[L"none"] = 5; // non-const operator[] adds
+		CHECK(m.size() == numEntries + 1 && std::prev(m.end())->value == 5);
+		if (numEntries) {
+			m[L"key0"] = -1; // replaced in place
+			CHECK(m.begin()->value == -1 && m.size() == numEntries + 1);
+		}
+	}
+
+	for (size_t numEntries : {4, 40}) { // repeated keys in a list: the first one wins
+		std::vector<insert_order_map<std::wstring, int>::entry> list;
+		for (size_t i = 0; i < numEntries; ++i) list.emplace_back(L"k" + std::to_wstring(i), static_cast<int>(i));
+		list.emplace_back(L"k1", 99);
+		insert_order_map<std::wstring, int> m{};
+		m.insert_range(list.begin(), list.end());
+		CHECK(m[L"k1"] == 99 && m.size() == numEntries); // insert_range replaces values instead
+	}
+	insert_order_map<std::wstring, int> withRepeats{{L"a", 1}, {L"b", 2}, {L"a", 3}};
+	CHECK(withRepeats[L"a"] == 1);
+
+	insert_order_map<std::wstring, int> src;
+	for (int i = 0; i < 50; ++i) src[std::to_wstring(i)] = i;
+	insert_order_map<std::wstring, int> moved{std::move(src)};
+	CHECK(src.empty() && moved.size() == 50 && moved[L"49"] == 49);
+	src = std::move(moved);
+	CHECK(src[L"25"] == 25 && !src.has(L"50"));
+}
+
+static void transparent_and_ignore_case() {
+	insert_order_map<std::wstring, int> m;
+	for (int i = 0; i < 30; ++i) m[L"item" + std::to_wstring(i)] = i;
+	const wchar_t text[] = L"item12345";
+	CHECK(m.has(std::wstring_view{text, 6}) && *m.get_if_exists(std::wstring_view{text, 6}) == 12); // no null terminator there
+	CHECK(m.has(L"item7") && !m.has(std::wstring_view{text, 4}));
+	m[std::wstring_view{text, 9}] = 1; // a key is built only when adding
+	CHECK(m.size() == 31 && m[L"item12345"] == 1);
+	m.remove(std::wstring_view{text, 6});
+	CHECK(!m.has(L"item12") && m.size() == 30);
+
+	for (int numEntries : {3, 100}) {
+		insert_order_map<std::wstring, int, map_key::ignore_case> ci;
+		for (int i = 0; i < numEntries; ++i) ci[L"Key" + std::to_wstring(i)] = i;
+		ci[L"ΣΊΣΥΦΟΣ"] = -1;
+		CHECK(ci[L"KEY2"] == 2 && ci[std::wstring_view{L"key1"}] == 1);
+		CHECK(ci.has(L"σίσυφος") && ci.has(L"ΣΊΣΥΦΟς"));
+		ci[L"kEy0"] = 50;
+		CHECK(ci.size() == static_cast<size_t>(numEntries) + 1);
+		CHECK(ci.begin()->key == L"Key0" && ci.begin()->value == 50); // the first spelling is kept
+		CHECK(!ci.has(L"Kéy0"));
+		ci.remove(L"KEY1");
+		CHECK(!ci.has(L"key1") && ci.size() == static_cast<size_t>(numEntries));
+	}
+}
+
+template<typename mapT>
+static std::vector<int> values_in_reverse(const mapT& m) {
+	std::vector<int> values;
+	for (auto it = m.rbegin(); it != m.rend(); ++it) values.emplace_back(it->value);
+	return values;
+}
+
+static void tombstones_and_compaction() {
+	insert_order_map<int, int> m;
+	for (int i = 0; i < 100; ++i) m[i] = i;
+	auto last = std::prev(m.end());
+	for (int i = 0; i < 100; i += 3) m.remove(i); // 34 removed, not yet half: flagged only
+	CHECK(m.size() == 66);
+	CHECK(last->key == 99); // iterators to other entries stay valid until a compaction
+	std::vector<int> expected;
+	for (int i = 0; i < 100; ++i) if (i % 3) expected.emplace_back(i);
+	CHECK(values_in_order(m) == expected);
+	CHECK(values_in_reverse(m) == std::vector<int>(expected.rbegin(), expected.rend()));
+	CHECK(m.begin()->key == 1 && m.rbegin()->key == 98 && std::prev(m.end())->key == 98);
+	CHECK(std::distance(m.begin(), m.end()) == 66);
+	CHECK(m.rbegin().base() == m.end());
+
+	for (int i = 1; i < 100; i += 3) m.remove(i); // past half, compacted, positions change
+	expected.clear();
+	for (int i = 0; i < 100; ++i) if (i % 3 == 2) expected.emplace_back(i);
+	CHECK(m.size() == 33 && values_in_order(m) == expected);
+	for (int i = 0; i < 100; ++i) { // the index points to the new positions
+		const int* val = m.get_if_exists(i);
+		CHECK((i % 3 == 2) ? (val && *val == i) : !val);
+	}
+	m[1000] = 1000; // appended after the survivors
+	CHECK(std::prev(m.end())->value == 1000 && m[2] == 2);
+
+	m.remove(5).remove(8).remove(1000).shrink_to_fit(); // drops the flagged ones right away
+	CHECK(m.size() == 31 && m.begin()->key == 2 && std::next(m.begin())->key == 11);
+	CHECK(m[98] == 98 && !m.has(8));
+
+	insert_order_map<int, int> single;
+	for (int i = 0; i < 20; ++i) single[i] = i;
+	for (int i = 0; i < 19; ++i) single.remove(i);
+	CHECK(single.size() == 1 && single.begin()->key == 19 && single.rbegin()->key == 19);
+	single.remove(19);
+	CHECK(single.empty() && single.begin() == single.end() && single.rbegin() == single.rend());
+}
+
+static void bulk_operations() {
+	insert_order_map<int, int> m;
+	for (int i = 0; i < 100; ++i) m[i] = i;
+	m.remove(50);
+	size_t numCalls = 0;
+	m.remove_if([&numCalls](const insert_order_map<int, int>::entry& e) { ++numCalls; return e.key % 2 == 0; });
+	CHECK(numCalls == 99); // removed entries aren't offered again
+	CHECK(m.size() == 50 && m.begin()->key == 1 && !m.has(2) && m[99] == 99);
+	m.remove_if([](const insert_order_map<int, int>::entry&) { return false; });
+	CHECK(m.size() == 50);
+
+	insert_order_map<int, int> other;
+	for (int i = 95; i < 110; ++i) other[i] = -i;
+	m.merge(other); // overlapping keys keep their place and take the new value
+	CHECK(m.size() == 62 && m[97] == -97 && other.size() == 15);
+	CHECK(std::prev(m.end())->key == 109 && std::next(m.begin(), 47)->key == 95);
+
+	m.merge(std::move(other));
+	CHECK(other.empty() && m.size() == 62);
+
+	std::vector<int> before = values_in_order(m);
+	m.merge(m); // merging into itself changes nothing
+	CHECK(values_in_order(m) == before);
+	m.merge(std::move(m));
+	CHECK(values_in_order(m) == before && m[109] == -109);
+
+	insert_order_map<std::wstring, std::wstring> strs, moreStrs;
+	for (int i = 0; i < 30; ++i) moreStrs[std::to_wstring(i)] = L"value " + std::to_wstring(i);
+	strs.merge(std::move(moreStrs)); // into an empty map, which takes everything
+	CHECK(strs.size() == 30 && strs[L"29"] == L"value 29" && moreStrs.empty());
+
+	std::vector<std::pair<std::wstring, std::wstring>> pairs = {{L"29", L"new"}, {L"x", L"y"}};
+	strs.insert_range(pairs.begin(), pairs.end());
+	CHECK(strs.size() == 31 && strs[L"29"] == L"new" && std::prev(strs.end())->key == L"x");
+}
+
+// Random mixes of every operation, against a plain vector in insertion order.
+static void random_against_reference() {
+	unsigned seed = 11;
+	auto next = [&seed](unsigned n) { seed = seed * 1103515245u + 12345u; return static_cast<int>((seed >> 8) % n); };
+	insert_order_map<int, int> m;
+	std::vector<std::pair<int, int>> ref;
+	auto refFind = [&ref](int key) {
+		return std::find_if(ref.begin(), ref.end(), [key](const std::pair<int, int>& p) { return p.first == key; });
+	};
+
+	for (int step = 0; step < 20000; ++step) {
+		int op = next(100), key = next(step % 4000 < 2000 ? 300 : 40); // sizes go up and down across the threshold
+		if (op < 45) {
+			m[key] = step;
+			auto it = refFind(key);
+			if (it == ref.end()) ref.emplace_back(key, step);
+			else it->second = step;
+		} else if (op < 90) {
+			m.remove(key);
+			auto it = refFind(key);
+			if (it != ref.end()) ref.erase(it);
+		} else if (op < 93) {
+			int mod = 2 + next(5);
+			m.remove_if([mod](const insert_order_map<int, int>::entry& e) { return e.key % mod == 0; });
+			ref.erase(std::remove_if(ref.begin(), ref.end(), [mod](const std::pair<int, int>& p) { return p.first % mod == 0; }), ref.end());
+		} else if (op < 97) {
+			insert_order_map<int, int> other;
+			for (int i = next(10); i; --i) {
+				int k = next(300);
+				other[k] = -step;
+				auto it = refFind(k);
+				if (it == ref.end()) ref.emplace_back(k, -step);
+				else it->second = -step;
+			}
+			if (op % 2) m.merge(other);
+			else m.merge(std::move(other));
+		} else {
+			m.shrink_to_fit();
+		}
+
+		if (m.size() != ref.size()) {
+			CHECK(m.size() == ref.size());
+			break;
+		}
+		std::vector<int> keys, refKeys;
+		for (const auto& e : m) keys.emplace_back(e.key);
+		for (const auto& p : ref) refKeys.emplace_back(p.first);
+		CHECK(keys == refKeys);
+		std::vector<int> revKeys;
+		for (auto it = m.rbegin(); it != m.rend(); ++it) revKeys.emplace_back(it->key);
+		CHECK(revKeys == std::vector<int>(refKeys.rbegin(), refKeys.rend()));
+		for (int i = 0; i < 5; ++i) {
+			int k = next(300);
+			const int* val = m.get_if_exists(k);
+			auto it = refFind(k);
+			CHECK(it == ref.end() ? !val : (val && *val == it->second));
+		}
+		if (check_failures()) {
+			std::fprintf(stderr, "  at step %d\n", step);
+			break;
+		}
+	}
+}
+
+int main() {
+	index_built_past_threshold();
+	colliding_and_unhashable_keys();
+	lookups_and_insertions();
+	transparent_and_ignore_case();
+	tombstones_and_compaction();
+	bulk_operations();
+	random_against_reference();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,120 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../search_index.h"
+#include "check.h"
+using namespace wl;
+using match = search_index::match;
+
+static unsigned seed = 777;
+
+static unsigned rnd(unsigned n) {
+	seed = seed * 1103515245u + 12345u;
+	return (seed >> 8) % n;
+}
+
+static std::wstring random_name() {
+	static const wchar_t chars[] = L"abcdeABCDE01_ .-";
+	std::wstring s(1 + rnd(12), L'\0');
+	for (wchar_t& ch : s) ch = chars[rnd(sizeof(chars) / sizeof(wchar_t) - 1)];
+	return s;
+}
+
+static std::wstring lower(std::wstring s) {
+	for (wchar_t& ch : s) if (ch >= L'A' && ch <= L'Z') ch += 0x20;
+	return s;
+}
+
+static bool brute_match(const std::wstring& name, const std::wstring& query, match how) {
+	std::wstring s = lower(name), q = lower(query);
+	if (how == match::PREFIX) return s.compare(0, q.length(), q) == 0;
+	if (how == match::SUBSTRING) return s.find(q) != std::wstring::npos;
+	size_t qi = 0;
+	for (size_t si = 0; si < s.length() && qi < q.length(); ++si) qi += (s[si] == q[qi]);
+	return qi == q.length();
+}
+
+// The ids found must be exactly those of a brute-force scan, ranked best first.
+static bool same_as_brute_force(const search_index& index, const std::vector<std::wstring>& names,
+	const std::vector<bool>& alive, const std::wstring& query, match how)
+{
+	std::vector<search_index::result> found = index.find(query, how);
+	for (size_t i = 1; i < found.size(); ++i) {
+		if (found[i].score > found[i - 1].score) return false;
+	}
+	std::vector<size_t> ids;
+	for (const search_index::result& r : found) ids.emplace_back(r.id);
+	std::sort(ids.begin(), ids.end());
+
+	std::vector<size_t> expected;
+	for (size_t id = 0; id < names.size(); ++id) {
+		if (alive[id] && brute_match(names[id], query, how)) expected.emplace_back(id);
+	}
+	return ids == expected;
+}
+
+static void random_queries() {
+	std::vector<std::wstring> names;
+	for (int i = 0; i < 5000; ++i) names.emplace_back(random_name());
+	std::vector<bool> alive(names.size(), true);
+	search_index index{names};
+
+	for (int round = 0; round < 4; ++round) {
+		for (int i = 0; i < 150; ++i) {
+			std::wstring query = random_name().substr(0, 1 + rnd(4));
+			for (match how : {match::PREFIX, match::SUBSTRING, match::FUZZY}) {
+				if (!same_as_brute_force(index, names, alive, query, how)) {
+					std::fprintf(stderr, "Mismatch for \"%ls\", match %d, round %d.\n", query.c_str(), static_cast<int>(how), round);
+					CHECK(false);
+					return;
+				}
+			}
+		}
+		for (size_t id = 0; id < names.size(); ++id) { // remove 3/4, which compacts, then replace some
+			if (rnd(4)) {
+				index.remove(id);
+				alive[id] = false;
+			} else if (alive[id] && !rnd(4)) {
+				names[id] = random_name();
+				index.add(id, names[id]);
+			}
+		}
+		for (size_t id = 0; id < names.size(); id += 3) {
+			if (!alive[id]) {
+				names[id] = random_name();
+				index.add(id, names[id]);
+				alive[id] = true;
+			}
+		}
+		CHECK(index.size() == static_cast<size_t>(std::count(alive.begin(), alive.end(), true)));
+	}
+}
+
+static void ranking_and_refine() {
+	search_index index{std::vector<std::wstring>{
+		L"Meeting notes.txt", L"notes.txt", L"my notes", L"Annotated.pdf", L"n_o_t_e_s", L"Café Menu"}};
+	std::vector<size_t> ids = index.find_ids(L"notes", match::FUZZY);
+	CHECK(ids.size() == 4); // "Annotated.pdf" has no s
+	CHECK(ids[0] == 1); // word start at the beginning, shortest
+	CHECK(ids.back() == 4); // scattered match ranks last
+
+	std::vector<search_index::result> prev = index.find(L"no", match::SUBSTRING);
+	std::vector<search_index::result> refined = index.refine(prev, L"note", match::SUBSTRING);
+	CHECK(refined.size() == index.find(L"note", match::SUBSTRING).size());
+	CHECK(index.find(L"CAFÉ", match::PREFIX).size() == 1); // case-folded beyond ASCII
+	CHECK(index.find_ids(L"", match::FUZZY).size() == 6);
+	CHECK(index.find_ids(L"notes", match::FUZZY, 2).size() == 2);
+}
+
+int main() {
+	random_queries();
+	ranking_and_refine();
+	return CHECK_RESULT();
+}
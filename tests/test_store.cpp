@@ -0,0 +1,161 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../internals/store.h"
+#include "check.h"
+using namespace wl;
+
+using ntf_id = std::pair<UINT_PTR, UINT>; // {idFrom, code}
+
+// Calls the handler of the id, or returns -1 if there's none.
+template<typename idT, typename retT>
+static retT call(_wli::store<idT, retT>& s, idT id) {
+	auto* func = s.find(id);
+	return func ? (*func)({0, 0, 0}) : -1;
+}
+
+// Each handler returns its own number; every id is checked against the reference, both before
+// and after freeze(), along with the probes, which have no handlers.
+template<typename idT, typename retT>
+static void check_lookups(_wli::store<idT, retT>& s, const std::map<idT, retT>& ref, const std::vector<idT>& probes) {
+	for (int pass = 0; pass < 2; ++pass) {
+		for (const auto& p : ref) CHECK(call(s, p.first) == p.second);
+		for (const idT& id : probes) {
+			if (ref.find(id) == ref.end()) CHECK(call(s, id) == -1);
+		}
+		s.freeze();
+	}
+}
+
+static void ids_around_wm_user() {
+	_wli::store<UINT, LRESULT> s;
+	std::map<UINT, LRESULT> ref;
+	LRESULT num = 0;
+	auto add = [&](UINT id) {
+		++num;
+		s.add(id, [num](params) -> LRESULT { return num; });
+		ref[id] = num;
+	};
+	for (UINT id : {0u, 1u, 0x3FEu, 0x3FFu, 0x400u, 0x401u, 0x7FFFu, 0x8000u, 0xC000u, 0xFFFFu, 0x10000u, 0xFFFFFFFFu}) add(id);
+	CHECK(call(s, 2u) == -1);
+	for (UINT id = WM_APP + 1; id < WM_APP + 30; ++id) add(id); // past the linear search limit
+	add(0x3FFu); // a later handler replaces the former, in the array and in the hash table
+	add(WM_APP + 5);
+	CHECK(call(s, 0x3FFu) == ref[0x3FF]);
+
+	std::vector<UINT> probes{2, 0x3FD, 0x402, 0x7FFE, 0x8001 + 100, 0xC001, 0x10001, 0xFFFFFFFE};
+	for (UINT id = 0; id < 0x1000; ++id) probes.emplace_back(id);
+	check_lookups(s, ref, probes);
+
+	add(0x200u); // unfrozen, then frozen again
+	add(WM_APP + 1000);
+	check_lookups(s, ref, probes);
+
+	_wli::store<UINT, LRESULT> few; // too few to build the table, still found after freeze()
+	few.add(WM_NOTIFY, [](params) -> LRESULT { return 7; });
+	few.add(WM_APP, [](params) -> LRESULT { return 8; });
+	few.freeze();
+	CHECK(call(few, static_cast<UINT>(WM_NOTIFY)) == 7 && call(few, static_cast<UINT>(WM_APP)) == 8 && call(few, 0u) == -1);
+
+	_wli::store<UINT, LRESULT> none;
+	none.freeze();
+	CHECK(none.empty() && call(none, 0u) == -1 && call(none, static_cast<UINT>(WM_APP)) == -1);
+}
+
+static void commands_and_notifications() {
+	_wli::store<WORD, INT_PTR> cmds; // WM_COMMAND ids: menu and control ids are WORDs
+	std::map<WORD, INT_PTR> cmdRef;
+	for (WORD i = 0; i < 40; ++i) {
+		WORD id = static_cast<WORD>((i % 2) ? 100 + i : 40000 + i);
+		cmds.add(id, [i](params) -> INT_PTR { return i; });
+		cmdRef[id] = i;
+	}
+	std::vector<WORD> cmdProbes{0, 1, 99, 0xFFFF};
+	for (WORD id = 39990; id < 40050; ++id) cmdProbes.emplace_back(id);
+	check_lookups(cmds, cmdRef, cmdProbes);
+
+	_wli::store<ntf_id, LRESULT> ntfs; // WM_NOTIFY {idFrom, code}, codes are negative
+	std::map<ntf_id, LRESULT> ntfRef;
+	LRESULT num = 0;
+	for (UINT_PTR idFrom = 1000; idFrom < 1010; ++idFrom) {
+		for (UINT code : {static_cast<UINT>(-2), static_cast<UINT>(-3), static_cast<UINT>(-101)}) { // NM_CLICK, NM_DBLCLK, LVN_ITEMCHANGED
+			++num;
+			ntfs.add({idFrom, code}, [num](params) -> LRESULT { return num; });
+			ntfRef[{idFrom, code}] = num;
+		}
+	}
+	ntfs.add({ntf_id{2000, 1}, ntf_id{2001, 1}, ntf_id{1000, static_cast<UINT>(-2)}}, // one handler for many ids
+		[](params) -> LRESULT { return 77; });
+	ntfRef[{2000, 1}] = ntfRef[{2001, 1}] = ntfRef[{1000, static_cast<UINT>(-2)}] = 77;
+	std::vector<ntf_id> ntfProbes{{0, 0}, {1000, 1}, {2000, 2}, {2002, 1}, {1010, static_cast<UINT>(-2)}};
+	for (UINT_PTR idFrom = 990; idFrom < 1020; ++idFrom) ntfProbes.emplace_back(idFrom, static_cast<UINT>(-3));
+	check_lookups(ntfs, ntfRef, ntfProbes);
+}
+
+// The MurmurHash3 finalizer, which the store hashes ids with.
+static unsigned long long mix(unsigned long long h) {
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDull;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ull;
+	return h ^ (h >> 33);
+}
+
+static void table_growth() {
+	// 40 ids make a table of 128 slots. Two ids whose hashes agree in the bits which pick their
+	// bucket, first slot and step in 128 slots always land on the same slot, so the table must grow.
+	const unsigned long long MASK = 127;
+	std::unordered_map<unsigned long long, UINT> seen;
+	UINT first = 0, second = 0;
+	for (UINT id = WM_APP + 100; !second; ++id) {
+		unsigned long long h = mix(id);
+		auto it = seen.emplace((h & MASK) | ((h >> 32) & MASK) << 7, id).first;
+		if (it->second != id) {
+			first = it->second;
+			second = id;
+		}
+	}
+	_wli::store<UINT, LRESULT> s;
+	std::map<UINT, LRESULT> ref;
+	std::vector<UINT> ids{first, second};
+	for (UINT id = WM_APP; id < WM_APP + 38; ++id) ids.emplace_back(id);
+	for (UINT id : ids) {
+		s.add(id, [id](params) -> LRESULT { return id; });
+		ref[id] = id;
+	}
+	std::vector<UINT> probes;
+	for (UINT id = WM_APP; id < second + 10; ++id) probes.emplace_back(id);
+	check_lookups(s, ref, probes);
+
+	if constexpr (sizeof(UINT_PTR) == 8) {
+		// {0, code} and {code / 0x9E3779B97F4A7C15, 0} have the same hash, so they never fit,
+		// however large the table; freeze() keeps the linear search.
+		const UINT code = 12345;
+		_wli::store<ntf_id, LRESULT> ntfs;
+		std::map<ntf_id, LRESULT> ntfRef;
+		std::vector<ntf_id> ntfIds{{0, code}, {static_cast<UINT_PTR>(code * 0xF1DE83E19937733Dull), 0}};
+		for (UINT_PTR idFrom = 1; idFrom < 40; ++idFrom) ntfIds.emplace_back(idFrom, 0);
+		LRESULT num = 0;
+		for (const ntf_id& id : ntfIds) {
+			++num;
+			ntfs.add(id, [num](params) -> LRESULT { return num; });
+			ntfRef[id] = num;
+		}
+		check_lookups(ntfs, ntfRef, std::vector<ntf_id>{{0, 0}, {0, code + 1}, {40, 0}});
+	}
+}
+
+int main() {
+	ids_around_wm_user();
+	commands_and_notifications();
+	table_growth();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,111 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <clocale>
+#include <cwctype>
+#include <string>
+#include "../str.h"
+#include "check.h"
+using namespace wl;
+using namespace wl::_wli;
+
+struct case_row final {
+	wchar_t ch, upper, lower, folded, stripped;
+};
+
+// Simple mappings of Unicode, including the odd ones which don't round-trip.
+static void known_mappings() {
+	const case_row ROWS[] = {
+		{L'a',    L'A',    L'a',    L'a',    L'a'},
+		{L'Z',    L'Z',    L'z',    L'z',    L'Z'},
+		{L'1',    L'1',    L'1',    L'1',    L'1'},
+		{0x00E9,  0x00C9,  0x00E9,  0x00E9,  L'e'},    // é
+		{0x00C7,  0x00C7,  0x00E7,  0x00E7,  L'C'},    // Ç
+		{0x00FF,  0x0178,  0x00FF,  0x00FF,  L'y'},    // ÿ uppercases outside Latin-1
+		{0x00DF,  0x00DF,  0x00DF,  0x00DF,  0x00DF},  // ß has no simple uppercase
+		{0x1E9E,  0x1E9E,  0x00DF,  0x00DF,  0x1E9E},  // capital sharp s
+		{0x00B5,  0x039C,  0x00B5,  0x03BC,  0x00B5},  // micro sign folds to Greek mu
+		{0x03A3,  0x03A3,  0x03C3,  0x03C3,  0x03A3},  // Σ
+		{0x03C2,  0x03A3,  0x03C2,  0x03C3,  0x03C2},  // final sigma
+		{0x01C5,  0x01C4,  0x01C6,  0x01C6,  0x01C5},  // titlecase Dž
+		{0x0130,  0x0130,  L'i',    0x0130,  L'I'},    // İ
+		{0x0131,  L'I',    0x0131,  0x0131,  0x0131},  // dotless ı
+		{0x017F,  L'S',    0x017F,  0x017F,  0x017F},  // long s doesn't fold into ASCII
+		{0x212A,  0x212A,  L'k',    0x212A,  0x212A},  // Kelvin sign doesn't fold into ASCII either
+		{0x212B,  0x212B,  0x00E5,  0x00E5,  0x212B},  // Angstrom sign
+		{0x0401,  0x0401,  0x0451,  0x0451,  0x0415},  // Ё
+		{0x10A0,  0x10A0,  0x2D00,  0x2D00,  0x10A0},  // Georgian
+		{0xFF21,  0xFF21,  0xFF41,  0xFF41,  0xFF21},  // fullwidth A
+	};
+	for (const case_row& row : ROWS) {
+		CHECK(str_case::to_upper(row.ch) == row.upper);
+		CHECK(str_case::to_lower(row.ch) == row.lower);
+		CHECK(str_case::fold(row.ch) == row.folded);
+		CHECK(str_case::strip_diacritic(row.ch) == row.stripped);
+		if (check_failures()) {
+			std::fprintf(stderr, "  at U+%04X\n", static_cast<unsigned>(row.ch));
+			return;
+		}
+	}
+}
+
+// Where the CRT has Unicode tables, they must agree with ours on the scripts whose mappings are
+// stable across Unicode versions: Latin, Greek, Cyrillic, Armenian, and the fullwidth forms.
+static void same_as_crt() {
+	if (!std::setlocale(LC_CTYPE, "C.UTF-8") && !std::setlocale(LC_CTYPE, ".UTF-8")) {
+		std::printf("No UTF-8 locale, comparison with towupper/towlower skipped.\n");
+		return;
+	}
+	const unsigned RANGES[][2] = {{0x0000, 0x058F}, {0x1E00, 0x1EFF}, {0xFF00, 0xFFEF}};
+	for (const auto& range : RANGES) {
+		for (unsigned c = range[0]; c <= range[1]; ++c) {
+			wchar_t ch = static_cast<wchar_t>(c);
+			if (str_case::to_upper(ch) != static_cast<wchar_t>(std::towupper(ch))
+				|| str_case::to_lower(ch) != static_cast<wchar_t>(std::towlower(ch)))
+			{
+				std::fprintf(stderr, "Case differs from the CRT at U+%04X.\n", c);
+				++check_failures();
+			}
+		}
+	}
+	std::setlocale(LC_CTYPE, "C");
+}
+
+// The bulk routines convert runs of ASCII in blocks, so mix them with other chars at every offset.
+static void whole_strings() {
+	CHECK(str::upper(L"Straße, ÿ, µ") == L"STRAßE, Ÿ, Μ");
+	CHECK(str::lower(L"ΣΊΣΥΦΟΣ ЁЖ") == L"σίσυφοσ ёж"); // no final sigma context in simple mappings
+	CHECK(str::casefold(L"ΣΊΣΥΦΟς") == str::casefold(L"σίσυφοσ"));
+	std::wstring s = L"Crème brûlée, Øresund, ǖ";
+	CHECK(str::remove_diacritics(s) == L"Creme brulee, Oresund, u");
+	CHECK(str::upper(L"").empty());
+
+	const wchar_t PIECES[] = L"aZ0é-ÉΣσЖж";
+	for (size_t len = 0; len < 40; ++len) {
+		for (size_t offset = 0; offset < 11; ++offset) {
+			std::wstring text;
+			for (size_t i = 0; i < len; ++i) text += (i % 7 == offset % 7) ? PIECES[(i + offset) % 10] : PIECES[i % 3];
+			std::wstring up = str::upper(text), low = str::lower(text), folded = str::casefold(text);
+			std::wstring inPlace = text;
+			str::upper_in_place(inPlace);
+			CHECK(inPlace == up);
+			for (size_t i = 0; i < len; ++i) {
+				CHECK(up[i] == str_case::to_upper(text[i]));
+				CHECK(low[i] == str_case::to_lower(text[i]));
+				CHECK(folded[i] == str_case::fold(text[i]));
+			}
+			if (check_failures()) return;
+		}
+	}
+}
+
+int main() {
+	known_mappings();
+	same_as_crt();
+	whole_strings();
+	return CHECK_RESULT();
+}
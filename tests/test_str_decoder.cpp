@@ -0,0 +1,100 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <string>
+#include <vector>
+#include "../str.h"
+#include "check.h"
+using namespace wl;
+
+// Feeds the bytes in chunks of the given size, like file_ini does with big files.
+static std::wstring decode_chunked(const std::vector<BYTE>& bytes, size_t chunkSize,
+	str::encoding* pEnc = nullptr, str::encoding presetEnc = str::encoding::UNKNOWN)
+{
+	str::decoder dec{presetEnc};
+	for (size_t off = 0; off < bytes.size(); off += chunkSize) {
+		dec.feed(&bytes[off], (bytes.size() - off < chunkSize) ? bytes.size() - off : chunkSize);
+	}
+	dec.finish();
+	if (pEnc) *pEnc = dec.encoding_type();
+	return dec.output();
+}
+
+// ASCII text with a multi-byte character cut by the end of the first chunk.
+static void split_sequence_after_ascii(const std::vector<BYTE>& seq, wchar_t expected) {
+	for (size_t cut = 1; cut < seq.size(); ++cut) {
+		const size_t CHUNK = 64;
+		std::vector<BYTE> bytes(CHUNK - cut, 'a');
+		bytes.insert(bytes.end(), seq.begin(), seq.end());
+		bytes.insert(bytes.end(), 10, 'b');
+
+		str::encoding enc = str::encoding::UNKNOWN;
+		std::wstring text = decode_chunked(bytes, CHUNK, &enc);
+		CHECK(enc == str::encoding::UTF8);
+		CHECK(text == std::wstring(CHUNK - cut, L'a') + expected + std::wstring(10, L'b'));
+	}
+}
+
+static void split_sequences_in_utf8_text() {
+	std::wstring expected;
+	std::vector<BYTE> bytes = {0xEF, 0xBB, 0xBF}; // BOM
+	for (int i = 0; i < 100; ++i) {
+		const BYTE chars[] = {'x', 0xC3, 0xA9, 0xE2, 0x82, 0xAC, 0xF0, 0x9F, 0x98, 0x80};
+		bytes.insert(bytes.end(), chars, chars + sizeof(chars));
+		expected.append(L"xé€\xD83D\xDE00"); // output is UTF-16, even where wchar_t is wider
+	}
+	for (size_t chunk = 1; chunk <= 11; ++chunk) {
+		CHECK(decode_chunked(bytes, chunk) == expected);
+	}
+}
+
+static void windows_1252_is_still_detected() {
+	std::vector<BYTE> bytes(100, 'a');
+	bytes.push_back(0xE9); // lone é in Windows-1252, invalid as UTF-8
+	bytes.insert(bytes.end(), 100, 'b');
+	str::encoding enc = str::encoding::UNKNOWN;
+	std::wstring text = decode_chunked(bytes, 150, &enc);
+	CHECK(enc == str::encoding::WIN1252);
+	CHECK(text == std::wstring(100, L'a') + L'é' + std::wstring(100, L'b'));
+}
+
+static void windows_1252_after_a_long_ascii_run() {
+	// Detected from the first chunk only, the accent comes too late; file_ini detects over the
+	// whole file, then tells the decoder.
+	std::vector<BYTE> bytes(300, 'a');
+	bytes.push_back(0xE9);
+	bytes.insert(bytes.end(), 10, 'b');
+	std::wstring expected = std::wstring(300, L'a') + L'é' + std::wstring(10, L'b');
+
+	str::encoding enc = str::encoding::UNKNOWN;
+	CHECK(decode_chunked(bytes, 64, &enc) != expected);
+	CHECK(enc == str::encoding::UTF8);
+
+	str::encoding whole = str::get_encoding(bytes).encType;
+	CHECK(whole == str::encoding::WIN1252);
+	CHECK(decode_chunked(bytes, 64, &enc, whole) == expected);
+	CHECK(enc == str::encoding::WIN1252);
+}
+
+static void truncated_at_the_very_end() {
+	std::vector<BYTE> bytes(100, 'a');
+	bytes.push_back(0xC3); // the stream ends in the middle of a sequence
+	str::decoder dec;
+	dec.feed(bytes).finish();
+	CHECK(dec.output() == std::wstring(100, L'a') + L'�');
+	CHECK(dec.num_invalid() == 1);
+}
+
+int main() {
+	split_sequence_after_ascii({0xC3, 0xA9}, L'é');       // 2 bytes
+	split_sequence_after_ascii({0xE2, 0x82, 0xAC}, L'€'); // 3 bytes
+	split_sequences_in_utf8_text();
+	windows_1252_is_still_detected();
+	windows_1252_after_a_long_ascii_run();
+	truncated_at_the_very_end();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,93 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <stdexcept>
+#include <string>
+#include "../str.h"
+#include "check.h"
+using namespace wl;
+
+enum plain_enum { PLAIN_A = 3, PLAIN_B = -7 };
+enum class scoped_enum : unsigned char { A = 200 };
+
+static void integers() {
+	CHECK(str::format(L"%d|%5d|%-5d|%05d", 42, -42, 7, -3) == L"42|  -42|7    |-0003");
+	CHECK(str::format(L"%u %x %X %#x %o", 4000000000u, 255, 255, 255, 8) == L"4000000000 ff FF 0xff 10");
+	CHECK(str::format(L"%d", -1LL) == L"-1");
+	CHECK(str::format(L"%u", static_cast<unsigned short>(65535)) == L"65535");
+	CHECK(str::format(L"%d", static_cast<unsigned int>(-1)) == L"-1"); // reinterpreted, like printf
+	CHECK(str::format(L"%.0d|%.3d", 0, 5) == L"|005");
+	CHECK(str::format(L"%d %d", true, L'A') == L"1 65");
+}
+
+static void enums_handles_and_pointers() {
+	CHECK(str::format(L"%d %d %u", PLAIN_A, PLAIN_B, scoped_enum::A) == L"3 -7 200");
+
+	HWND hWnd = reinterpret_cast<HWND>(static_cast<UINT_PTR>(0x1A2B));
+	HANDLE hFile = reinterpret_cast<HANDLE>(static_cast<UINT_PTR>(42));
+	CHECK(str::format(L"%x %X %#x", hWnd, hWnd, hWnd) == L"1a2b 1A2B 0x1a2b");
+	CHECK(str::format(L"%d %u", hFile, hFile) == L"42 42");
+	CHECK(str::format(L"%d", nullptr) == L"0");
+
+	int val = 0;
+	std::wstring asPtr = str::format(L"%p", &val);
+	CHECK(asPtr.length() == sizeof(void*) * 2);
+	CHECK(str::format(L"%x", &val) == str::format(L"%llx", static_cast<unsigned long long>(reinterpret_cast<UINT_PTR>(&val))));
+
+	const wchar_t* text = L"abc";
+	CHECK(str::format(L"%p", text) == str::format(L"%p", static_cast<const void*>(text)));
+}
+
+static void strings_and_floats() {
+	std::wstring ws = L"world";
+	CHECK(str::format(L"%s, %s! %c", L"Hello", ws, L'x') == L"Hello, world! x");
+	CHECK(str::format(L"[%6.2s][%-4s]", L"abc", L"x") == L"[    ab][x   ]");
+	CHECK(str::format(L"%.2f %.0f %8.3f", 3.14159, 2.5, -1.0) == L"3.14 2   -1.000");
+	CHECK(str::format(L"100%%") == L"100%");
+}
+
+static void mismatches_throw() {
+	CHECK_THROWS(str::format(L"%f", 1), std::invalid_argument);
+	CHECK_THROWS(str::format(L"%d", 1.5), std::invalid_argument);
+	CHECK_THROWS(str::format(L"%s", 10), std::invalid_argument);
+	CHECK_THROWS(str::format(L"%d %d", 1), std::invalid_argument);
+}
+
+static void fixed_buffer() {
+	wchar_t buf[8];
+	CHECK(str::format_to(buf, ARRAYSIZE(buf), L"%d items", 42) == 8); // truncated, not less than bufLen
+	CHECK(std::wstring{buf} == L"42 item");
+	CHECK(str::format_to(buf, ARRAYSIZE(buf), L"%s", L"abc") == 3);
+	CHECK(std::wstring{buf} == L"abc");
+
+	buf[0] = L'z';
+	CHECK(str::format_to(buf, 0, L"%d items", 1234) == 10); // required length, nothing written
+	CHECK(buf[0] == L'z');
+	CHECK(str::format_to(nullptr, 0, L"%s-%d", L"abc", 7) == 5);
+	CHECK(str::format_to(nullptr, 100, L"%.2f", 3.14159) == 4);
+	CHECK(str::format_to(buf, 1, L"abc") == 3);
+	CHECK(buf[0] == L'\0');
+}
+
+static void numbers_to_buffer() {
+	wchar_t buf[8];
+	CHECK(str::number_to(buf, ARRAYSIZE(buf), 1234567LL, {0, L','}) == 9);
+	CHECK(std::wstring{buf} == L"1,234,5");
+	CHECK(str::number_to(nullptr, 0, -4294967296LL) == 11);
+	CHECK(str::number_to(buf, 0, 0.1 + 0.2) == 19);
+	CHECK(str::to_wstring(0.1 + 0.2, {}) == L"0.30000000000000004");
+}
+
+int main() {
+	integers();
+	enums_handles_and_pointers();
+	strings_and_floats();
+	mismatches_throw();
+	fixed_buffer();
+	numbers_to_buffer();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,54 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <clocale>
+#include <cstdlib>
+#include <string>
+#include "../str.h"
+#include "check.h"
+using namespace wl;
+
+static bool parses_to(const wchar_t* text, double expected) {
+	double val = 0;
+	str::from_chars_result res = str::from_chars(text, val);
+	return res.ec == std::errc{} && res.stop == std::char_traits<wchar_t>::length(text) && val == expected;
+}
+
+static void integers() {
+	int n = 0;
+	CHECK(str::from_chars(L"1024 bytes", n).stop == 4 && n == 1024);
+	CHECK(str::from_chars(L"-2147483648", n).ec == std::errc{} && n == -2147483647 - 1);
+	CHECK(str::from_chars(L"2147483648", n).ec == std::errc::result_out_of_range);
+	CHECK(str::from_chars(L"x", n).ec == std::errc::invalid_argument);
+	UINT u = 0;
+	CHECK(str::from_chars(L"ff", u, 16).ec == std::errc{} && u == 255);
+}
+
+// Numbers with too many digits or big exponents take the slow path, which must ignore the locale.
+static void doubles(const char* locale) {
+	CHECK(parses_to(L"0.5", 0.5));
+	CHECK(parses_to(L"-1.25e3", -1250.0));
+	CHECK(parses_to(L"123456789012345678901234567890.5", 123456789012345678901234567890.5));
+	CHECK(parses_to(L"0.1000000000000000055511151231257827", 0.1));
+	CHECK(parses_to(L"2.2250738585072014e-308", 2.2250738585072014e-308));
+	CHECK(parses_to(L"1.7976931348623157e308", 1.7976931348623157e308));
+	if (check_failures()) std::fprintf(stderr, "  with locale %s\n", locale);
+}
+
+int main() {
+	integers();
+	doubles("C");
+	const char* commaLocales[] = {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "pt_BR.UTF-8", "German", "French"};
+	for (const char* name : commaLocales) {
+		if (std::setlocale(LC_ALL, name)) { // decimal point is a comma; skipped where not installed
+			doubles(name);
+			std::setlocale(LC_ALL, "C");
+			break;
+		}
+	}
+	return CHECK_RESULT();
+}
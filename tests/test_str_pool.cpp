@@ -0,0 +1,75 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+#include "../insert_order_map.h"
+#include "../str_pool.h"
+#include "check.h"
+using namespace wl;
+
+static void arena() {
+	str_arena arena{64};
+	std::wstring_view a = arena.push(L"first");
+	std::wstring_view b = arena.append(L"built ").append(L"in ").append(L'3').append(L" parts").finish();
+	std::wstring big(100, L'x'); // bigger than a slab
+	std::wstring_view c = arena.push(big);
+	CHECK(a == L"first" && a.data()[a.length()] == L'\0');
+	CHECK(b == L"built in 3 parts");
+	CHECK(c == big);
+	str_arena moved = std::move(arena);
+	CHECK(a == L"first" && moved.bytes_used() > 0 && !arena.bytes_used());
+}
+
+static void own_pool() {
+	str_pool pool;
+	std::wstring s1 = L"name", s2 = L"name";
+	std::wstring_view v1 = pool.intern(s1), v2 = pool.intern(s2);
+	CHECK(v1.data() == v2.data() && v1 == L"name");
+	CHECK(pool.find(L"name").data() == v1.data());
+	CHECK(pool.find(L"other").data() == nullptr);
+	CHECK(pool.stats().strings == 1 && pool.stats().lookups == 2);
+	pool.clear(); // only views from this pool are invalidated
+	CHECK(pool.stats().strings == 0 && pool.find(L"name").data() == nullptr);
+}
+
+static void atoms() {
+	str_pool::atom a = L"key", b = std::wstring{L"key"}, c = L"other", empty;
+	CHECK(a == b && a.c_str() == b.c_str() && a != c);
+	CHECK(a == L"key" && a.length() == 3 && a.str() == L"key");
+	CHECK(empty.empty() && empty == L"");
+	CHECK(str_pool::shared_stats().strings >= 2);
+
+	insert_order_map<str_pool::atom, int> map;
+	map[L"one"] = 1;
+	map[str_pool::atom{L"two"}] = 2;
+	CHECK(map[L"one"] == 1 && map.has(L"two") && !map.has(L"three"));
+}
+
+static void concurrent_interning() {
+	str_pool pool;
+	std::vector<const wchar_t*> found(4);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < found.size(); ++t) {
+		threads.emplace_back([&pool, &found, t]() {
+			for (int i = 0; i < 1000; ++i) pool.intern(L"n" + std::to_wstring(i));
+			found[t] = pool.intern(L"n500").data();
+		});
+	}
+	for (std::thread& t : threads) t.join();
+	CHECK(found[0] == found[1] && found[1] == found[2] && found[2] == found[3]);
+	CHECK(pool.stats().strings == 1000);
+}
+
+int main() {
+	arena();
+	own_pool();
+	atoms();
+	concurrent_interning();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,130 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "../str.h"
+#include "check.h"
+using namespace wl;
+
+using pairs_t = std::vector<std::pair<std::wstring, std::wstring>>;
+
+struct string_sink final {
+	std::wstring text;
+	void append(const wchar_t* s, size_t n) { this->text.append(s, n); }
+};
+
+// Reference: at each position the longest needle wins; the last of repeated needles wins.
+static std::wstring brute_replace(std::wstring_view haystack, const pairs_t& pairs, bool ignoreCase) {
+	std::wstring hay = ignoreCase ? str::casefold(haystack) : std::wstring{haystack};
+	std::wstring output;
+	for (size_t pos = 0; pos < hay.length(); ) {
+		size_t best = pairs.size();
+		for (size_t i = 0; i < pairs.size(); ++i) {
+			std::wstring needle = ignoreCase ? str::casefold(pairs[i].first) : pairs[i].first;
+			if (!needle.empty() && hay.compare(pos, needle.length(), needle) == 0
+				&& (best == pairs.size() || needle.length() >= pairs[best].first.length()))
+			{
+				best = i;
+			}
+		}
+		if (best == pairs.size()) {
+			output += haystack[pos++];
+		} else {
+			output += pairs[best].second;
+			pos += pairs[best].first.length();
+		}
+	}
+	return output;
+}
+
+// Replacer built from the pairs and run once.
+static std::wstring replaced(const pairs_t& pairs, std::wstring_view haystack,
+	str::ignore_case ignoreCase = str::ignore_case::NO)
+{
+	return str::replacer{pairs, ignoreCase}.replace(haystack);
+}
+
+static void overlapping_and_priority() {
+	str::replacer classic{{L"he", L"1"}, {L"she", L"2"}, {L"his", L"3"}, {L"hers", L"4"}};
+	CHECK(classic.replace(L"ushers") == L"u2rs"); // leftmost wins over longer matches starting later
+	CHECK(classic.replace(L"hershis") == L"43");
+
+	str::replacer nested{{L"a", L"1"}, {L"ab", L"2"}, {L"abc", L"3"}};
+	CHECK(nested.replace(L"abcabaxa") == L"321x1"); // longest at each position
+
+	CHECK(replaced({{L"aa", L"b"}}, L"aaaaa") == L"bba"); // non-overlapping, resumes after the match
+	CHECK(replaced({{L"bc", L"X"}, {L"abcd", L"Y"}}, L"abcx abcd") == L"aXx Y"); // longer one failed, shorter kept
+	CHECK(replaced({{L"b", L"X"}, {L"abc", L"Y"}}, L"abab abc") == L"aXaX Y");
+	CHECK(replaced({{L"x", L"1"}, {L"x", L"2"}}, L"xx") == L"22"); // last of repeated needles wins
+	CHECK(replaced({{L"ab", L"ba"}}, L"aabb") == L"abab"); // replacements aren't scanned again
+}
+
+static void case_folding() {
+	pairs_t pairs = {{L"hello", L"bye"}, {L"σίσ", L"S"}, {L"straße", L"road"}};
+	str::replacer rep{pairs, str::ignore_case::YES};
+	CHECK(rep.replace(L"HeLLo, hello, HELLO!") == L"bye, bye, bye!");
+	CHECK(rep.replace(L"ΣΊΣΥΦΟΣ ςίς") == L"SΥΦΟΣ S"); // final sigma folds like σ
+	CHECK(rep.replace(L"STRAßE") == L"road");
+	CHECK(rep.replace(L"Hellò") == L"Hellò"); // folding keeps diacritics
+
+	CHECK(replaced(pairs, L"Hello hello") == L"Hello bye");
+	CHECK(replaced({{L"\u212A", L"k"}}, L"K", str::ignore_case::YES) == L"K"); // Kelvin sign doesn't fold into ASCII
+	CHECK(replaced({{L"k", L"x"}}, L"\u212A", str::ignore_case::YES) == L"\u212A");
+}
+
+static void empty_needles_and_haystacks() {
+	str::replacer none;
+	CHECK(none.replace(L"nothing changes") == L"nothing changes");
+	CHECK(replaced({}, L"abc") == L"abc");
+	CHECK(replaced({{L"", L"X"}}, L"abc") == L"abc"); // empty needles never match
+	CHECK(replaced({{L"", L"X"}, {L"b", L"Y"}}, L"abc") == L"aYc");
+	CHECK(replaced({{L"a", L"b"}}, L"").empty());
+	CHECK(replaced({{L"a", L""}}, L"banana") == L"bnn");
+
+	str::replacer numbers{{L"one", L"1"}, {L"two", L"2"}};
+	std::wstring s = L"one two";
+	CHECK(numbers.replace_in_place(s) == L"1 2");
+	CHECK(s == L"1 2");
+}
+
+// Needles from a tiny alphabet overlap all the time, which covers the fail links.
+static void random_against_brute_force() {
+	unsigned seed = 7;
+	auto next = [&seed](unsigned n) { seed = seed * 1103515245u + 12345u; return (seed >> 16) % n; };
+	const wchar_t ALPHABET[] = L"abAB";
+	for (int round = 0; round < 2000; ++round) {
+		pairs_t pairs(1 + next(6));
+		for (size_t i = 0; i < pairs.size(); ++i) {
+			for (unsigned len = next(4) + (round % 50 ? 1 : 0); len; --len) pairs[i].first += ALPHABET[next(4)];
+			pairs[i].second = L"<" + std::to_wstring(i) + L">";
+		}
+		std::wstring hay;
+		for (unsigned len = next(30); len; --len) hay += ALPHABET[next(4)];
+		bool ignoreCase = round % 2;
+
+		str::replacer rep{pairs, ignoreCase ? str::ignore_case::YES : str::ignore_case::NO};
+		std::wstring expected = brute_replace(hay, pairs, ignoreCase);
+		string_sink sink;
+		rep.replace_to(hay, sink);
+		CHECK(rep.replace(hay) == expected);
+		CHECK(sink.text == expected);
+		if (check_failures()) {
+			std::fprintf(stderr, "  at round %d, haystack \"%ls\"\n", round, hay.c_str());
+			return;
+		}
+	}
+}
+
+int main() {
+	overlapping_and_priority();
+	case_folding();
+	empty_needles_and_haystacks();
+	random_against_brute_force();
+	return CHECK_RESULT();
+}
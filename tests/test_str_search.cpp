@@ -0,0 +1,102 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <string>
+#include <vector>
+#include "../str.h"
+#include "check.h"
+using namespace wl;
+
+static const size_t npos = std::wstring::npos;
+
+// Plain search over folded copies, which the searcher must always agree with.
+static std::wstring folded(const std::wstring& s) {
+	std::wstring f = s;
+	for (wchar_t& ch : f) ch = _wli::str_case::fold(ch);
+	return f;
+}
+
+static void edges() {
+	CHECK(str::findi(L"abc", L"abcd") == npos); // needle longer than haystack
+	CHECK(str::rfindi(L"abc", L"abcd") == npos);
+	CHECK(str::findi(L"", L"a") == npos);
+	CHECK(str::rfindi(L"", L"a") == npos);
+	CHECK(str::findi(L"abc", L"") == 0);
+	CHECK(str::findi(L"abc", L"", 2) == 2);
+	CHECK(str::findi(L"abc", L"", 4) == npos); // offset past the end
+	CHECK(str::rfindi(L"abc", L"") == 3);
+	CHECK(str::findi(L"abc", L"ABC") == 0);
+	CHECK(str::findi(L"abc", L"c", 3) == npos);
+	CHECK(str::findi(L"xAbCx", L"aBc", 1) == 1);
+	CHECK(str::findi(L"xAbCx", L"aBc", 2) == npos);
+}
+
+static void rfind_offsets() {
+	std::wstring s = L"Abc abc ABC";
+	CHECK(str::rfindi(s, L"abc") == 8); // default offset searches the whole string
+	CHECK(str::rfindi(s, std::wstring{L"ABC"}) == 8);
+	CHECK(str::rfindi(s, L"abc", 7) == 4);
+	CHECK(str::rfindi(s, L"abc", 4) == 4);
+	CHECK(str::rfindi(s, L"abc", 3) == 0);
+	CHECK(str::rfindi(s, L"abc", 0) == 0);
+	CHECK(str::rfindi(s, L"abc d") == npos);
+	CHECK(str::rfindi(s, L"a long needle, longer than the whole haystack") == npos);
+}
+
+static void non_ascii_folding() {
+	CHECK(str::findi(L"Grüße aus MÜNCHEN", L"münchen") == 10);
+	CHECK(str::findi(L"ΟΔΥΣΣΕΥΣ", L"οδυσσευσ") == 0);
+	CHECK(str::findi(L"οδυσσευς", L"ΕΥΣ") == 5); // final sigma folds like the others
+	CHECK(str::findi(L"Москва", L"МОСКВА") == 0);
+	CHECK(str::rfindi(L"ÀÉÎ àéî", L"àéî") == 4);
+	CHECK(str::findi(L"resume", L"résumé") == npos); // diacritics are not stripped
+	CHECK(str::findi(L"Kelvin \x212A", L"k", 1) == npos); // Kelvin sign doesn't fold to ASCII
+}
+
+static void find_all() {
+	std::vector<size_t> found;
+	std::wstring run = L"aaaaa"; // the haystack must outlive the range
+	for (size_t idx : str::finderi(L"aA").find_all(run)) found.emplace_back(idx);
+	CHECK((found == std::vector<size_t>{0, 2})); // non-overlapping
+
+	found.clear();
+	std::wstring text = L"one ONE oNe two";
+	for (size_t idx : str::finderi(L"one").find_all(text)) found.emplace_back(idx);
+	CHECK((found == std::vector<size_t>{0, 4, 8}));
+}
+
+static void against_plain_search() {
+	// Random haystacks over a small alphabet, so matches are frequent and needles of all lengths
+	// go through both the prefilter and the shift tables.
+	const wchar_t ALPHABET[] = L"aAbBcCéÉσΣς ";
+	const size_t ALPHABET_LEN = sizeof(ALPHABET) / sizeof(ALPHABET[0]) - 1;
+	unsigned seed = 1;
+	auto next = [&]() { seed = seed * 1103515245u + 12345u; return seed >> 8; };
+	size_t mismatches = 0;
+	for (int round = 0; round < 2000; ++round) {
+		std::wstring hay(next() % 60, L' '), needle(next() % 9, L' ');
+		for (wchar_t& ch : hay) ch = ALPHABET[next() % ALPHABET_LEN];
+		for (wchar_t& ch : needle) ch = ALPHABET[next() % ALPHABET_LEN];
+		std::wstring fHay = folded(hay), fNeedle = folded(needle);
+		str::finderi finder{needle};
+		for (size_t offset = 0; offset <= hay.length() + 1; ++offset) {
+			mismatches += finder.find(hay, offset) != fHay.find(fNeedle, offset);
+			mismatches += finder.rfind(hay, offset) != fHay.rfind(fNeedle, offset);
+		}
+		mismatches += finder.rfind(hay) != fHay.rfind(fNeedle);
+	}
+	CHECK(mismatches == 0);
+}
+
+int main() {
+	edges();
+	rfind_offsets();
+	non_ascii_folding();
+	find_all();
+	against_plain_search();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,110 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../str.h"
+#include "check.h"
+using namespace wl;
+
+static bool is_digit(wchar_t ch) noexcept { return ch >= L'0' && ch <= L'9'; }
+
+// The comparison which the keys replace, done pairwise: chars compared after stripping diacritics
+// and folding case; runs of digits compared as numbers, and against other chars as if they were '0'.
+static int compare_direct(std::wstring_view a, std::wstring_view b, str::collate how) {
+	bool natural = (how & str::collate::NATURAL) != str::collate::ORDINAL;
+	auto normalize = [how](wchar_t ch) {
+		if ((how & str::collate::IGNORE_DIACRITICS) != str::collate::ORDINAL) ch = _wli::str_case::strip_diacritic(ch);
+		if ((how & str::collate::IGNORE_CASE) != str::collate::ORDINAL) ch = _wli::str_case::fold(ch);
+		return ch;
+	};
+	size_t i = 0, j = 0;
+	while (i < a.length() && j < b.length()) {
+		bool numA = natural && is_digit(a[i]), numB = natural && is_digit(b[j]);
+		if (numA && numB) {
+			while (i < a.length() && a[i] == L'0') ++i;
+			while (j < b.length() && b[j] == L'0') ++j;
+			size_t endA = i, endB = j;
+			while (endA < a.length() && is_digit(a[endA])) ++endA;
+			while (endB < b.length() && is_digit(b[endB])) ++endB;
+			if (endA - i != endB - j) return (endA - i < endB - j) ? -1 : 1; // fewer digits, smaller number
+			int cmp = a.substr(i, endA - i).compare(b.substr(j, endB - j));
+			if (cmp) return cmp < 0 ? -1 : 1;
+			i = endA;
+			j = endB;
+			continue;
+		}
+		wchar_t chA = numA ? L'0' : normalize(a[i]), chB = numB ? L'0' : normalize(b[j]);
+		if (chA != chB) return chA < chB ? -1 : 1;
+		++i;
+		++j;
+	}
+	return (i < a.length()) - (j < b.length());
+}
+
+static int sign(int cmp) noexcept { return (cmp > 0) - (cmp < 0); }
+
+static void known_orders() {
+	std::vector<std::wstring> files = {L"file10.txt", L"File9.txt", L"file9b.txt", L"file1.txt", L"file009.txt", L"file"};
+	str::sort(files);
+	CHECK((files == std::vector<std::wstring>{L"file", L"file1.txt", L"File9.txt", L"file009.txt", L"file9b.txt", L"file10.txt"}));
+
+	std::vector<std::wstring> words = {L"b", L"B", L"a", L"á", L"Á", L"A"};
+	str::sort(words, str::collate::ORDINAL);
+	CHECK((words == std::vector<std::wstring>{L"A", L"B", L"a", L"b", L"Á", L"á"}));
+	str::sort(words, str::collate::IGNORE_CASE | str::collate::IGNORE_DIACRITICS); // stable, ties keep their order
+	CHECK((words == std::vector<std::wstring>{L"A", L"a", L"Á", L"á", L"B", L"b"}));
+
+	CHECK(str::sort_key(L"x9") < str::sort_key(L"x10"));
+	CHECK(str::sort_key(L"x9", str::collate::IGNORE_CASE) > str::sort_key(L"x10", str::collate::IGNORE_CASE));
+	CHECK(str::sort_key(L"a01") == str::sort_key(L"a1"));
+	CHECK(str::sort_key(L"a0") == str::sort_key(L"a00"));
+	CHECK(str::sort_key(L"a0") < str::sort_key(L"a1"));
+	CHECK(str::sort_key(L"ΣΊΣΥΦΟΣ") == str::sort_key(L"σίσυφος"));
+	CHECK(str::sort_key(L"18446744073709551616") > str::sort_key(L"18446744073709551615")); // beyond 64 bits
+}
+
+// Random strings from a small alphabet, so digit runs, case and diacritics collide all the time.
+static void same_order_as_direct_comparison() {
+	const wchar_t ALPHABET[] = L"aAbB00129 -.éÉeEßΣσςжЖü~";
+	const str::collate HOWS[] = {str::collate::ORDINAL, str::collate::IGNORE_CASE, str::collate::IGNORE_DIACRITICS,
+		str::collate::NATURAL, str::collate::NATURAL_IGNORE_CASE,
+		str::collate::NATURAL_IGNORE_CASE | str::collate::IGNORE_DIACRITICS};
+	unsigned seed = 3;
+	auto next = [&seed](unsigned n) { seed = seed * 1103515245u + 12345u; return (seed >> 16) % n; };
+
+	std::vector<std::wstring> strs(20000);
+	for (std::wstring& s : strs) {
+		for (unsigned len = next(8); len; --len) s += ALPHABET[next(ARRAYSIZE(ALPHABET) - 1)];
+	}
+
+	for (str::collate how : HOWS) {
+		for (size_t i = 0; i + 1 < 4000; ++i) {
+			int expected = compare_direct(strs[i], strs[i + 1], how);
+			CHECK(sign(str::sort_key(strs[i], how).compare(str::sort_key(strs[i + 1], how))) == expected);
+		}
+
+		std::vector<size_t> expected(strs.size());
+		for (size_t i = 0; i < expected.size(); ++i) expected[i] = i;
+		std::stable_sort(expected.begin(), expected.end(), [&](size_t a, size_t b) {
+			return compare_direct(strs[a], strs[b], how) < 0;
+		});
+		CHECK(str::sort_order(strs, how, 1) == expected);
+		CHECK(str::sort_order(strs, how, 3) == expected); // parallel slices, then merged
+		if (check_failures()) {
+			std::fprintf(stderr, "  with collate %u\n", static_cast<unsigned>(how));
+			return;
+		}
+	}
+}
+
+int main() {
+	known_orders();
+	same_order_as_direct_comparison();
+	return CHECK_RESULT();
+}
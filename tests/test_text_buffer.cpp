@@ -0,0 +1,108 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <stdexcept>
+#include <string>
+#include "../text_buffer.h"
+#include "check.h"
+using namespace wl;
+
+static unsigned seed = 12345;
+
+static unsigned rnd(unsigned n) { // deterministic, so failures can be reproduced
+	seed = seed * 1103515245u + 12345u;
+	return (seed >> 8) % n;
+}
+
+static std::wstring random_text(size_t maxLen) {
+	static const wchar_t chars[] = L"abcdefgh \r\n\n\xE9\x4E2D";
+	std::wstring s(rnd(static_cast<unsigned>(maxLen) + 1), L'\0');
+	for (wchar_t& ch : s) ch = chars[rnd(sizeof(chars) / sizeof(wchar_t) - 1)];
+	return s;
+}
+
+static size_t count_lines(const std::wstring& s) {
+	size_t n = 1;
+	for (wchar_t ch : s) n += (ch == L'\n');
+	return n;
+}
+
+// Line i of the reference, without its \n, and without a \r before it.
+static std::wstring reference_line(const std::wstring& s, size_t idx) {
+	size_t start = 0;
+	for (size_t i = 0; i < idx; ++i) start = s.find(L'\n', start) + 1;
+	size_t end = s.find(L'\n', start);
+	if (end == std::wstring::npos) return s.substr(start);
+	if (end > start && s[end - 1] == L'\r') --end;
+	return s.substr(start, end - start);
+}
+
+static bool same(const text_buffer& tb, const std::wstring& ref) {
+	if (tb.length() != ref.length() || tb.str() != ref || tb.line_count() != count_lines(ref)) return false;
+	for (int i = 0; i < 5; ++i) {
+		size_t line = rnd(static_cast<unsigned>(tb.line_count()));
+		if (tb.line(line) != reference_line(ref, line)) return false;
+		if (tb.line_of(tb.line_start(line)) != line) return false;
+
+		size_t pos = rnd(static_cast<unsigned>(ref.length()) + 1);
+		size_t len = rnd(200);
+		if (tb.substr(pos, len) != ref.substr(pos, len)) return false;
+		if (pos < ref.length() && tb[pos] != ref[pos]) return false;
+	}
+	return true;
+}
+
+// Random edits applied to both a text_buffer and a std::wstring, which must always match.
+static void random_edits(size_t initialLen, int numEdits) {
+	std::wstring ref = random_text(initialLen);
+	text_buffer tb{ref};
+	for (int i = 0; i < numEdits; ++i) {
+		size_t pos = rnd(static_cast<unsigned>(ref.length()) + 1);
+		size_t len = rnd(i % 50 ? 64 : 10000); // now and then a big erase, across many pieces
+		std::wstring s = random_text(i % 40 ? 32 : 9000); // and a big insert, over the piece size
+
+		switch (rnd(5)) {
+		case 0: tb.insert(pos, s); ref.insert(pos, s); break;
+		case 1: tb.erase(pos, len); ref.erase(pos, len); break;
+		case 2: tb.replace(pos, len, s); ref.replace(pos, std::min(len, ref.length() - pos), s); break;
+		case 3: tb.append(s); ref.append(s); break;
+		case 4: // typing: many small inserts in sequence
+			for (wchar_t ch : s) {
+				tb.insert(pos, std::wstring_view{&ch, 1});
+				ref.insert(pos++, 1, ch);
+			}
+			break;
+		}
+		if (!same(tb, ref)) {
+			std::fprintf(stderr, "Mismatch after edit %d, initial length %zu.\n", i, initialLen);
+			CHECK(false);
+			return;
+		}
+	}
+}
+
+static void edges() {
+	text_buffer tb;
+	CHECK(tb.empty() && tb.line_count() == 1 && tb.line(0).empty());
+	tb.append(L"one\r\ntwo\nthree");
+	CHECK(tb.line_count() == 3 && tb.line(0) == L"one" && tb.line(1) == L"two" && tb.line(2) == L"three");
+	CHECK(tb.line_start(1) == 5 && tb.line_of(5) == 1 && tb.line_of(tb.length()) == 2);
+	CHECK_THROWS(tb.insert(tb.length() + 1, L"x"), std::out_of_range);
+	CHECK_THROWS(tb.erase(tb.length() + 1, 1), std::out_of_range);
+	CHECK_THROWS(tb.line_start(3), std::out_of_range);
+	CHECK_THROWS(tb[tb.length()], std::out_of_range);
+	tb.erase(0);
+	CHECK(tb.empty() && tb.str().empty());
+}
+
+int main() {
+	edges();
+	random_edits(0, 2000);
+	random_edits(100, 2000);
+	random_edits(50000, 300);
+	return CHECK_RESULT();
+}
@@ -0,0 +1,167 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "../internals/thread_pool.h"
+#include "check.h"
+using namespace wl;
+using _wli::thread_pool;
+
+// Spins until the condition holds, up to a few seconds; returns whether it held.
+template<typename predT>
+static bool wait_for(predT&& pred) {
+	std::chrono::steady_clock::time_point limit = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (!pred()) {
+		if (std::chrono::steady_clock::now() > limit) return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+static void submits_from_many_threads() {
+	// Each task submits another from its worker; all must run exactly once, and only in the workers.
+	const size_t NUM_TASKS = 20000, NUM_PRODUCERS = 4;
+	std::vector<std::atomic<int>> hits(NUM_TASKS * 2);
+	std::atomic<size_t> done{0}, rejected{0};
+	std::mutex idsMutex;
+	std::set<std::thread::id> ids;
+	auto record_thread = [&]() {
+		std::lock_guard<std::mutex> lock{idsMutex};
+		ids.emplace(std::this_thread::get_id());
+	};
+	thread_pool pool{4, 64};
+	std::vector<std::thread> producers;
+	for (size_t p = 0; p < NUM_PRODUCERS; ++p) {
+		producers.emplace_back([&, p]() {
+			for (size_t i = p; i < NUM_TASKS; i += NUM_PRODUCERS) {
+				bool queued = pool.submit([&, i]() {
+					hits[i].fetch_add(1);
+					record_thread();
+					pool.submit([&, i]() { // when the queues are full, runs right here
+						hits[NUM_TASKS + i].fetch_add(1);
+						record_thread();
+						done.fetch_add(1);
+					}, task_priority::LOW);
+					done.fetch_add(1);
+				}, static_cast<task_priority>(i % 3), std::chrono::seconds(10));
+				if (!queued) rejected.fetch_add(1);
+			}
+		});
+	}
+	for (std::thread& t : producers) t.join();
+	CHECK(wait_for([&]() { return done.load() == NUM_TASKS * 2; }));
+	CHECK(rejected.load() == 0);
+	size_t wrong = 0;
+	for (const std::atomic<int>& h : hits) wrong += (h.load() != 1);
+	CHECK(wrong == 0);
+	std::lock_guard<std::mutex> lock{idsMutex};
+	CHECK(ids.size() <= pool.num_threads()); // no other threads were started
+}
+
+static void priorities() {
+	// With the only worker held, queued tasks start by priority, then in submission order.
+	thread_pool pool{1, 1000};
+	std::atomic<bool> release{false};
+	std::mutex mutex;
+	std::vector<int> order;
+	pool.submit([&]() { while (!release.load()) std::this_thread::yield(); });
+	CHECK(wait_for([&]() { return pool.pending() == 0; })); // worker took it
+	for (int i = 0; i < 30; ++i) {
+		pool.submit([&, i]() {
+			std::lock_guard<std::mutex> lock{mutex};
+			order.emplace_back(i);
+		}, static_cast<task_priority>(i % 3));
+	}
+	release.store(true);
+	CHECK(wait_for([&]() { std::lock_guard<std::mutex> lock{mutex}; return order.size() == 30; }));
+	for (size_t i = 0; i < order.size(); ++i) {
+		CHECK(order[i] == static_cast<int>((i / 10) + (i % 10) * 3)); // HIGH are i % 3 == 0
+	}
+}
+
+static void full_queues_wait_or_fail() {
+	// Past the queue capacity, a caller from outside the pool waits up to its timeout for room; the
+	// task never runs in the calling thread.
+	thread_pool pool{2, 4};
+	std::atomic<bool> release{false};
+	std::atomic<int> runs{0}, inlineRuns{0};
+	for (int i = 0; i < 2; ++i) pool.submit([&]() { while (!release.load()) std::this_thread::yield(); });
+	CHECK(wait_for([&]() { return pool.pending() == 0; }));
+	std::thread::id self = std::this_thread::get_id();
+	auto make_task = [&]() -> thread_pool::task {
+		return [&, self]() {
+			if (std::this_thread::get_id() == self) inlineRuns.fetch_add(1);
+			runs.fetch_add(1);
+		};
+	};
+	for (int i = 0; i < 8; ++i) CHECK(pool.submit(make_task())); // 2 workers x 4 queued
+	CHECK(pool.pending() == 8);
+
+	thread_pool::task rejected = make_task();
+	CHECK(!pool.try_submit(rejected));
+	CHECK(!pool.submit(std::move(rejected), task_priority::HIGH, std::chrono::milliseconds::zero()));
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	CHECK(!pool.submit(std::move(rejected), task_priority::HIGH, std::chrono::milliseconds(50)));
+	CHECK(std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(50));
+	CHECK(static_cast<bool>(rejected)); // untouched
+	CHECK(runs.load() == 0 && pool.pending() == 8);
+
+	std::thread releaser{[&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		release.store(true);
+	}};
+	CHECK(pool.submit(std::move(rejected), task_priority::HIGH, std::chrono::seconds(10))); // room is made meanwhile
+	CHECK(!rejected);
+	releaser.join();
+	CHECK(wait_for([&]() { return runs.load() == 9; }));
+	CHECK(inlineRuns.load() == 0);
+}
+
+static void workers_run_inline_when_full() {
+	// A worker can't wait for room, since the others may be waiting on it: it runs the task itself.
+	thread_pool pool{1, 2};
+	std::atomic<int> runs{0};
+	std::atomic<bool> ranInline{false}, ranBefore{false}, finished{false};
+	pool.submit([&]() {
+		std::thread::id worker = std::this_thread::get_id();
+		for (int i = 0; i < 2; ++i) pool.submit([&]() { runs.fetch_add(1); }); // fills the queue
+		bool returned = false;
+		CHECK(pool.submit([&, worker]() {
+			ranInline.store(std::this_thread::get_id() == worker);
+			ranBefore.store(!returned);
+		}, task_priority::NORMAL, std::chrono::seconds(10)));
+		returned = true;
+		finished.store(true);
+	});
+	CHECK(wait_for([&]() { return finished.load() && runs.load() == 2; }));
+	CHECK(ranInline.load() && ranBefore.load());
+}
+
+static void exceptions_and_shutdown_drain() {
+	// A throwing task doesn't kill its worker, and the destructor runs everything queued.
+	std::atomic<int> runs{0};
+	{
+		thread_pool pool{2, 1000};
+		pool.submit([]() { throw 1; });
+		for (int i = 0; i < 500; ++i) pool.submit([&]() { runs.fetch_add(1); }, static_cast<task_priority>(i % 3));
+	}
+	CHECK(runs.load() == 500);
+}
+
+int main() {
+	submits_from_many_threads();
+	priorities();
+	full_queues_wait_or_fail();
+	workers_run_inline_when_full();
+	exceptions_and_shutdown_drain();
+	return CHECK_RESULT();
+}
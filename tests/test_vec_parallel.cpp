@@ -0,0 +1,152 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../vec.h"
+#include "check.h"
+using namespace wl;
+
+static unsigned seed = 5;
+
+static std::vector<int> random_ints(size_t count) {
+	std::vector<int> v(count);
+	for (int& x : v) {
+		seed = seed * 1103515245u + 12345u;
+		x = static_cast<int>((seed >> 8) % 1000);
+	}
+	return v;
+}
+
+// Every algorithm against its serial version, over sizes, thread counts and grain sizes which
+// give a single chunk, a few uneven ones, and many tiny ones.
+static void same_as_serial() {
+	for (size_t count : {0, 1, 7, 1000, 5000, 100000}) {
+		for (size_t numThreads : {1, 2, 3, 8}) {
+			for (size_t grainSize : {0, 1, 333, 100000}) {
+				if (grainSize == 1 && count > 5000) continue;
+				vec::par::options opts{numThreads, grainSize};
+				std::vector<int> v = random_ints(count);
+
+				std::vector<std::atomic<int>> hits(count);
+				vec::par::for_each(v, [&](const int& x) { hits[&x - v.data()].fetch_add(1); }, opts);
+				CHECK(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& h) { return h == 1; }));
+
+				std::vector<std::string> texts = vec::par::transform(v, [](int x) { return std::to_string(x); }, opts);
+				CHECK(texts.size() == count);
+				for (size_t i = 0; i < count; ++i) CHECK(texts[i] == std::to_string(v[i]));
+
+				for (int target : {-1, 999, 500, 0}) {
+					auto pred = [target](int x) { return x == target; };
+					CHECK(vec::par::find_if(v, pred, opts) == vec::find_if(v, pred)); // the first match, not any
+				}
+
+				std::vector<long long> wide(v.begin(), v.end());
+				CHECK(vec::par::reduce(wide, 5LL, std::plus<>{}, opts) == std::accumulate(wide.begin(), wide.end(), 5LL));
+				if (count <= 5000) { // concatenation isn't commutative, so chunk order matters
+					std::string joined = vec::par::reduce(texts, std::string{">"}, std::plus<>{}, opts);
+					CHECK(joined == std::accumulate(texts.begin(), texts.end(), std::string{">"}));
+				}
+
+				std::vector<int> parRemoved = v, removed = v;
+				vec::par::remove_if(parRemoved, [](int x) { return x % 3 == 0; }, opts);
+				vec::remove_if(removed, [](int x) { return x % 3 == 0; });
+				CHECK(parRemoved == removed);
+
+				std::vector<int> parSorted = v, sorted = v;
+				vec::par::sort(parSorted, std::less<>{}, opts);
+				std::sort(sorted.begin(), sorted.end());
+				CHECK(parSorted == sorted);
+				vec::par::sort(parSorted, std::greater<>{}, opts);
+				std::sort(sorted.begin(), sorted.end(), std::greater<>{});
+				CHECK(parSorted == sorted);
+
+				if (check_failures()) {
+					std::fprintf(stderr, "  with %zu elements, %zu threads, grain %zu\n", count, numThreads, grainSize);
+					return;
+				}
+			}
+		}
+	}
+
+	std::vector<unsigned> big(1 << 20); // many slices, so merging goes through several levels
+	for (unsigned& x : big) x = seed = seed * 1103515245u + 12345u;
+	std::vector<unsigned> sorted = big;
+	vec::par::sort(big, std::less<>{}, {5, 16 * 1024});
+	std::sort(sorted.begin(), sorted.end());
+	CHECK(big == sorted);
+}
+
+// The first exception thrown in a task reaches the caller, and the pool keeps working.
+static void exceptions_from_tasks() {
+	std::vector<int> v(200000, 1);
+	std::atomic<int> calls{0};
+	try {
+		vec::par::for_each(v, [&](int&) { if (calls++ == 70000) throw std::runtime_error("boom"); }, {4, 1000});
+		CHECK(!"for_each must throw");
+	} catch (const std::runtime_error& e) {
+		CHECK(std::string{e.what()} == "boom");
+	}
+	CHECK(calls < 200000); // chunks not yet started were cancelled
+
+	CHECK_THROWS(vec::par::transform(v, [](int x) -> int { throw std::logic_error(std::to_string(x)); }, {3, 0}), std::logic_error);
+	CHECK_THROWS(vec::par::reduce(v, 0, [](int a, int b) { if (a > 1000) throw std::range_error("big"); return a + b; }, {3, 0}), std::range_error);
+	CHECK_THROWS(vec::par::find_if(v, [](int) -> bool { throw std::runtime_error("find"); }, {2, 0}), std::runtime_error);
+	CHECK_THROWS(vec::par::remove_if(v, [](int) -> bool { throw std::runtime_error("remove"); }, {2, 0}), std::runtime_error);
+	CHECK(v.size() == 200000); // untouched, since the predicates run before anything moves
+
+	std::vector<int> toSort = random_ints(100000);
+	CHECK_THROWS(vec::par::sort(toSort, [](int, int) -> bool { throw std::runtime_error("compare"); }, {4, 16 * 1024}), std::runtime_error);
+
+	long long sum = vec::par::reduce(std::vector<long long>(v.begin(), v.end()), 0LL, std::plus<>{}, {4, 0});
+	CHECK(sum == 200000);
+}
+
+// Called from tasks of the same shared pool, with all its workers busy with such calls: the helpers
+// can't start, so each caller must do the work alone instead of waiting for them.
+static void nested_calls_from_pool_tasks() {
+	_wli::thread_pool& pool = _wli::thread_pool::instance();
+	const int NUM_TASKS = 64;
+	std::atomic<int> done{0}, wrong{0};
+	for (int k = 0; k < NUM_TASKS; ++k) {
+		pool.submit([&]() {
+			std::vector<int> v(50000, 1);
+			std::atomic<long> sum{0};
+			vec::par::for_each(v, [&](int x) { sum += x; }, {8, 1000});
+			std::vector<int> toSort(40000);
+			for (size_t i = 0; i < toSort.size(); ++i) toSort[i] = static_cast<int>(i * 7919 % toSort.size());
+			vec::par::sort(toSort, std::less<>{}, {4, 16 * 1024});
+			bool threw = false;
+			try {
+				vec::par::for_each(v, [](int) { throw std::runtime_error("nested"); }, {4, 1000});
+			} catch (const std::runtime_error&) {
+				threw = true;
+			}
+			if (sum != 50000 || vec::par::find_if(v, [](int x) { return x != 1; }) != static_cast<size_t>(-1)
+				|| !std::is_sorted(toSort.begin(), toSort.end()) || !threw) ++wrong;
+			++done;
+		});
+	}
+	std::chrono::steady_clock::time_point limit = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+	while (done < NUM_TASKS && std::chrono::steady_clock::now() < limit) std::this_thread::yield();
+	CHECK(done == NUM_TASKS);
+	CHECK(wrong == 0);
+}
+
+int main() {
+	same_as_serial();
+	exceptions_from_tasks();
+	nested_calls_from_pool_tasks();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,70 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <cwctype>
+#include "../../internals/headless.h" // shared types, messages and NMHDR
+
+// Just enough of <Windows.h> for the tests and benchmarks to build on other platforms: the types
+// and messages of the headless dispatch, plus plain C versions of the few string functions used by
+// the platform-independent headers. Not part of the library; on Windows the real header is used.
+
+typedef unsigned char      BYTE;
+typedef int                INT;
+typedef int32_t            LONG;
+typedef long long          LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef void*              HANDLE;
+
+#define CALLBACK
+#define CP_UTF8 65001
+#define ARRAYSIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+#define LOCALE_USER_DEFAULT 0x0400
+#define LOCALE_SDECIMAL     0x000E
+#define LOCALE_STHOUSAND    0x000F
+#define LOCALE_SGROUPING    0x0010
+
+inline int lstrlenW(const wchar_t* s) { return s ? static_cast<int>(std::wcslen(s)) : 0; }
+inline int lstrlenA(const char* s) { return s ? static_cast<int>(std::strlen(s)) : 0; }
+inline int lstrcmpW(const wchar_t* a, const wchar_t* b) { return std::wcscmp(a, b); }
+inline int lstrcmpiW(const wchar_t* a, const wchar_t* b) { return wcscasecmp(a, b); }
+inline int _wcsnicmp(const wchar_t* a, const wchar_t* b, size_t n) { return wcsncasecmp(a, b, n); }
+
+inline DWORD CharUpperBuffW(wchar_t* s, DWORD n) {
+	for (DWORD i = 0; i < n; ++i) s[i] = static_cast<wchar_t>(std::towupper(s[i]));
+	return n;
+}
+
+inline DWORD CharLowerBuffW(wchar_t* s, DWORD n) {
+	for (DWORD i = 0; i < n; ++i) s[i] = static_cast<wchar_t>(std::towlower(s[i]));
+	return n;
+}
+
+// Code pages other than UTF-8 are treated as Latin-1, which matches Windows-1252 outside 0x80-0x9F.
+inline int MultiByteToWideChar(UINT codePage, DWORD, const char* src, int srcLen, wchar_t* dest, int destLen) {
+	if (codePage == CP_UTF8) return 0;
+	if (srcLen < 0) srcLen = static_cast<int>(std::strlen(src)) + 1;
+	if (!dest || !destLen) return srcLen;
+	int n = (srcLen < destLen) ? srcLen : destLen;
+	for (int i = 0; i < n; ++i) dest[i] = static_cast<unsigned char>(src[i]);
+	return n;
+}
+
+inline int WideCharToMultiByte(UINT, DWORD, const wchar_t*, int, char*, int, const char*, BOOL*) { return 0; }
+
+inline int GetLocaleInfoW(unsigned, unsigned type, wchar_t* buf, int bufLen) {
+	const wchar_t* val = (type == LOCALE_SDECIMAL) ? L"." : (type == LOCALE_STHOUSAND) ? L"," : L"3;0";
+	int i = 0;
+	for (; val[i] && i < bufLen - 1; ++i) buf[i] = val[i];
+	buf[i] = L'\0';
+	return i + 1;
+}
@@ -0,0 +1,375 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wl {
+
+// Piece table for big editable texts, with O(log n) insert and erase anywhere.
+// The original text is never copied around: pieces refer to it, or to an append-only
+// buffer with all inserted text, and are kept in a balanced tree ordered by position.
+// Lines are separated by \n; a \r before it is kept in the text, but not in line().
+class text_buffer final {
+private:
+	static constexpr size_t MAX_PIECE = 4096; // so splitting a piece and counting its lines is cheap
+
+	struct _node final {
+		size_t   start = 0, len = 0; // range in its buffer
+		size_t   breaks = 0;         // \n chars in this piece
+		size_t   subLen = 0, subBreaks = 0; // whole subtree, including this piece
+		unsigned prio = 0;
+		unsigned left = 0, right = 0; // zero is nil
+		bool     added = false; // in _added buffer, otherwise in _original
+	};
+
+	std::wstring       _original, _added;
+	std::vector<_node> _nodes = std::vector<_node>(1); // nodes[0] is nil, with zero totals
+	std::vector<unsigned> _free;
+	unsigned           _root = 0;
+	unsigned           _seed = 2463534242u;
+
+public:
+	static constexpr size_t npos = static_cast<size_t>(-1);
+
+	text_buffer() = default;
+	explicit text_buffer(std::wstring_view s) { this->assign(s); }
+	explicit text_buffer(const wchar_t* s)    { this->assign(s); }
+	explicit text_buffer(std::wstring&& s)    { this->assign(std::move(s)); }
+
+	size_t length() const noexcept     { return this->_nodes[this->_root].subLen; }
+	bool   empty() const noexcept      { return !this->length(); }
+	size_t line_count() const noexcept { return this->_nodes[this->_root].subBreaks + 1; }
+
+	// Replaces the whole text, which becomes the original buffer.
+	text_buffer& assign(std::wstring&& s) {
+		this->clear();
+		this->_original = std::move(s);
+		this->_root = this->_build(false, 0, this->_original.length());
+		return *this;
+	}
+
+	text_buffer& assign(std::wstring_view s) {
+		return this->assign(std::wstring{s});
+	}
+
+	text_buffer& assign(const wchar_t* s) {
+		return this->assign(std::wstring{s});
+	}
+
+	text_buffer& clear() noexcept {
+		this->_original.clear();
+		this->_added.clear();
+		this->_nodes.resize(1);
+		this->_free.clear();
+		this->_root = 0;
+		return *this;
+	}
+
+	text_buffer& insert(size_t pos, std::wstring_view s) {
+		if (pos > this->length()) throw std::out_of_range("Insert position past the end of text.");
+		if (s.empty()) return *this;
+
+		unsigned l = 0, r = 0;
+		this->_split(this->_root, pos, l, r);
+		unsigned last = this->_rightmost(l);
+		if (last && this->_nodes[last].added && this->_nodes[last].start + this->_nodes[last].len == this->_added.length()
+			&& this->_nodes[last].len + s.length() <= MAX_PIECE) // typing or appending: just grow the last piece
+		{
+			this->_added.append(s);
+			this->_grow_rightmost(l, s.length(), _count_breaks(s.data(), s.length()));
+		} else {
+			size_t addStart = this->_added.length();
+			this->_added.append(s);
+			l = this->_merge(l, this->_build(true, addStart, s.length()));
+		}
+		this->_root = this->_merge(l, r);
+		return *this;
+	}
+
+	text_buffer& append(std::wstring_view s) {
+		return this->insert(this->length(), s);
+	}
+
+	text_buffer& erase(size_t pos, size_t len = npos) {
+		if (pos > this->length()) throw std::out_of_range("Erase position past the end of text.");
+		len = std::min(len, this->length() - pos);
+		if (!len) return *this;
+
+		unsigned l = 0, mid = 0, r = 0;
+		this->_split(this->_root, pos, l, r);
+		this->_split(r, len, mid, r);
+		this->_release(mid);
+		this->_root = this->_merge(l, r);
+		return *this;
+	}
+
+	text_buffer& replace(size_t pos, size_t len, std::wstring_view s) {
+		return this->erase(pos, len).insert(pos, s);
+	}
+
+	wchar_t operator[](size_t pos) const {
+		if (pos >= this->length()) throw std::out_of_range("Position past the end of text.");
+		size_t offset = 0;
+		const _node& n = this->_nodes[this->_find(pos, offset)];
+		return this->_data(n)[offset];
+	}
+
+	// Calls func(std::wstring_view) for each chunk of the given range, in order.
+	template<typename funcT>
+	void for_each_chunk(size_t pos, size_t len, funcT&& func) const {
+		if (pos > this->length()) throw std::out_of_range("Position past the end of text.");
+		len = std::min(len, this->length() - pos);
+		if (len) this->_visit(this->_root, pos, len, func);
+	}
+
+	// Calls func(std::wstring_view) for each chunk of the whole text, in order.
+	template<typename funcT>
+	void for_each_chunk(funcT&& func) const {
+		this->for_each_chunk(0, npos, std::forward<funcT>(func));
+	}
+
+	std::wstring substr(size_t pos, size_t len = npos) const {
+		std::wstring ret;
+		ret.reserve(std::min(len, this->length() - std::min(pos, this->length())));
+		this->for_each_chunk(pos, len, [&ret](std::wstring_view chunk) { ret.append(chunk); });
+		return ret;
+	}
+
+	std::wstring str() const {
+		return this->substr(0);
+	}
+
+	// Position of the first char of the line.
+	size_t line_start(size_t lineIndex) const {
+		if (lineIndex >= this->line_count()) throw std::out_of_range("Line index past the last line.");
+		if (!lineIndex) return 0;
+
+		size_t pos = 0, breaksLeft = lineIndex; // find the lineIndex-th \n, counting from 1
+		unsigned t = this->_root;
+		for (;;) {
+			const _node& n = this->_nodes[t];
+			const _node& left = this->_nodes[n.left];
+			if (breaksLeft <= left.subBreaks) {
+				t = n.left;
+			} else if (breaksLeft <= left.subBreaks + n.breaks) {
+				breaksLeft -= left.subBreaks;
+				pos += left.subLen;
+				const wchar_t* p = this->_data(n);
+				for (size_t i = 0; ; ++i) {
+					if (p[i] == L'\n' && !--breaksLeft) return pos + i + 1;
+				}
+			} else {
+				breaksLeft -= left.subBreaks + n.breaks;
+				pos += left.subLen + n.len;
+				t = n.right;
+			}
+		}
+	}
+
+	// Index of the line which contains the given position.
+	size_t line_of(size_t pos) const {
+		if (pos > this->length()) throw std::out_of_range("Position past the end of text.");
+		size_t breaks = 0;
+		unsigned t = this->_root;
+		while (t) {
+			const _node& n = this->_nodes[t];
+			const _node& left = this->_nodes[n.left];
+			if (pos < left.subLen) {
+				t = n.left;
+			} else if (pos < left.subLen + n.len) {
+				breaks += left.subBreaks + _count_breaks(this->_data(n), pos - left.subLen);
+				break;
+			} else {
+				breaks += left.subBreaks + n.breaks;
+				pos -= left.subLen + n.len;
+				t = n.right;
+			}
+		}
+		return breaks;
+	}
+
+	// Text of the line, without its line break.
+	std::wstring line(size_t lineIndex) const {
+		size_t start = this->line_start(lineIndex);
+		size_t end = (lineIndex + 1 < this->line_count()) ? this->line_start(lineIndex + 1) - 1 : this->length();
+		if (end > start && this->operator[](end - 1) == L'\r' && end < this->length()) --end;
+		return this->substr(start, end - start);
+	}
+
+private:
+	const wchar_t* _data(const _node& n) const noexcept {
+		return (n.added ? this->_added.data() : this->_original.data()) + n.start;
+	}
+
+	static size_t _count_breaks(const wchar_t* p, size_t len) noexcept {
+		return static_cast<size_t>(std::count(p, p + len, L'\n'));
+	}
+
+	unsigned _random() noexcept { // xorshift32
+		this->_seed ^= this->_seed << 13;
+		this->_seed ^= this->_seed >> 17;
+		this->_seed ^= this->_seed << 5;
+		return this->_seed;
+	}
+
+	unsigned _new_node(bool added, size_t start, size_t len, unsigned prio) {
+		unsigned idx;
+		if (this->_free.empty()) {
+			idx = static_cast<unsigned>(this->_nodes.size());
+			this->_nodes.emplace_back();
+		} else {
+			idx = this->_free.back();
+			this->_free.pop_back();
+		}
+		_node& n = this->_nodes[idx];
+		n = {};
+		n.added = added;
+		n.start = start;
+		n.len = len;
+		n.breaks = _count_breaks(this->_data(n), len);
+		n.prio = prio;
+		this->_update(idx);
+		return idx;
+	}
+
+	void _update(unsigned t) noexcept {
+		_node& n = this->_nodes[t];
+		n.subLen = this->_nodes[n.left].subLen + n.len + this->_nodes[n.right].subLen;
+		n.subBreaks = this->_nodes[n.left].subBreaks + n.breaks + this->_nodes[n.right].subBreaks;
+	}
+
+	// Builds a subtree for a range of a buffer, cut into pieces of MAX_PIECE chars.
+	unsigned _build(bool added, size_t start, size_t len) {
+		unsigned t = 0;
+		for (size_t off = 0; off < len; off += MAX_PIECE) {
+			t = this->_merge(t, this->_new_node(added, start + off, std::min(MAX_PIECE, len - off), this->_random()));
+		}
+		return t;
+	}
+
+	unsigned _merge(unsigned l, unsigned r) {
+		if (!l || !r) return l ? l : r;
+		if (this->_nodes[l].prio >= this->_nodes[r].prio) {
+			unsigned merged = this->_merge(this->_nodes[l].right, r);
+			this->_nodes[l].right = merged;
+			this->_update(l);
+			return l;
+		} else {
+			unsigned merged = this->_merge(l, this->_nodes[r].left);
+			this->_nodes[r].left = merged;
+			this->_update(r);
+			return r;
+		}
+	}
+
+	// Splits into the first pos chars and the rest; a piece may be cut in two.
+	void _split(unsigned t, size_t pos, unsigned& l, unsigned& r) {
+		if (!t) {
+			l = r = 0;
+			return;
+		}
+		size_t leftLen = this->_nodes[this->_nodes[t].left].subLen;
+		size_t pieceLen = this->_nodes[t].len;
+		unsigned a = 0, b = 0;
+		if (pos <= leftLen) {
+			this->_split(this->_nodes[t].left, pos, a, b);
+			this->_nodes[t].left = b;
+			this->_update(t);
+			l = a;
+			r = t;
+		} else if (pos >= leftLen + pieceLen) {
+			this->_split(this->_nodes[t].right, pos - leftLen - pieceLen, a, b);
+			this->_nodes[t].right = a;
+			this->_update(t);
+			l = t;
+			r = b;
+		} else { // cut inside this piece; the tail keeps the priority, so the heap order holds
+			size_t cut = pos - leftLen;
+			unsigned tail = this->_new_node(this->_nodes[t].added, this->_nodes[t].start + cut,
+				pieceLen - cut, this->_nodes[t].prio);
+			_node& n = this->_nodes[t];
+			this->_nodes[tail].right = n.right;
+			this->_update(tail);
+			n.right = 0;
+			n.len = cut;
+			n.breaks = _count_breaks(this->_data(n), cut);
+			this->_update(t);
+			l = t;
+			r = tail;
+		}
+	}
+
+	unsigned _rightmost(unsigned t) const noexcept {
+		while (t && this->_nodes[t].right) t = this->_nodes[t].right;
+		return t;
+	}
+
+	void _grow_rightmost(unsigned t, size_t extraLen, size_t extraBreaks) noexcept {
+		while (t) {
+			_node& n = this->_nodes[t];
+			n.subLen += extraLen;
+			n.subBreaks += extraBreaks;
+			if (!n.right) {
+				n.len += extraLen;
+				n.breaks += extraBreaks;
+			}
+			t = n.right;
+		}
+	}
+
+	void _release(unsigned t) {
+		if (!t) return;
+		this->_release(this->_nodes[t].left);
+		this->_release(this->_nodes[t].right);
+		this->_free.emplace_back(t);
+	}
+
+	unsigned _find(size_t pos, size_t& offset) const noexcept {
+		unsigned t = this->_root;
+		for (;;) {
+			const _node& n = this->_nodes[t];
+			size_t leftLen = this->_nodes[n.left].subLen;
+			if (pos < leftLen) {
+				t = n.left;
+			} else if (pos < leftLen + n.len) {
+				offset = pos - leftLen;
+				return t;
+			} else {
+				pos -= leftLen + n.len;
+				t = n.right;
+			}
+		}
+	}
+
+	template<typename funcT>
+	void _visit(unsigned t, size_t pos, size_t len, funcT& func) const {
+		const _node& n = this->_nodes[t];
+		size_t leftLen = this->_nodes[n.left].subLen;
+		if (pos < leftLen) {
+			size_t fromLeft = std::min(len, leftLen - pos);
+			this->_visit(n.left, pos, fromLeft, func);
+			pos = leftLen;
+			len -= fromLeft;
+		}
+		if (!len) return;
+		if (pos < leftLen + n.len) {
+			size_t offset = pos - leftLen;
+			size_t fromPiece = std::min(len, n.len - offset);
+			func(std::wstring_view{this->_data(n) + offset, fromPiece});
+			pos += fromPiece;
+			len -= fromPiece;
+		}
+		if (len) this->_visit(n.right, pos - leftLen - n.len, len, func);
+	}
+};
+
+}//namespace wl
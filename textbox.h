@@ -10,6 +10,7 @@
 #include "internals/base_text_pubm.h"
 #include "internals/base_native_ctrl_pubm.h"
 #include "internals/styler.h"
+#include "text_buffer.h"
 #include "wnd.h"
 
 namespace wl {
@@ -101,6 +102,72 @@ public:
 	textbox& replace_selected(const std::wstring& t) noexcept {
 		return this->replace_selected(t.c_str());
 	}
+
+	// Keeps a text_buffer with the textbox contents, and pushes each change to the control as a
+	// delta with EM_REPLACESEL, so appending to a big text, like a log, doesn't resend all of it.
+	// All changes must be made through it; line breaks must be \r\n, like the control uses.
+	class buffer_adapter final {
+	private:
+		textbox&    _textbox;
+		text_buffer _text;
+
+	public:
+		explicit buffer_adapter(textbox& tb) : _textbox{tb}, _text{tb.get_text()} {
+			SendMessageW(tb.hwnd(), EM_SETLIMITTEXT, 0, 0); // default limit is 32K chars, then EM_REPLACESEL would cut the text
+		}
+
+		const text_buffer& text() const noexcept { return this->_text; }
+
+		buffer_adapter& insert(size_t pos, std::wstring_view s) {
+			return this->replace(pos, 0, s);
+		}
+
+		buffer_adapter& append(std::wstring_view s) {
+			return this->replace(this->_text.length(), 0, s);
+		}
+
+		buffer_adapter& erase(size_t pos, size_t len) {
+			return this->replace(pos, len, {});
+		}
+
+		buffer_adapter& replace(size_t pos, size_t len, std::wstring_view s) {
+			size_t oldLength = this->_text.length();
+			this->_text.replace(pos, len, s); // throws if pos is past the end
+			len = std::min(len, oldLength - pos);
+
+			int selStart = 0, selEnd = 0; // user selection is kept, shifted by the change
+			SendMessageW(this->_textbox.hwnd(), EM_GETSEL,
+				reinterpret_cast<WPARAM>(&selStart), reinterpret_cast<LPARAM>(&selEnd));
+			bool caretAtEnd = static_cast<size_t>(selEnd) == oldLength;
+
+			SendMessageW(this->_textbox.hwnd(), EM_SETSEL, static_cast<WPARAM>(pos), static_cast<LPARAM>(pos + len));
+			SendMessageW(this->_textbox.hwnd(), EM_REPLACESEL, FALSE,
+				reinterpret_cast<LPARAM>(std::wstring{s}.c_str())); // must be null-terminated
+			SendMessageW(this->_textbox.hwnd(), EM_SETSEL,
+				static_cast<WPARAM>(_shift(selStart, pos, len, s.length())),
+				static_cast<LPARAM>(_shift(selEnd, pos, len, s.length())));
+			if (caretAtEnd) SendMessageW(this->_textbox.hwnd(), EM_SCROLLCARET, 0, 0); // follow the tail, like a log
+
+			if (static_cast<size_t>(GetWindowTextLengthW(this->_textbox.hwnd())) != this->_text.length()) {
+				this->_textbox.set_text(this->_text.str()); // control refused the change, like when out of memory: resend all
+			}
+			return *this;
+		}
+
+		// Replaces the whole text, the only case when all of it is sent to the control.
+		buffer_adapter& assign(std::wstring_view s) {
+			this->_text.assign(s);
+			this->_textbox.set_text(std::wstring{s});
+			return *this;
+		}
+
+	private:
+		static size_t _shift(int selPos, size_t pos, size_t oldLen, size_t newLen) noexcept {
+			size_t p = static_cast<size_t>(selPos);
+			if (p >= pos + oldLen) return p - oldLen + newLen; // after the change
+			return (p > pos) ? pos + newLen : p; // inside the replaced range goes to its end
+		}
+	};
 };
 
 }//namespace wl
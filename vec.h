@@ -7,7 +7,12 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <type_traits>
 #include <vector>
+#include "internals/vec_parallel.h"
 
 namespace wl {
 
@@ -98,5 +103,130 @@ inline void remove_if(std::vector<T>& v, predicateT&& func) {
 	);
 }
 
+// Parallel versions of the algorithms, for big vectors. Elements are processed in chunks by the
+// calling thread and workers of the shared thread pool, each taking its chunks in order; idle ones
+// steal chunks from busy ones. No thread is created per call.
+// The lambdas are called concurrently, so they must be thread-safe. The first exception
+// thrown by a lambda cancels the chunks not yet started, and is rethrown to the caller.
+namespace par {
+
+struct options final {
+	size_t numThreads = 0; // zero uses all cores
+	size_t grainSize = 0;  // elements per chunk; zero picks one from the size, raise it for very cheap lambdas
+};
+
+// Executes the lambda for each element, in no particular order.
+template<typename T, typename funcT>
+inline void for_each(const std::vector<T>& v, funcT&& func, options opts = {}) {
+	_wli::vec_parallel::run({v.size(), opts.numThreads, opts.grainSize},
+		[&](size_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) func(v[i]);
+		});
+}
+
+// Executes the lambda for each element, in no particular order.
+template<typename T, typename funcT>
+inline void for_each(std::vector<T>& v, funcT&& func, options opts = {}) {
+	_wli::vec_parallel::run({v.size(), opts.numThreads, opts.grainSize},
+		[&](size_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) func(v[i]);
+		});
+}
+
+// Returns a new vector with the lambda results, in the same order; the result type must be default-constructible.
+template<typename T, typename funcT>
+inline auto transform(const std::vector<T>& v, funcT&& func, options opts = {})
+	-> std::vector<std::decay_t<decltype(func(v[0]))>>
+{
+	std::vector<std::decay_t<decltype(func(v[0]))>> ret(v.size());
+	_wli::vec_parallel::run({v.size(), opts.numThreads, opts.grainSize},
+		[&](size_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) ret[i] = func(v[i]);
+		});
+	return ret;
+}
+
+// Returns index of first element which matches the predicate, otherwise -1, like the serial one.
+// Once a match is found, elements after it are no longer checked.
+template<typename T, typename predicateT>
+inline size_t find_if(const std::vector<T>& v, predicateT&& func, options opts = {}) {
+	std::atomic<size_t> first{static_cast<size_t>(-1)};
+	_wli::vec_parallel::run({v.size(), opts.numThreads, opts.grainSize},
+		[&](size_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end && i < first.load(std::memory_order_relaxed); ++i) {
+				if (func(v[i])) {
+					size_t cur = first.load(std::memory_order_relaxed);
+					while (i < cur && !first.compare_exchange_weak(cur, i, std::memory_order_relaxed)) ;
+					return;
+				}
+			}
+		});
+	return first.load();
+}
+
+// Removes all elements which match the predicate, keeping the order of the others.
+// Only the predicate runs in parallel; the elements are then moved in a single pass.
+template<typename T, typename predicateT>
+inline void remove_if(std::vector<T>& v, predicateT&& func, options opts = {}) {
+	std::vector<unsigned char> doomed(v.size());
+	_wli::vec_parallel::run({v.size(), opts.numThreads, opts.grainSize},
+		[&](size_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) doomed[i] = func(static_cast<const T&>(v[i])) ? 1 : 0;
+		});
+	size_t numKept = 0;
+	for (size_t i = 0; i < v.size(); ++i) {
+		if (doomed[i]) continue;
+		if (numKept != i) v[numKept] = std::move(v[i]);
+		++numKept;
+	}
+	v.erase(v.begin() + numKept, v.end());
+}
+
+// Combines all elements with the operation, which must be associative; chunk results are
+// combined in order, so it doesn't need to be commutative. Returns init if the vector is empty.
+template<typename T, typename opT>
+inline T reduce(const std::vector<T>& v, T init, opT&& op, options opts = {}) {
+	_wli::vec_parallel::plan p{v.size(), opts.numThreads, opts.grainSize};
+	std::vector<std::optional<T>> partials(p.numChunks);
+	_wli::vec_parallel::run(p,
+		[&](size_t chunk, size_t begin, size_t end) {
+			T acc = v[begin];
+			for (size_t i = begin + 1; i < end; ++i) acc = op(std::move(acc), v[i]);
+			partials[chunk] = std::move(acc);
+		});
+	for (std::optional<T>& partial : partials) init = op(std::move(init), std::move(*partial));
+	return init;
+}
+
+// Sorts the vector, not stable; slices are sorted by different threads, then merged pairwise, also in parallel.
+template<typename T, typename compareT = std::less<>>
+inline void sort(std::vector<T>& v, compareT&& comp = {}, options opts = {}) {
+	const size_t MIN_SLICE = 16 * 1024; // below that, threads cost more than they save
+	_wli::vec_parallel::plan threadsPlan{v.size(), opts.numThreads, 1};
+	size_t numSlices = std::min(threadsPlan.numThreads, v.size() / std::max(opts.grainSize, MIN_SLICE));
+	if (numSlices <= 1) {
+		std::sort(v.begin(), v.end(), comp);
+		return;
+	}
+
+	std::vector<size_t> bounds(numSlices + 1);
+	for (size_t s = 0; s <= numSlices; ++s) bounds[s] = v.size() * s / numSlices;
+	_wli::vec_parallel::run({numSlices, numSlices, 1},
+		[&](size_t s, size_t, size_t) {
+			std::sort(v.begin() + bounds[s], v.begin() + bounds[s + 1], comp);
+		});
+	for (size_t width = 1; width < numSlices; width *= 2) {
+		size_t numPairs = (numSlices - width + width * 2 - 1) / (width * 2);
+		_wli::vec_parallel::run({numPairs, numPairs, 1},
+			[&](size_t pair, size_t, size_t) {
+				size_t s = pair * width * 2;
+				std::inplace_merge(v.begin() + bounds[s], v.begin() + bounds[s + width],
+					v.begin() + bounds[std::min(s + width * 2, numSlices)], comp);
+			});
+	}
+}
+
+}//namespace par
+
 }//namespace vec
 }//namespace wl
@@ -54,12 +54,16 @@ public:
 	}
 
 	bool parse(const std::wstring& text) {
-		std::vector<std::wstring> fields = str::split(text, L".");
-		for (size_t i = 0; i < fields.size() && i <= 4; ++i) {
-			if (!str::is_uint(fields[i])) {
+		size_t i = 0;
+		for (std::wstring_view field : str::split_view(text, L".")) {
+			if (i == this->num.size()) break; // extra fields are ignored
+			field = str::trim_view(field);
+			UINT n = 0;
+			str::from_chars_result res = str::from_chars(field, n);
+			if (res.ec != std::errc{} || res.stop != field.length()) {
 				return false;
 			}
-			this->num[i] = std::stoi(fields[i]);
+			this->num[i++] = n;
 		}
 		return true;
 	}